@@ -40,13 +40,17 @@
 using namespace TextEditor;
 using namespace Internal;
 
-Context::Context() : m_fallthrough(false), m_dynamic(false)
+Context::Context() :
+    m_itemDataId(-1), m_index(-1), m_persistent(false), m_fallthrough(false), m_dynamic(false)
 {}
 
 Context::Context(const Context &context) :
     m_id(context.m_id), m_name(context.m_name), m_lineBeginContext(context.m_lineBeginContext),
     m_lineEndContext(context.m_lineEndContext), m_fallthroughContext(context.m_fallthroughContext),
-    m_itemData(context.m_itemData), m_fallthrough(context.m_fallthrough),
+    m_itemData(context.m_itemData), m_itemDataId(context.m_itemDataId),
+    m_index(context.m_index), m_lineBeginSwitch(context.m_lineBeginSwitch),
+    m_lineEndSwitch(context.m_lineEndSwitch), m_fallthroughSwitch(context.m_fallthroughSwitch),
+    m_persistent(context.m_persistent), m_fallthrough(context.m_fallthrough),
     m_dynamic(context.m_dynamic), m_instructions(context.m_instructions),
     m_definition(context.m_definition)
 {
@@ -72,6 +76,12 @@ void Context::swap(Context &context)
     qSwap(m_lineEndContext, context.m_lineEndContext);
     qSwap(m_fallthroughContext, context.m_fallthroughContext);
     qSwap(m_itemData, context.m_itemData);
+    qSwap(m_itemDataId, context.m_itemDataId);
+    qSwap(m_index, context.m_index);
+    qSwap(m_lineBeginSwitch, context.m_lineBeginSwitch);
+    qSwap(m_lineEndSwitch, context.m_lineEndSwitch);
+    qSwap(m_fallthroughSwitch, context.m_fallthroughSwitch);
+    qSwap(m_persistent, context.m_persistent);
     qSwap(m_fallthrough, context.m_fallthrough);
     qSwap(m_dynamic, context.m_dynamic);
     qSwap(m_rules, context.m_rules);
@@ -85,6 +95,12 @@ void Context::configureId(const int unique)
 const QString &Context::id() const
 { return m_id; }
 
+void Context::setIndex(int index)
+{ m_index = index; }
+
+int Context::index() const
+{ return m_index; }
+
 void Context::setName(const QString &name)
 {
     m_name = name;
@@ -101,7 +117,10 @@ const QString &Context::lineBeginContext() const
 { return m_lineBeginContext; }
 
 void Context::setLineEndContext(const QString &context)
-{ m_lineEndContext = context; }
+{
+    m_lineEndContext = context;
+    m_persistent = (context == QLatin1String("#stay"));
+}
 
 const QString &Context::lineEndContext() const
 { return m_lineEndContext; }
@@ -112,12 +131,39 @@ void Context::setFallthroughContext(const QString &context)
 const QString &Context::fallthroughContext() const
 { return m_fallthroughContext; }
 
+void Context::setLineBeginSwitch(const ContextSwitch &contextSwitch)
+{ m_lineBeginSwitch = contextSwitch; }
+
+const ContextSwitch &Context::lineBeginSwitch() const
+{ return m_lineBeginSwitch; }
+
+void Context::setLineEndSwitch(const ContextSwitch &contextSwitch)
+{ m_lineEndSwitch = contextSwitch; }
+
+const ContextSwitch &Context::lineEndSwitch() const
+{ return m_lineEndSwitch; }
+
+void Context::setFallthroughSwitch(const ContextSwitch &contextSwitch)
+{ m_fallthroughSwitch = contextSwitch; }
+
+const ContextSwitch &Context::fallthroughSwitch() const
+{ return m_fallthroughSwitch; }
+
+bool Context::isPersistent() const
+{ return m_persistent; }
+
 void Context::setItemData(const QString &itemData)
 { m_itemData = itemData; }
 
 const QString &Context::itemData() const
 { return m_itemData; }
 
+void Context::setItemDataId(int id)
+{ m_itemDataId = id; }
+
+int Context::itemDataId() const
+{ return m_itemDataId; }
+
 void Context::setFallthrough(const QString &fallthrough)
 { m_fallthrough = toBool(fallthrough); }
 
@@ -35,6 +35,7 @@
 #define CONTEXT_H
 
 #include "includerulesinstruction.h"
+#include "contextswitch.h"
 
 #include <QtCore/QString>
 #include <QtCore/QList>
@@ -57,6 +58,9 @@ public:
     void configureId(const int unique);
     const QString &id() const;
 
+    void setIndex(int index);
+    int index() const;
+
     void setName(const QString &name);
     const QString &name() const;
 
@@ -69,9 +73,23 @@ public:
     void setFallthroughContext(const QString &context);
     const QString &fallthroughContext() const;
 
+    void setLineBeginSwitch(const ContextSwitch &contextSwitch);
+    const ContextSwitch &lineBeginSwitch() const;
+
+    void setLineEndSwitch(const ContextSwitch &contextSwitch);
+    const ContextSwitch &lineEndSwitch() const;
+
+    void setFallthroughSwitch(const ContextSwitch &contextSwitch);
+    const ContextSwitch &fallthroughSwitch() const;
+
+    bool isPersistent() const;
+
     void setItemData(const QString &itemData);
     const QString &itemData() const;
 
+    void setItemDataId(int id);
+    int itemDataId() const;
+
     void setFallthrough(const QString &fallthrough);
     bool isFallthrough() const;
 
@@ -99,6 +117,12 @@ private:
     QString m_lineEndContext;
     QString m_fallthroughContext;
     QString m_itemData;
+    int m_itemDataId;
+    int m_index;
+    ContextSwitch m_lineBeginSwitch;
+    ContextSwitch m_lineEndSwitch;
+    ContextSwitch m_fallthroughSwitch;
+    bool m_persistent;
     bool m_fallthrough;
     bool m_dynamic;
 
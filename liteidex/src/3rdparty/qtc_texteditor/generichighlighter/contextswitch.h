@@ -0,0 +1,65 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2011 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** No Commercial Usage
+**
+** This file contains pre-release code and may not be distributed.
+** You may use this file in accordance with the terms and conditions
+** contained in the Technology Preview License Agreement accompanying
+** this package.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights.  These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at qt-info@nokia.com.
+**
+**************************************************************************/
+
+#ifndef CONTEXTSWITCH_H
+#define CONTEXTSWITCH_H
+
+namespace TextEditor {
+namespace Internal {
+
+// A context switch ("#stay", "#pop#pop", "Name") compiled once the definition is loaded. The
+// target context is an index into the contexts table of the definition that owns the switch.
+class ContextSwitch
+{
+public:
+    enum {
+        NoContext = -1,
+        MissingContext = -2
+    };
+
+    ContextSwitch() : m_pops(0), m_context(NoContext) {}
+    ContextSwitch(int pops, int context) : m_pops(pops), m_context(context) {}
+
+    bool isStay() const { return m_pops == 0 && m_context == NoContext; }
+    int pops() const { return m_pops; }
+    int context() const { return m_context; }
+
+private:
+    int m_pops;
+    int m_context;
+};
+
+} // namespace Internal
+} // namespace TextEditor
+
+#endif // CONTEXTSWITCH_H
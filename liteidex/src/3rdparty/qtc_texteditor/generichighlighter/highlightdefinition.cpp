@@ -35,10 +35,15 @@
 #include "highlighterexception.h"
 #include "context.h"
 #include "keywordlist.h"
+#include "keywordmatcher.h"
 #include "itemdata.h"
+#include "rule.h"
+#include "specificrules.h"
+#include "highlighter.h"
 #include "reuse.h"
 
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 
 using namespace TextEditor;
 using namespace Internal;
@@ -93,6 +98,8 @@ QSharedPointer<Context> HighlightDefinition::createContext(const QString &contex
 
     QSharedPointer<Context> newContext = m_helper.create<Context>(context, m_contexts);
     newContext->setName(context);
+    newContext->setIndex(m_contextList.size());
+    m_contextList.append(newContext);
     return newContext;
 }
 
@@ -105,12 +112,102 @@ QSharedPointer<Context> HighlightDefinition::context(const QString &context) con
 const QHash<QString, QSharedPointer<Context> > &HighlightDefinition::contexts() const
 { return m_contexts; }
 
+const QSharedPointer<Context> &HighlightDefinition::contextAt(int index) const
+{
+    if (index < 0 || index >= m_contextList.size())
+        throw HighlighterException();
+
+    return m_contextList.at(index);
+}
+
 QSharedPointer<ItemData> HighlightDefinition::createItemData(const QString &itemData)
-{ return m_helper.create<ItemData>(itemData, m_itemsData); }
+{
+    QSharedPointer<ItemData> newItemData = m_helper.create<ItemData>(itemData, m_itemsData);
+    m_itemDataIds.insert(itemData, m_itemDataList.size());
+    m_itemDataList.append(newItemData);
+    return newItemData;
+}
 
 QSharedPointer<ItemData> HighlightDefinition::itemData(const QString &itemData) const
 { return m_helper.find<ItemData>(itemData, m_itemsData); }
 
+int HighlightDefinition::itemDataId(const QString &itemData) const
+{ return m_itemDataIds.value(itemData, -1); }
+
+const QSharedPointer<ItemData> &HighlightDefinition::itemDataAt(int id) const
+{ return m_itemDataList.at(id); }
+
+namespace {
+    static const QLatin1String kStay("#stay");
+    static const QLatin1String kPop("#pop");
+    static const QLatin1Char kHash('#');
+}
+
+static ContextSwitch compileContextSwitch(const QString &contextName,
+                                          const QSharedPointer<HighlightDefinition> &definition)
+{
+    if (contextName.isEmpty() || contextName == kStay)
+        return ContextSwitch();
+
+    if (contextName.startsWith(kPop))
+        return ContextSwitch(contextName.split(kHash, QString::SkipEmptyParts).size(),
+                             ContextSwitch::NoContext);
+
+    // Unknown contexts only break the highlighter when they are actually reached.
+    try {
+        return ContextSwitch(0, definition->context(contextName)->index());
+    } catch (const HighlighterException &) {
+        return ContextSwitch(0, ContextSwitch::MissingContext);
+    }
+}
+
+static void resolveRules(const QList<QSharedPointer<Rule> > &rules,
+                         QList<KeywordRule *> *keywordRules)
+{
+    foreach (const QSharedPointer<Rule> &rule, rules) {
+        const QSharedPointer<HighlightDefinition> &definition = rule->definition();
+        rule->setItemDataId(definition->itemDataId(rule->itemData()));
+        rule->setContextSwitch(compileContextSwitch(rule->context(), definition));
+        if (KeywordRule *keywordRule = dynamic_cast<KeywordRule *>(rule.data()))
+            keywordRules->append(keywordRule);
+        resolveRules(rule->children(), keywordRules);
+    }
+}
+
+// All keyword rules of a context share one matcher built from the lists they use.
+static void compileKeywordRules(const QList<KeywordRule *> &keywordRules)
+{
+    if (keywordRules.isEmpty())
+        return;
+
+    QSharedPointer<KeywordMatcher> matcher(new KeywordMatcher);
+    foreach (KeywordRule *rule, keywordRules)
+        rule->setMatcher(matcher, matcher->addList(rule->list()));
+    matcher->build();
+}
+
+// Resolves item data and context names used by contexts and rules to indexes into the
+// definition that owns them, and item data styles to format ids, so highlighting never looks
+// up strings, and merges the keyword lists of each context into one matcher. Must be called
+// once all includes were processed.
+void HighlightDefinition::resolveReferences()
+{
+    foreach (const QSharedPointer<ItemData> &itemData, m_itemDataList)
+        itemData->setFormatId(Highlighter::formatIdForStyle(itemData->style()));
+
+    foreach (const QSharedPointer<Context> &context, m_contextList) {
+        const QSharedPointer<HighlightDefinition> &definition = context->definition();
+        context->setItemDataId(definition->itemDataId(context->itemData()));
+        context->setLineBeginSwitch(compileContextSwitch(context->lineBeginContext(), definition));
+        context->setLineEndSwitch(compileContextSwitch(context->lineEndContext(), definition));
+        context->setFallthroughSwitch(compileContextSwitch(context->fallthroughContext(),
+                                                           definition));
+        QList<KeywordRule *> keywordRules;
+        resolveRules(context->rules(), &keywordRules);
+        compileKeywordRules(keywordRules);
+    }
+}
+
 void HighlightDefinition::setSingleLineComment(const QString &start)
 { m_singleLineComment = start; }
 
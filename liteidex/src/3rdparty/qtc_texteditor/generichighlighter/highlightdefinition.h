@@ -37,6 +37,7 @@
 #include <QtCore/QString>
 #include <QtCore/QHash>
 #include <QtCore/QSet>
+#include <QtCore/QVector>
 #include <QtCore/QSharedPointer>
 
 namespace TextEditor {
@@ -59,9 +60,14 @@ public:
     QSharedPointer<Context> initialContext() const;
     QSharedPointer<Context> context(const QString &context) const;
     const QHash<QString, QSharedPointer<Context> > &contexts() const;
+    const QSharedPointer<Context> &contextAt(int index) const;
 
     QSharedPointer<ItemData> createItemData(const QString &itemData);
     QSharedPointer<ItemData> itemData(const QString &itemData) const;
+    int itemDataId(const QString &itemData) const;
+    const QSharedPointer<ItemData> &itemDataAt(int id) const;
+
+    void resolveReferences();
 
     void setKeywordsSensitive(const QString &sensitivity);
     Qt::CaseSensitivity keywordsSensitive() const;
@@ -103,7 +109,10 @@ private:
 
     QHash<QString, QSharedPointer<KeywordList> > m_lists;
     QHash<QString, QSharedPointer<Context> > m_contexts;
+    QVector<QSharedPointer<Context> > m_contextList;
     QHash<QString, QSharedPointer<ItemData> > m_itemsData;
+    QHash<QString, int> m_itemDataIds;
+    QVector<QSharedPointer<ItemData> > m_itemDataList;
 
     QString m_initialContext;
 
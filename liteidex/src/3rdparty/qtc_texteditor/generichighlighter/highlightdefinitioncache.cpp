@@ -0,0 +1,322 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2011 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** No Commercial Usage
+**
+** This file contains pre-release code and may not be distributed.
+** You may use this file in accordance with the terms and conditions
+** contained in the Technology Preview License Agreement accompanying
+** this package.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights.  These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at qt-info@nokia.com.
+**
+**************************************************************************/
+
+#include "highlightdefinitioncache.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
+#include <QtCore/QDataStream>
+
+#include "fileutil/fileutil.h"
+
+using namespace TextEditor;
+using namespace Internal;
+
+namespace {
+
+// The version must change whenever the metadata fields or the recorded event
+// stream change.
+const quint32 kCacheMagic = 0x4b415445;
+const quint32 kCacheVersion = 1;
+const int kStreamVersion = QDataStream::Qt_4_6;
+
+uint fileTime(const QFileInfo &fileInfo)
+{ return fileInfo.lastModified().toTime_t(); }
+
+} // anon
+
+HighlightDefinitionRecorder::HighlightDefinitionRecorder(QXmlDefaultHandler *handler) :
+    m_handler(handler)
+{}
+
+bool HighlightDefinitionRecorder::startDocument()
+{
+    m_strings.clear();
+    m_stringIndex.clear();
+    m_events.clear();
+    return m_handler->startDocument();
+}
+
+bool HighlightDefinitionRecorder::endDocument()
+{ return m_handler->endDocument(); }
+
+bool HighlightDefinitionRecorder::startElement(const QString &namespaceURI,
+                                               const QString &localName,
+                                               const QString &qName,
+                                               const QXmlAttributes &atts)
+{
+    QDataStream stream(&m_events, QIODevice::WriteOnly | QIODevice::Append);
+    stream.setVersion(kStreamVersion);
+    stream << quint8(StartElement) << stringIndex(qName) << quint32(atts.count());
+    for (int i = 0; i < atts.count(); ++i)
+        stream << stringIndex(atts.qName(i)) << stringIndex(atts.value(i));
+    return m_handler->startElement(namespaceURI, localName, qName, atts);
+}
+
+bool HighlightDefinitionRecorder::endElement(const QString &namespaceURI,
+                                             const QString &localName,
+                                             const QString &qName)
+{
+    QDataStream stream(&m_events, QIODevice::WriteOnly | QIODevice::Append);
+    stream.setVersion(kStreamVersion);
+    stream << quint8(EndElement) << stringIndex(qName);
+    return m_handler->endElement(namespaceURI, localName, qName);
+}
+
+bool HighlightDefinitionRecorder::characters(const QString &ch)
+{
+    QDataStream stream(&m_events, QIODevice::WriteOnly | QIODevice::Append);
+    stream.setVersion(kStreamVersion);
+    stream << quint8(Characters) << stringIndex(ch);
+    return m_handler->characters(ch);
+}
+
+QByteArray HighlightDefinitionRecorder::data() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(kStreamVersion);
+    stream << m_strings << m_events;
+    return data;
+}
+
+quint32 HighlightDefinitionRecorder::stringIndex(const QString &text)
+{
+    QHash<QString, quint32>::const_iterator it = m_stringIndex.constFind(text);
+    if (it != m_stringIndex.constEnd())
+        return it.value();
+    const quint32 index = m_strings.size();
+    m_strings.append(text);
+    m_stringIndex.insert(text, index);
+    return index;
+}
+
+bool HighlightDefinitionRecorder::replay(const QByteArray &data, QXmlDefaultHandler *handler)
+{
+    QStringList strings;
+    QByteArray events;
+    QDataStream in(data);
+    in.setVersion(kStreamVersion);
+    in >> strings >> events;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    const quint32 stringCount = strings.size();
+    QDataStream stream(events);
+    stream.setVersion(kStreamVersion);
+    if (!handler->startDocument())
+        return false;
+    while (!stream.atEnd()) {
+        quint8 event = 0;
+        quint32 name = 0;
+        stream >> event >> name;
+        if (stream.status() != QDataStream::Ok || name >= stringCount)
+            return false;
+
+        if (event == StartElement) {
+            quint32 count = 0;
+            stream >> count;
+            if (count > quint32(events.size()))
+                return false;
+            QXmlAttributes atts;
+            for (quint32 i = 0; i < count; ++i) {
+                quint32 attName = 0;
+                quint32 attValue = 0;
+                stream >> attName >> attValue;
+                if (attName >= stringCount || attValue >= stringCount)
+                    return false;
+                atts.append(strings.at(attName), QString(), QString(), strings.at(attValue));
+            }
+            if (stream.status() != QDataStream::Ok ||
+                    !handler->startElement(QString(), QString(), strings.at(name), atts))
+                return false;
+        } else if (event == EndElement) {
+            if (!handler->endElement(QString(), QString(), strings.at(name)))
+                return false;
+        } else if (event == Characters) {
+            if (!handler->characters(strings.at(name)))
+                return false;
+        } else {
+            return false;
+        }
+    }
+    return handler->endDocument();
+}
+
+HighlightDefinitionCache::HighlightDefinitionCache() : m_dirty(false)
+{}
+
+void HighlightDefinitionCache::setFileName(const QString &fileName)
+{ m_fileName = fileName; }
+
+QString HighlightDefinitionCache::fileName() const
+{ return m_fileName; }
+
+bool HighlightDefinitionCache::isDirty() const
+{ return m_dirty; }
+
+bool HighlightDefinitionCache::load()
+{
+    m_entries.clear();
+    m_dirty = false;
+    if (m_fileName.isEmpty())
+        return false;
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray data = file.readAll();
+    file.close();
+
+    QDataStream stream(data);
+    stream.setVersion(kStreamVersion);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != kCacheMagic || version != kCacheVersion)
+        return false;
+
+    QHash<QString, Entry> entries;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString id;
+        Entry entry;
+        bool hasMetaData = false;
+        stream >> id >> entry.m_mtime >> entry.m_size >> hasMetaData;
+        if (hasMetaData) {
+            QString metaDataId;
+            QString fileName;
+            QString name;
+            QString definitionVersion;
+            qint32 priority = 0;
+            QStringList patterns;
+            QStringList mimeTypes;
+            stream >> metaDataId >> fileName >> name >> definitionVersion >> priority
+                   >> patterns >> mimeTypes;
+            entry.m_metaData = QSharedPointer<HighlightDefinitionMetaData>(
+                        new HighlightDefinitionMetaData);
+            entry.m_metaData->setFileName(fileName);
+            entry.m_metaData->setId(metaDataId);
+            entry.m_metaData->setName(name);
+            entry.m_metaData->setVersion(definitionVersion);
+            entry.m_metaData->setPriority(priority);
+            entry.m_metaData->setPatterns(patterns);
+            entry.m_metaData->setMimeTypes(mimeTypes);
+        }
+        stream >> entry.m_definition;
+        entries.insert(id, entry);
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    m_entries = entries;
+    return true;
+}
+
+bool HighlightDefinitionCache::save()
+{
+    if (m_fileName.isEmpty())
+        return false;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(kStreamVersion);
+    stream << kCacheMagic << kCacheVersion << quint32(m_entries.size());
+    QHash<QString, Entry>::const_iterator it = m_entries.constBegin();
+    for (; it != m_entries.constEnd(); ++it) {
+        const Entry &entry = it.value();
+        const QSharedPointer<HighlightDefinitionMetaData> &metaData = entry.m_metaData;
+        stream << it.key() << entry.m_mtime << entry.m_size << !metaData.isNull();
+        if (!metaData.isNull()) {
+            stream << metaData->id() << metaData->fileName() << metaData->name() << metaData->version()
+                   << qint32(metaData->priority()) << metaData->patterns()
+                   << metaData->mimeTypes();
+        }
+        stream << entry.m_definition;
+    }
+
+    // Write aside and rename over the cache, another instance may be reading or saving it.
+    const bool ok = FileUtil::replaceFile(m_fileName, data);
+    if (ok)
+        m_dirty = false;
+    return ok;
+}
+
+const HighlightDefinitionCache::Entry *HighlightDefinitionCache::findEntry(
+        const QFileInfo &fileInfo) const
+{
+    QHash<QString, Entry>::const_iterator it = m_entries.constFind(fileInfo.absoluteFilePath());
+    if (it == m_entries.constEnd())
+        return 0;
+    if (it.value().m_mtime != fileTime(fileInfo) || it.value().m_size != fileInfo.size())
+        return 0;
+    return &it.value();
+}
+
+HighlightDefinitionCache::Entry &HighlightDefinitionCache::updateEntry(const QFileInfo &fileInfo)
+{
+    Entry &entry = m_entries[fileInfo.absoluteFilePath()];
+    const uint mtime = fileTime(fileInfo);
+    if (entry.m_mtime != mtime || entry.m_size != fileInfo.size()) {
+        entry = Entry();
+        entry.m_mtime = mtime;
+        entry.m_size = fileInfo.size();
+    }
+    m_dirty = true;
+    return entry;
+}
+
+QSharedPointer<HighlightDefinitionMetaData> HighlightDefinitionCache::metaData(
+        const QFileInfo &fileInfo) const
+{
+    const Entry *entry = findEntry(fileInfo);
+    if (!entry)
+        return QSharedPointer<HighlightDefinitionMetaData>();
+    return entry->m_metaData;
+}
+
+void HighlightDefinitionCache::setMetaData(const QFileInfo &fileInfo,
+                                           const QSharedPointer<HighlightDefinitionMetaData> &metaData)
+{ updateEntry(fileInfo).m_metaData = metaData; }
+
+QByteArray HighlightDefinitionCache::definitionData(const QFileInfo &fileInfo) const
+{
+    const Entry *entry = findEntry(fileInfo);
+    if (!entry)
+        return QByteArray();
+    return entry->m_definition;
+}
+
+void HighlightDefinitionCache::setDefinitionData(const QFileInfo &fileInfo, const QByteArray &data)
+{ updateEntry(fileInfo).m_definition = data; }
@@ -0,0 +1,132 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2011 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** No Commercial Usage
+**
+** This file contains pre-release code and may not be distributed.
+** You may use this file in accordance with the terms and conditions
+** contained in the Technology Preview License Agreement accompanying
+** this package.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights.  These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at qt-info@nokia.com.
+**
+**************************************************************************/
+
+#ifndef HIGHLIGHTDEFINITIONCACHE_H
+#define HIGHLIGHTDEFINITIONCACHE_H
+
+#include "highlightdefinitionmetadata.h"
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
+#include <QtXml/QXmlDefaultHandler>
+
+QT_BEGIN_NAMESPACE
+class QFileInfo;
+QT_END_NAMESPACE
+
+namespace TextEditor {
+namespace Internal {
+
+// HighlightDefinitionRecorder forwards the SAX events of a definition file to
+// another handler and keeps them as a compact stream, replay() feeds the same
+// events to a new handler without reading the xml again.
+class HighlightDefinitionRecorder : public QXmlDefaultHandler
+{
+public:
+    HighlightDefinitionRecorder(QXmlDefaultHandler *handler);
+
+    bool startDocument();
+    bool endDocument();
+    bool startElement(const QString &namespaceURI, const QString &localName,
+                      const QString &qName, const QXmlAttributes &atts);
+    bool endElement(const QString &namespaceURI, const QString &localName,
+                    const QString &qName);
+    bool characters(const QString &ch);
+
+    QByteArray data() const;
+
+    static bool replay(const QByteArray &data, QXmlDefaultHandler *handler);
+
+private:
+    enum Event {
+        StartElement = 1,
+        EndElement,
+        Characters
+    };
+
+    quint32 stringIndex(const QString &text);
+
+    QXmlDefaultHandler *m_handler;
+    QStringList m_strings;
+    QHash<QString, quint32> m_stringIndex;
+    QByteArray m_events;
+};
+
+// HighlightDefinitionCache keeps the metadata and the recorded element stream
+// of every definition file in one file, an entry is used only while the
+// modification time and size of its definition are unchanged.
+class HighlightDefinitionCache
+{
+public:
+    HighlightDefinitionCache();
+
+    void setFileName(const QString &fileName);
+    QString fileName() const;
+
+    bool load();
+    bool save();
+    bool isDirty() const;
+
+    QSharedPointer<HighlightDefinitionMetaData> metaData(const QFileInfo &fileInfo) const;
+    void setMetaData(const QFileInfo &fileInfo,
+                     const QSharedPointer<HighlightDefinitionMetaData> &metaData);
+
+    QByteArray definitionData(const QFileInfo &fileInfo) const;
+    void setDefinitionData(const QFileInfo &fileInfo, const QByteArray &data);
+
+private:
+    struct Entry
+    {
+        Entry() : m_mtime(0), m_size(0) {}
+
+        uint m_mtime;
+        qint64 m_size;
+        QSharedPointer<HighlightDefinitionMetaData> m_metaData;
+        QByteArray m_definition;
+    };
+
+    const Entry *findEntry(const QFileInfo &fileInfo) const;
+    Entry &updateEntry(const QFileInfo &fileInfo);
+
+    QString m_fileName;
+    QHash<QString, Entry> m_entries;
+    bool m_dirty;
+};
+
+} // namespace Internal
+} // namespace TextEditor
+
+#endif // HIGHLIGHTDEFINITIONCACHE_H
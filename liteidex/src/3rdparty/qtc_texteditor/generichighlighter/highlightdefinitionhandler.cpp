@@ -132,6 +132,7 @@ bool HighlightDefinitionHandler::startDocument()
 bool HighlightDefinitionHandler::endDocument()
 {
     processIncludeRules();
+    m_definition->resolveReferences();
     return true;
 }
 
@@ -43,16 +43,14 @@
 
 #include <QtCore/QLatin1String>
 #include <QtCore/QLatin1Char>
+#include <QtCore/QVarLengthArray>
 #include <QDebug>
 
 using namespace TextEditor;
 using namespace Internal;
 
 namespace {
-    static const QLatin1String kStay("#stay");
-    static const QLatin1String kPop("#pop");
     static const QLatin1Char kBackSlash('\\');
-    static const QLatin1Char kHash('#');
 }
 
 const Highlighter::KateFormatMap Highlighter::m_kateFormats;
@@ -67,11 +65,17 @@ Highlighter::Highlighter(QTextDocument *parent) :
     m_dynamicContextsCounter(0),
     m_isBroken(false),
     m_stringOrComment(false)
-{}
+{
+    // The root entry stands for the empty sequence.
+    m_contextSequenceTable.append(ContextSequence());
+}
 
 Highlighter::~Highlighter()
 {}
 
+Highlighter::ContextSequence::ContextSequence() : m_parent(RootSequence)
+{}
+
 Highlighter::BlockData::BlockData() : m_foldingIndentDelta(0), m_originalObservableState(-1)
 {}
 
@@ -102,13 +106,23 @@ Highlighter::KateFormatMap::KateFormatMap()
 
 void Highlighter::configureFormat(TextFormatId id, const QTextCharFormat &format)
 {
+    if (id >= m_creatorFormats.size()) {
+        m_creatorFormats.resize(id + 1);
+        m_hasCreatorFormat.resize(id + 1);
+    }
     m_creatorFormats[id] = format;
+    m_hasCreatorFormat[id] = true;
+}
+
+Highlighter::TextFormatId Highlighter::formatIdForStyle(const QString &style)
+{
+    return m_kateFormats.m_ids.value(style, Normal);
 }
 
 void  Highlighter::setDefaultContext(const QSharedPointer<Context> &defaultContext)
 {
     m_defaultContext = defaultContext;
-    m_persistentObservableStates.insert(m_defaultContext->name(), Default);
+    m_persistentObservableStates.insert(contextSequence(RootSequence, m_defaultContext), Default);
     m_indentationBasedFolding = defaultContext->definition()->isIndentationBasedFolding();
 }
 
@@ -130,7 +144,7 @@ void Highlighter::highlightBlock(const QString &text)
                 initializeBlockData();
             setupDataForBlock(text);
 
-            handleContextChange(m_currentContext->lineBeginContext(),
+            handleContextChange(m_currentContext->lineBeginSwitch(),
                                 m_currentContext->definition());
 
             ProgressData progress;
@@ -138,10 +152,11 @@ void Highlighter::highlightBlock(const QString &text)
             while (progress.offset() < length)
                 iterateThroughRules(text, length, &progress, false, m_currentContext->rules());
 
-            handleContextChange(m_currentContext->lineEndContext(),
+            handleContextChange(m_currentContext->lineEndSwitch(),
                                 m_currentContext->definition(),
                                 false);
             m_contexts.clear();
+            m_contextSequences.clear();
 
             if (m_indentationBasedFolding) {
                 applyIndentationBasedFolding(text);
@@ -191,7 +206,7 @@ void Highlighter::setupDataForBlock(const QString &text)
 
 void Highlighter::setupDefault()
 {
-    m_contexts.push_back(m_defaultContext);
+    pushContext(m_defaultContext);
 
     setCurrentBlockState(computeState(Default));
 }
@@ -199,7 +214,7 @@ void Highlighter::setupDefault()
 void Highlighter::setupFromWillContinue()
 {
     BlockData *previousData = blockData(currentBlock().previous().userData());
-    m_contexts.push_back(previousData->m_contextToContinue);
+    pushContext(previousData->m_contextToContinue);
 
     BlockData *data = blockData(currentBlock().userData());
     data->m_originalObservableState = previousData->m_originalObservableState;
@@ -217,7 +232,7 @@ void Highlighter::setupFromContinued()
 
     if (previousData->m_originalObservableState == Default ||
         previousData->m_originalObservableState == -1) {
-        m_contexts.push_back(m_defaultContext);
+        pushContext(m_defaultContext);
     } else {
         pushContextSequence(previousData->m_originalObservableState);
     }
@@ -250,12 +265,7 @@ void Highlighter::iterateThroughRules(const QString &text,
         int startOffset = progress->offset();
         const QSharedPointer<Rule> &rule = *it;
 
-        if (rule->itemData() == "String" ||
-                rule->itemData() == "Comment") {
-            m_stringOrComment = true;
-        } else {
-            m_stringOrComment = false;
-        }
+        m_stringOrComment = rule->isStringOrComment();
 
         if (rule->matchSucceed(text, length, progress)) {
             atLeastOneMatch = true;
@@ -306,9 +316,9 @@ void Highlighter::iterateThroughRules(const QString &text,
                 if (rule->hasChildren())
                     iterateThroughRules(text, length, progress, true, rule->children());
 
-                if (!rule->context().isEmpty() && contextChangeRequired(rule->context())) {
+                if (!rule->contextSwitch().isStay()) {
                     m_currentCaptures = progress->captures();
-                    changeContext(rule->context(), rule->definition());
+                    changeContext(rule->contextSwitch(), rule->definition());
                     contextChanged = true;
                 }
             }
@@ -318,9 +328,9 @@ void Highlighter::iterateThroughRules(const QString &text,
             if (!childRule && !rule->isLookAhead()) {
                 if (rule->itemData().isEmpty())
                     applyFormat(startOffset, progress->offset() - startOffset,
-                                m_currentContext->itemData(), m_currentContext->definition());
+                                m_currentContext->itemDataId(), m_currentContext->definition());
                 else
-                    applyFormat(startOffset, progress->offset() - startOffset, rule->itemData(),
+                    applyFormat(startOffset, progress->offset() - startOffset, rule->itemDataId(),
                                 rule->definition());
             }
 
@@ -338,11 +348,11 @@ void Highlighter::iterateThroughRules(const QString &text,
 
     if (!childRule && !atLeastOneMatch) {
         if (m_currentContext->isFallthrough()) {
-            handleContextChange(m_currentContext->fallthroughContext(),
+            handleContextChange(m_currentContext->fallthroughSwitch(),
                                 m_currentContext->definition());
             iterateThroughRules(text, length, progress, false, m_currentContext->rules());
         } else {
-            applyFormat(progress->offset(), 1, m_currentContext->itemData(),
+            applyFormat(progress->offset(), 1, m_currentContext->itemDataId(),
                         m_currentContext->definition());
             if (progress->isOnlySpacesSoFar() && !text.at(progress->offset()).isSpace())
                 progress->setOnlySpacesSoFar(false);
@@ -354,45 +364,38 @@ void Highlighter::iterateThroughRules(const QString &text,
     }
 }
 
-bool Highlighter::contextChangeRequired(const QString &contextName) const
-{
-    if (contextName == kStay)
-        return false;
-    return true;
-}
-
-void Highlighter::changeContext(const QString &contextName,
+void Highlighter::changeContext(const ContextSwitch &contextSwitch,
                                 const QSharedPointer<HighlightDefinition> &definition,
                                 const bool assignCurrent)
 {
-    if (contextName.startsWith(kPop)) {
-        QStringList list = contextName.split(kHash, QString::SkipEmptyParts);
-        for (int i = 0; i < list.size(); ++i)
-            m_contexts.pop_back();
+    if (contextSwitch.pops() > 0) {
+        for (int i = 0; i < contextSwitch.pops() && !m_contexts.isEmpty(); ++i)
+            popContext();
 
         if (extractObservableState(currentBlockState()) >= PersistentsStart) {
             // One or more contexts were popped during during a persistent state.
-            const QString &currentSequence = currentContextSequence();
-            if (m_persistentObservableStates.contains(currentSequence))
-                setCurrentBlockState(
-                    computeState(m_persistentObservableStates.value(currentSequence)));
+            const int currentSequence = currentContextSequence();
+            QHash<int, int>::const_iterator it =
+                m_persistentObservableStates.constFind(currentSequence);
+            if (it != m_persistentObservableStates.constEnd())
+                setCurrentBlockState(computeState(it.value()));
             else
                 setCurrentBlockState(
                     computeState(m_leadingObservableStates.value(currentSequence)));
         }
     } else {
-        const QSharedPointer<Context> &context = definition->context(contextName);
+        const QSharedPointer<Context> &context = definition->contextAt(contextSwitch.context());
 
         if (context->isDynamic())
             pushDynamicContext(context);
         else
-            m_contexts.push_back(context);
+            pushContext(context);
 
-        if (m_contexts.back()->lineEndContext() == kStay ||
+        if (m_contexts.back()->isPersistent() ||
             extractObservableState(currentBlockState()) >= PersistentsStart) {
-            const QString &currentSequence = currentContextSequence();
+            const int currentSequence = currentContextSequence();
             mapLeadingSequence(currentSequence);
-            if (m_contexts.back()->lineEndContext() == kStay) {
+            if (m_contexts.back()->isPersistent()) {
                 // A persistent context was pushed.
                 mapPersistentSequence(currentSequence);
                 setCurrentBlockState(
@@ -405,37 +408,30 @@ void Highlighter::changeContext(const QString &contextName,
         assignCurrentContext();
 }
 
-void Highlighter::handleContextChange(const QString &contextName,
+void Highlighter::handleContextChange(const ContextSwitch &contextSwitch,
                                       const QSharedPointer<HighlightDefinition> &definition,
                                       const bool setCurrent)
 {
-    if (!contextName.isEmpty() && contextChangeRequired(contextName))
-        changeContext(contextName, definition, setCurrent);
+    if (!contextSwitch.isStay())
+        changeContext(contextSwitch, definition, setCurrent);
 }
 
 void Highlighter::applyFormat(int offset,
                               int count,
-                              const QString &itemDataName,
+                              int itemDataId,
                               const QSharedPointer<HighlightDefinition> &definition)
 {
-    if (count == 0)
+    // There are some broken files. For instance, the Printf context in java.xml points to an
+    // inexistent Printf item data. These resolve to -1 and are considered to have normal text
+    // style.
+    if (count == 0 || itemDataId < 0)
         return;
 
-    QSharedPointer<ItemData> itemData;
-    try {
-        itemData = definition->itemData(itemDataName);
-    } catch (const HighlighterException &) {
-        // There are some broken files. For instance, the Printf context in java.xml points to an
-        // inexistent Printf item data. These cases are considered to have normal text style.
-        return;
-    }
-
-    TextFormatId formatId = m_kateFormats.m_ids.value(itemData->style());
+    const QSharedPointer<ItemData> &itemData = definition->itemDataAt(itemDataId);
+    const int formatId = itemData->formatId();
     if (formatId != Normal) {
-        QHash<TextFormatId, QTextCharFormat>::const_iterator cit =
-            m_creatorFormats.constFind(formatId);
-        if (cit != m_creatorFormats.constEnd()) {
-            QTextCharFormat format = cit.value();
+        if (formatId < m_hasCreatorFormat.size() && m_hasCreatorFormat.at(formatId)) {
+            QTextCharFormat format = m_creatorFormats.at(formatId);
             if (itemData->isCustomized()) {
                 // Please notice that the following are applied every time for item datas which have
                 // customizations. The configureFormats method could be used to provide a "one time"
@@ -491,17 +487,17 @@ void Highlighter::analyseConsistencyOfWillContinueBlock(const QString &text)
     }
 }
 
-void Highlighter::mapPersistentSequence(const QString &contextSequence)
+void Highlighter::mapPersistentSequence(int contextSequence)
 {
     if (!m_persistentObservableStates.contains(contextSequence)) {
         int newState = m_persistentObservableStatesCounter;
         m_persistentObservableStates.insert(contextSequence, newState);
-        m_persistentContexts.insert(newState, m_contexts);
+        m_persistentContexts.insert(newState, contextSequence);
         ++m_persistentObservableStatesCounter;
     }
 }
 
-void Highlighter::mapLeadingSequence(const QString &contextSequence)
+void Highlighter::mapLeadingSequence(int contextSequence)
 {
     if (!m_leadingObservableStates.contains(contextSequence))
         m_leadingObservableStates.insert(contextSequence,
@@ -510,18 +506,52 @@ void Highlighter::mapLeadingSequence(const QString &contextSequence)
 
 void Highlighter::pushContextSequence(int state)
 {
-    const QVector<QSharedPointer<Context> > &contexts = m_persistentContexts.value(state);
-    for (int i = 0; i < contexts.size(); ++i)
-        m_contexts.push_back(contexts.at(i));
+    QVarLengthArray<int, 16> sequences;
+    for (int sequence = m_persistentContexts.value(state, RootSequence);
+         sequence != RootSequence;
+         sequence = m_contextSequenceTable.at(sequence).m_parent) {
+        sequences.append(sequence);
+    }
+    for (int i = sequences.size() - 1; i >= 0; --i) {
+        m_contexts.push_back(m_contextSequenceTable.at(sequences.at(i)).m_context);
+        m_contextSequences.push_back(sequences.at(i));
+    }
+}
+
+int Highlighter::currentContextSequence() const
+{
+    if (m_contextSequences.isEmpty())
+        return RootSequence;
+    return m_contextSequences.back();
+}
+
+int Highlighter::contextSequence(int parent, const QSharedPointer<Context> &context)
+{
+    const QPair<int, const Context *> key(parent, context.data());
+    QHash<QPair<int, const Context *>, int>::const_iterator it =
+        m_contextSequenceIds.constFind(key);
+    if (it != m_contextSequenceIds.constEnd())
+        return it.value();
+
+    ContextSequence sequence;
+    sequence.m_parent = parent;
+    sequence.m_context = context;
+    const int id = m_contextSequenceTable.size();
+    m_contextSequenceTable.append(sequence);
+    m_contextSequenceIds.insert(key, id);
+    return id;
 }
 
-QString Highlighter::currentContextSequence() const
+void Highlighter::pushContext(const QSharedPointer<Context> &context)
 {
-    QString sequence;
-    for (int i = 0; i < m_contexts.size(); ++i)
-        sequence.append(m_contexts.at(i)->id());
+    m_contextSequences.push_back(contextSequence(currentContextSequence(), context));
+    m_contexts.push_back(context);
+}
 
-    return sequence;
+void Highlighter::popContext()
+{
+    m_contexts.pop_back();
+    m_contextSequences.pop_back();
 }
 
 Highlighter::BlockData *Highlighter::initializeBlockData()
@@ -541,11 +571,16 @@ void Highlighter::pushDynamicContext(const QSharedPointer<Context> &baseContext)
     // A dynamic context is created from another context which serves as its basis. Then,
     // its rules are updated according to the captures from the calling regular expression which
     // triggered the push of the dynamic context.
-    QSharedPointer<Context> context(new Context(*baseContext));
-    context->configureId(m_dynamicContextsCounter);
-    context->updateDynamicRules(m_currentCaptures);
-    m_contexts.push_back(context);
-    ++m_dynamicContextsCounter;
+    const QPair<const Context *, QString> key(baseContext.data(),
+                                              m_currentCaptures.join(QString(QChar(0))));
+    QSharedPointer<Context> &context = m_dynamicContexts[key];
+    if (context.isNull()) {
+        context = QSharedPointer<Context>(new Context(*baseContext));
+        context->configureId(m_dynamicContextsCounter);
+        context->updateDynamicRules(m_currentCaptures);
+        ++m_dynamicContextsCounter;
+    }
+    pushContext(context);
 }
 
 void Highlighter::assignCurrentContext()
@@ -554,7 +589,7 @@ void Highlighter::assignCurrentContext()
         // This is not supposed to happen. However, there are broken files (for example, php.xml)
         // which will cause this behaviour. In such cases pushing the default context is enough to
         // keep highlighter working.
-        m_contexts.push_back(m_defaultContext);
+        pushContext(m_defaultContext);
     }
     m_currentContext = m_contexts.back();
 }
@@ -37,8 +37,11 @@
 #include "../basetextdocumentlayout.h"
 #include "../syntaxhighlighter.h"
 #include "context.h"
+#include "contextswitch.h"
 
 #include <QtCore/QString>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtCore/QVector>
 #include <QtCore/QStack>
 #include <QtCore/QSharedPointer>
@@ -89,6 +92,7 @@ public:
     };
 
     void configureFormat(TextFormatId id, const QTextCharFormat &format);
+    static TextFormatId formatIdForStyle(const QString &style);
     //void setTabSettings(const TabSettings &ts);
     void setTabSize(int tabSize);
     void setDefaultContext(const QSharedPointer<Context> &defaultContext);
@@ -111,17 +115,19 @@ private:
                              const QList<QSharedPointer<Rule> > &rules);
 
     void assignCurrentContext();
-    bool contextChangeRequired(const QString &contextName) const;
-    void handleContextChange(const QString &contextName,
+    void handleContextChange(const ContextSwitch &contextSwitch,
                              const QSharedPointer<HighlightDefinition> &definition,
                              const bool setCurrent = true);
-    void changeContext(const QString &contextName,
+    void changeContext(const ContextSwitch &contextSwitch,
                        const QSharedPointer<HighlightDefinition> &definition,
                        const bool assignCurrent = true);
 
-    QString currentContextSequence() const;
-    void mapPersistentSequence(const QString &contextSequence);
-    void mapLeadingSequence(const QString &contextSequence);
+    void pushContext(const QSharedPointer<Context> &context);
+    void popContext();
+    int contextSequence(int parent, const QSharedPointer<Context> &context);
+    int currentContextSequence() const;
+    void mapPersistentSequence(int contextSequence);
+    void mapLeadingSequence(int contextSequence);
     void pushContextSequence(int state);
 
     void pushDynamicContext(const QSharedPointer<Context> &baseContext);
@@ -131,7 +137,7 @@ private:
 
     void applyFormat(int offset,
                      int count,
-                     const QString &itemDataName,
+                     int itemDataId,
                      const QSharedPointer<HighlightDefinition> &definition);
 
     void applyRegionBasedFolding();
@@ -144,7 +150,8 @@ private:
         QHash<QString, TextFormatId> m_ids;
     };
     static const KateFormatMap m_kateFormats;
-    QHash<TextFormatId, QTextCharFormat> m_creatorFormats;
+    QVector<QTextCharFormat> m_creatorFormats;
+    QVector<bool> m_hasCreatorFormat;
 public:
     struct BlockData : TextBlockUserData
     {
@@ -202,13 +209,30 @@ protected:
     QSharedPointer<Context> m_defaultContext;
     QSharedPointer<Context> m_currentContext;
     QVector<QSharedPointer<Context> > m_contexts;
+    // Sequence id of each prefix of m_contexts, the last one identifies the whole stack.
+    QVector<int> m_contextSequences;
+
+    // Context sequences (stacks) seen so far are interned as a tree: each entry is a context
+    // pushed on top of its parent sequence. Entry 0 is the empty sequence.
+    enum { RootSequence = 0 };
+    struct ContextSequence
+    {
+        ContextSequence();
+        int m_parent;
+        QSharedPointer<Context> m_context;
+    };
+    QVector<ContextSequence> m_contextSequenceTable;
+    QHash<QPair<int, const Context *>, int> m_contextSequenceIds;
+    // Dynamic contexts by base context and captures, so a re-highlight reuses the context
+    // and its sequence instead of interning a new one each time.
+    QHash<QPair<const Context *, QString>, QSharedPointer<Context> > m_dynamicContexts;
 
     // Mapping from context sequences to the observable persistent state they represent.
-    QHash<QString, int> m_persistentObservableStates;
+    QHash<int, int> m_persistentObservableStates;
     // Mapping from context sequences to the non-persistent observable state that led to them.
-    QHash<QString, int> m_leadingObservableStates;
+    QHash<int, int> m_leadingObservableStates;
     // Mapping from observable persistent states to context sequences (the actual "stack").
-    QHash<int, QVector<QSharedPointer<Context> > > m_persistentContexts;
+    QHash<int, int> m_persistentContexts;
 
     // Captures used in dynamic rules.
     QStringList m_currentCaptures;
@@ -46,7 +46,8 @@ ItemData::ItemData() :
     m_underlinedSpecified(false),
     m_strikedOut(false),
     m_strikeOutSpecified(false),
-    m_isCustomized(false)
+    m_isCustomized(false),
+    m_formatId(0)
 {}
 
 void ItemData::setStyle(const QString &style)
@@ -139,3 +140,9 @@ bool ItemData::isStrikeOutSpecified() const
 
 bool ItemData::isCustomized() const
 { return m_isCustomized; }
+
+void ItemData::setFormatId(int id)
+{ m_formatId = id; }
+
+int ItemData::formatId() const
+{ return m_formatId; }
@@ -72,6 +72,9 @@ public:
 
     bool isCustomized() const;
 
+    void setFormatId(int id);
+    int formatId() const;
+
 private:
     bool m_italic;
     bool m_italicSpecified;
@@ -82,6 +85,7 @@ private:
     bool m_strikedOut;
     bool m_strikeOutSpecified;
     bool m_isCustomized;
+    int m_formatId;
     QString m_style;
     QColor m_color;
     QColor m_selectionColor;
@@ -63,3 +63,6 @@ bool KeywordList::isKeyword(const QString &keyword, Qt::CaseSensitivity sensitiv
         return false;
     }
 }
+
+const QSet<QString> &KeywordList::keywords() const
+{ return m_keywords; }
@@ -46,6 +46,7 @@ public:
 
     void addKeyword(const QString &keyword);
     bool isKeyword(const QString &keyword, Qt::CaseSensitivity sensitivity) const;
+    const QSet<QString> &keywords() const;
 
 private:
     QSet<QString> m_keywords;
@@ -0,0 +1,202 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2011 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** No Commercial Usage
+**
+** This file contains pre-release code and may not be distributed.
+** You may use this file in accordance with the terms and conditions
+** contained in the Technology Preview License Agreement accompanying
+** this package.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights.  These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at qt-info@nokia.com.
+**
+**************************************************************************/
+
+#include "keywordmatcher.h"
+#include "keywordlist.h"
+
+#include <QtCore/QtAlgorithms>
+
+using namespace TextEditor;
+using namespace Internal;
+
+namespace {
+
+// Characters are folded one by one, so a folded word keeps the length of the original.
+QString foldedWord(const QString &word)
+{
+    QString folded(word);
+    for (int i = 0; i < folded.length(); ++i)
+        folded[i] = folded.at(i).toCaseFolded();
+    return folded;
+}
+
+} // anon
+
+KeywordMatcher::KeywordMatcher() :
+    m_isCached(false),
+    m_cachedWord(0),
+    m_cachedLength(0),
+    m_cachedNode(-1)
+{}
+
+int KeywordMatcher::addList(const QSharedPointer<KeywordList> &list)
+{
+    if (list.isNull())
+        return -1;
+
+    for (int i = 0; i < m_lists.size(); ++i) {
+        if (m_lists.at(i) == list)
+            return i;
+    }
+    m_lists.append(list);
+    return m_lists.size() - 1;
+}
+
+void KeywordMatcher::build()
+{
+    m_nodes.clear();
+    m_edges.clear();
+    m_keywords.clear();
+    clearCache();
+
+    for (int i = 0; i < m_lists.size(); ++i) {
+        foreach (const QString &text, m_lists.at(i)->keywords()) {
+            Keyword keyword;
+            keyword.m_folded = foldedWord(text);
+            keyword.m_text = text;
+            keyword.m_list = i;
+            m_keywords.append(keyword);
+        }
+    }
+    qSort(m_keywords.begin(), m_keywords.end());
+
+    buildNode(0, m_keywords.size(), 0);
+}
+
+// Keywords in [begin, end) share their first depth folded characters. Shorter keywords sort
+// first, so the ones ending at this node lead the range and the rest are grouped by their next
+// character, which also keeps the edges of a node sorted.
+int KeywordMatcher::buildNode(int begin, int end, int depth)
+{
+    Node node;
+    node.m_firstKeyword = begin;
+    int first = begin;
+    while (first < end && m_keywords.at(first).m_folded.length() == depth)
+        ++first;
+    node.m_keywordCount = first - begin;
+
+    node.m_firstEdge = m_edges.size();
+    node.m_edgeCount = 0;
+    for (int i = first; i < end; ) {
+        const QChar c = m_keywords.at(i).m_folded.at(depth);
+        while (i < end && m_keywords.at(i).m_folded.at(depth) == c)
+            ++i;
+        ++node.m_edgeCount;
+    }
+    m_edges.resize(m_edges.size() + node.m_edgeCount);
+
+    const int index = m_nodes.size();
+    m_nodes.append(node);
+
+    int edge = node.m_firstEdge;
+    for (int i = first; i < end; ) {
+        const QChar c = m_keywords.at(i).m_folded.at(depth);
+        int next = i;
+        while (next < end && m_keywords.at(next).m_folded.at(depth) == c)
+            ++next;
+        const int child = buildNode(i, next, depth + 1);
+        m_edges[edge].m_character = c.unicode();
+        m_edges[edge].m_node = child;
+        ++edge;
+        i = next;
+    }
+    return index;
+}
+
+bool KeywordMatcher::isCached() const
+{ return m_isCached; }
+
+void KeywordMatcher::clearCache()
+{
+    m_isCached = false;
+    m_cachedWord = 0;
+    m_cachedLength = 0;
+    m_cachedNode = -1;
+}
+
+int KeywordMatcher::findNode(const QChar *word, int length) const
+{
+    if (m_isCached && m_cachedWord == word && m_cachedLength == length)
+        return m_cachedNode;
+
+    int node = m_nodes.isEmpty() ? -1 : 0;
+    for (int i = 0; i < length && node != -1; ++i) {
+        const ushort c = word[i].toCaseFolded().unicode();
+        const int firstEdge = m_nodes.at(node).m_firstEdge;
+        const int lastEdge = firstEdge + m_nodes.at(node).m_edgeCount;
+        int low = firstEdge;
+        int high = lastEdge;
+        while (low < high) {
+            const int middle = (low + high) / 2;
+            if (m_edges.at(middle).m_character < c)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        if (low < lastEdge && m_edges.at(low).m_character == c)
+            node = m_edges.at(low).m_node;
+        else
+            node = -1;
+    }
+
+    m_isCached = true;
+    m_cachedWord = word;
+    m_cachedLength = length;
+    m_cachedNode = node;
+    return node;
+}
+
+bool KeywordMatcher::isKeyword(const QChar *word,
+                               int length,
+                               int list,
+                               Qt::CaseSensitivity sensitivity) const
+{
+    if (list == -1 || length == 0)
+        return false;
+
+    const int node = findNode(word, length);
+    if (node == -1)
+        return false;
+
+    const int firstKeyword = m_nodes.at(node).m_firstKeyword;
+    const int lastKeyword = firstKeyword + m_nodes.at(node).m_keywordCount;
+    for (int i = firstKeyword; i < lastKeyword; ++i) {
+        const Keyword &keyword = m_keywords.at(i);
+        if (keyword.m_list != list)
+            continue;
+        if (sensitivity == Qt::CaseInsensitive ||
+                QString::fromRawData(word, length) == keyword.m_text)
+            return true;
+    }
+    return false;
+}
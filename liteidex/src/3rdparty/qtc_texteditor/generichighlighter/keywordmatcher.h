@@ -0,0 +1,105 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2011 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** No Commercial Usage
+**
+** This file contains pre-release code and may not be distributed.
+** You may use this file in accordance with the terms and conditions
+** contained in the Technology Preview License Agreement accompanying
+** this package.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights.  These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at qt-info@nokia.com.
+**
+**************************************************************************/
+
+#ifndef KEYWORDMATCHER_H
+#define KEYWORDMATCHER_H
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QSharedPointer>
+
+namespace TextEditor {
+namespace Internal {
+
+class KeywordList;
+
+// KeywordMatcher merges the keyword lists used by one context into a trie over case folded
+// characters. A word is looked up directly in the text buffer, and the node found is kept
+// until clearCache() so every keyword rule tried at the same position shares one lookup.
+class KeywordMatcher
+{
+public:
+    KeywordMatcher();
+
+    int addList(const QSharedPointer<KeywordList> &list);
+    void build();
+
+    bool isCached() const;
+    void clearCache();
+
+    bool isKeyword(const QChar *word, int length, int list,
+                   Qt::CaseSensitivity sensitivity) const;
+
+private:
+    struct Node
+    {
+        int m_firstEdge;
+        int m_edgeCount;
+        int m_firstKeyword;
+        int m_keywordCount;
+    };
+
+    struct Edge
+    {
+        ushort m_character;
+        int m_node;
+    };
+
+    struct Keyword
+    {
+        QString m_folded;
+        QString m_text;
+        int m_list;
+
+        bool operator<(const Keyword &other) const { return m_folded < other.m_folded; }
+    };
+
+    int buildNode(int begin, int end, int depth);
+    int findNode(const QChar *word, int length) const;
+
+    QList<QSharedPointer<KeywordList> > m_lists;
+    QVector<Node> m_nodes;
+    QVector<Edge> m_edges;
+    QVector<Keyword> m_keywords;
+
+    mutable bool m_isCached;
+    mutable const QChar *m_cachedWord;
+    mutable int m_cachedLength;
+    mutable int m_cachedNode;
+};
+
+} // namespace Internal
+} // namespace TextEditor
+
+#endif // KEYWORDMATCHER_H
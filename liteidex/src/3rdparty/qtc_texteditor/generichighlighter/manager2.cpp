@@ -41,9 +41,15 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QXmlStreamReader>
+#include <QTimer>
 
 using namespace TextEditor::Internal;
 
+// Definitions parsed in one burst are written to the cache in one save.
+static const int kCacheSaveDelay = 5000;
+
+Manager2::Manager2() : m_cacheSaveScheduled(false)
+{}
 
 Manager2 *Manager2::instance()
 {
@@ -51,6 +57,12 @@ Manager2 *Manager2::instance()
     return &manager;
 }
 
+void Manager2::setCacheFile(const QString &fileName)
+{
+    m_cache.setFileName(fileName);
+    m_cache.load();
+}
+
 QSharedPointer<HighlightDefinitionMetaData> Manager2::parseMetadata(const QFileInfo &fileInfo)
 {
     static const QLatin1Char kSemiColon(';');
@@ -120,7 +132,12 @@ void Manager2::loadPath(const QStringList &definitionsPaths)
         QList<QSharedPointer<HighlightDefinitionMetaData> > allMetaData;
         const QFileInfoList &filesInfo = definitionsDir.entryInfoList();
         foreach (const QFileInfo &fileInfo, filesInfo) {
-            const QSharedPointer<HighlightDefinitionMetaData> &metaData = parseMetadata(fileInfo);
+            QSharedPointer<HighlightDefinitionMetaData> metaData = m_cache.metaData(fileInfo);
+            if (metaData.isNull()) {
+                metaData = parseMetadata(fileInfo);
+                if (!metaData.isNull())
+                    m_cache.setMetaData(fileInfo, metaData);
+            }
             if (!metaData.isNull())
                 allMetaData.append(metaData);
         }
@@ -195,6 +212,8 @@ void Manager2::loadPath(const QStringList &definitionsPaths)
         }
     }
 
+    if (m_cache.isDirty())
+        m_cache.save();
 }
 
 QString Manager2::definitionIdByName(const QString &name) const
@@ -226,18 +245,11 @@ QSharedPointer<HighlightDefinition> Manager2::definition(const QString &id)
         if (!definitionFile.open(QIODevice::ReadOnly | QIODevice::Text))
             return QSharedPointer<HighlightDefinition>();
 
-        QSharedPointer<HighlightDefinition> definition(new HighlightDefinition);
-        HighlightDefinitionHandler handler(definition);
-
-        QXmlInputSource source(&definitionFile);
-        QXmlSimpleReader reader;
-        reader.setContentHandler(&handler);
+        const QFileInfo fileInfo(definitionFile);
         m_isBuilding.insert(id);
-        try {
-            reader.parse(source);
-        } catch (HighlighterException &) {
-            definition.clear();
-        }
+        QSharedPointer<HighlightDefinition> definition = loadCachedDefinition(fileInfo);
+        if (definition.isNull())
+            definition = parseDefinition(&definitionFile, fileInfo);
         m_isBuilding.remove(id);
         definitionFile.close();
 
@@ -247,6 +259,60 @@ QSharedPointer<HighlightDefinition> Manager2::definition(const QString &id)
     return m_definitions.value(id);
 }
 
+QSharedPointer<HighlightDefinition> Manager2::loadCachedDefinition(const QFileInfo &fileInfo)
+{
+    const QByteArray &data = m_cache.definitionData(fileInfo);
+    if (data.isEmpty())
+        return QSharedPointer<HighlightDefinition>();
+
+    // The recorded elements go through the same handler as the xml, so include rules and
+    // context switches are resolved exactly as for a parsed definition.
+    QSharedPointer<HighlightDefinition> definition(new HighlightDefinition);
+    HighlightDefinitionHandler handler(definition);
+    try {
+        if (HighlightDefinitionRecorder::replay(data, &handler))
+            return definition;
+    } catch (HighlighterException &) {
+    }
+    return QSharedPointer<HighlightDefinition>();
+}
+
+QSharedPointer<HighlightDefinition> Manager2::parseDefinition(QIODevice *device,
+                                                              const QFileInfo &fileInfo)
+{
+    QSharedPointer<HighlightDefinition> definition(new HighlightDefinition);
+    HighlightDefinitionHandler handler(definition);
+    HighlightDefinitionRecorder recorder(&handler);
+
+    QXmlInputSource source(device);
+    QXmlSimpleReader reader;
+    reader.setContentHandler(&recorder);
+    try {
+        if (reader.parse(source)) {
+            m_cache.setDefinitionData(fileInfo, recorder.data());
+            scheduleCacheSave();
+        }
+    } catch (HighlighterException &) {
+        definition.clear();
+    }
+    return definition;
+}
+
+void Manager2::scheduleCacheSave()
+{
+    if (m_cacheSaveScheduled)
+        return;
+    m_cacheSaveScheduled = true;
+    QTimer::singleShot(kCacheSaveDelay, this, SLOT(saveCache()));
+}
+
+void Manager2::saveCache()
+{
+    m_cacheSaveScheduled = false;
+    if (m_cache.isDirty())
+        m_cache.save();
+}
+
 QSharedPointer<HighlightDefinitionMetaData> Manager2::definitionMetaData(const QString &id) const
 { return m_definitionsMetaData.value(id); }
 
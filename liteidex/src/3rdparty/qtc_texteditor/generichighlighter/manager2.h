@@ -36,6 +36,7 @@
 
 #include "highlightdefinitionmetadata.h"
 #include "highlightdefinition.h"
+#include "highlightdefinitioncache.h"
 
 #include <QtCore/QString>
 #include <QtCore/QHash>
@@ -62,7 +63,9 @@ class Manager2 : public QObject
 {
     Q_OBJECT
 public:
+    Manager2();
     static Manager2 *instance();
+    void setCacheFile(const QString &fileName);
     void loadPath(const QStringList &definitionsPaths);
 public:
     QSharedPointer<HighlightDefinitionMetaData> parseMetadata(const QFileInfo &fileInfo);
@@ -75,12 +78,22 @@ public:
     bool isBuildingDefinition(const QString &id) const;
 public:
     QStringList mimeTypes() const;
+protected:
+    QSharedPointer<HighlightDefinition> loadCachedDefinition(const QFileInfo &fileInfo);
+    QSharedPointer<HighlightDefinition> parseDefinition(QIODevice *device,
+                                                        const QFileInfo &fileInfo);
+    void scheduleCacheSave();
+public slots:
+    // Writes pending cache changes now; call on shutdown, the delayed save may not run.
+    void saveCache();
 protected:
     QHash<QString, QString> m_idByName;
     QHash<QString, QString> m_idByMimeType;
     QHash<QString, QSharedPointer<TextEditor::Internal::HighlightDefinition> > m_definitions;
     QHash<QString, QSharedPointer<TextEditor::Internal::HighlightDefinitionMetaData> > m_definitionsMetaData;
     QSet<QString> m_isBuilding;
+    HighlightDefinitionCache m_cache;
+    bool m_cacheSaveScheduled;
 };
 
 } // namespace Internal
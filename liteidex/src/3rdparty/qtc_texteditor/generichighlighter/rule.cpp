@@ -66,7 +66,8 @@ const QLatin1Char Rule::kOpeningBrace('{');
 const QLatin1Char Rule::kClosingBrace('}');
 
 Rule::Rule(bool consumesNonSpace) :
-    m_lookAhead(false), m_firstNonSpace(false), m_column(-1), m_consumesNonSpace(consumesNonSpace)
+    m_itemDataId(-1), m_stringOrComment(false), m_lookAhead(false), m_firstNonSpace(false),
+    m_column(-1), m_consumesNonSpace(consumesNonSpace)
 {}
 
 Rule::~Rule()
@@ -78,12 +79,31 @@ void Rule::setContext(const QString &context)
 const QString &Rule::context() const
 { return m_context; }
 
+void Rule::setContextSwitch(const ContextSwitch &contextSwitch)
+{ m_contextSwitch = contextSwitch; }
+
+const ContextSwitch &Rule::contextSwitch() const
+{ return m_contextSwitch; }
+
 void Rule::setItemData(const QString &itemData)
-{ m_itemData = itemData; }
+{
+    m_itemData = itemData;
+    m_stringOrComment = (itemData == QLatin1String("String")
+                         || itemData == QLatin1String("Comment"));
+}
 
 const QString &Rule::itemData() const
 { return m_itemData; }
 
+bool Rule::isStringOrComment() const
+{ return m_stringOrComment; }
+
+void Rule::setItemDataId(int id)
+{ m_itemDataId = id; }
+
+int Rule::itemDataId() const
+{ return m_itemDataId; }
+
 void Rule::setBeginRegion(const QString &begin)
 { m_beginRegion = begin; }
 
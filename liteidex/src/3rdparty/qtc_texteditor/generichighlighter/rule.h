@@ -34,6 +34,8 @@
 #ifndef RULE_H
 #define RULE_H
 
+#include "contextswitch.h"
+
 #include <QtCore/QString>
 #include <QtCore/QList>
 #include <QtCore/QSharedPointer>
@@ -53,8 +55,15 @@ public:
     void setContext(const QString &context);
     const QString &context() const;
 
+    void setContextSwitch(const ContextSwitch &contextSwitch);
+    const ContextSwitch &contextSwitch() const;
+
     void setItemData(const QString &itemData);
     const QString &itemData() const;
+    bool isStringOrComment() const;
+
+    void setItemDataId(int id);
+    int itemDataId() const;
 
     void setBeginRegion(const QString &begin);
     const QString &beginRegion() const;
@@ -147,7 +156,10 @@ private:
                                const predicate_t &p) const;
 
     QString m_context;
+    ContextSwitch m_contextSwitch;
     QString m_itemData;
+    int m_itemDataId;
+    bool m_stringOrComment;
     QString m_beginRegion;
     QString m_endRegion;
     bool m_lookAhead;
@@ -34,6 +34,7 @@
 #include "specificrules.h"
 #include "highlightdefinition.h"
 #include "keywordlist.h"
+#include "keywordmatcher.h"
 #include "progressdata.h"
 #include "reuse.h"
 #include <QDebug>
@@ -261,7 +262,8 @@ bool RegExprRule::doMatchSucceed(const QString &text,
 // Keyword
 KeywordRule::KeywordRule(const QSharedPointer<HighlightDefinition> &definition) :
     m_overrideGlobal(false),
-    m_localCaseSensitivity(Qt::CaseSensitive)
+    m_localCaseSensitivity(Qt::CaseSensitive),
+    m_listIndex(-1)
 {
     setDefinition(definition);
 }
@@ -280,6 +282,21 @@ void KeywordRule::setInsensitive(const QString &insensitive)
 void KeywordRule::setList(const QString &listName)
 { m_list = definition()->keywordList(listName); }
 
+const QSharedPointer<KeywordList> &KeywordRule::list() const
+{ return m_list; }
+
+void KeywordRule::setMatcher(const QSharedPointer<KeywordMatcher> &matcher, int listIndex)
+{
+    m_matcher = matcher;
+    m_listIndex = listIndex;
+}
+
+void KeywordRule::doProgressFinished()
+{
+    if (!m_matcher.isNull())
+        m_matcher->clearCache();
+}
+
 bool KeywordRule::doMatchSucceed(const QString &text,
                                  const int length,
                                  ProgressData *progress)
@@ -294,10 +311,22 @@ bool KeywordRule::doMatchSucceed(const QString &text,
     while (current < length && !definition()->isDelimiter(text.at(current)))
         ++current;
 
-    QString candidate =
-        QString::fromRawData(text.unicode() + progress->offset(), current - progress->offset());
-    if ((m_overrideGlobal && m_list->isKeyword(candidate, m_localCaseSensitivity)) ||
-        (!m_overrideGlobal && m_list->isKeyword(candidate, definition()->keywordsSensitive()))) {
+    const QChar *candidate = text.unicode() + progress->offset();
+    const int candidateLength = current - progress->offset();
+    const Qt::CaseSensitivity sensitivity =
+        m_overrideGlobal ? m_localCaseSensitivity : definition()->keywordsSensitive();
+
+    bool isKeyword;
+    if (!m_matcher.isNull()) {
+        // The matcher keeps its last lookup for the rest of the line.
+        if (!m_matcher->isCached())
+            progress->trackRule(this);
+        isKeyword = m_matcher->isKeyword(candidate, candidateLength, m_listIndex, sensitivity);
+    } else {
+        isKeyword = m_list->isKeyword(QString::fromRawData(candidate, candidateLength),
+                                      sensitivity);
+    }
+    if (isKeyword) {
         progress->setOffset(current);
         return true;
     }
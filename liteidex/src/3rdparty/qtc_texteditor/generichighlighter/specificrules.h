@@ -46,6 +46,7 @@ namespace TextEditor {
 namespace Internal {
 
 class KeywordList;
+class KeywordMatcher;
 class HighlightDefinition;
 
 class DetectCharRule : public DynamicRule
@@ -156,16 +157,22 @@ public:
 
     void setInsensitive(const QString &insensitive);
     void setList(const QString &listName);
+    const QSharedPointer<KeywordList> &list() const;
+
+    void setMatcher(const QSharedPointer<KeywordMatcher> &matcher, int listIndex);
 
 private:
     virtual bool doMatchSucceed(const QString &text,
                                 const int length,
                                 ProgressData *progress);
     virtual KeywordRule *doClone() const { return new KeywordRule(*this); }
+    virtual void doProgressFinished();
 
     bool m_overrideGlobal;
     Qt::CaseSensitivity m_localCaseSensitivity;
     QSharedPointer<KeywordList> m_list;
+    QSharedPointer<KeywordMatcher> m_matcher;
+    int m_listIndex;
 };
 
 class IntRule : public Rule
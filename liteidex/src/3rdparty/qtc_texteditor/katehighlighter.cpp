@@ -22,6 +22,12 @@ KateHighlighter::KateHighlighter(QObject *parent) :
 {
 }
 
+KateHighlighter::~KateHighlighter()
+{
+    //definitions parsed since the last delayed save
+    Manager2::instance()->saveCache();
+}
+
 static bool setTextCharStyle(QTextCharFormat &fmt, const QString &name, const ColorStyleScheme *scheme)
 {
     const ColorStyle *style = scheme->findStyle(name);
@@ -170,6 +176,11 @@ void KateHighlighter::setTabSize(SyntaxHighlighter *h, int tabSize)
     highlighter->setTabSize(tabSize);
 }
 
+void KateHighlighter::setCacheFile(const QString &fileName)
+{
+    Manager2::instance()->setCacheFile(fileName);
+}
+
 void KateHighlighter::loadPath(const QString &definitionsPaths)
 {
     Manager2::instance()->loadPath(QStringList(definitionsPaths));
@@ -16,9 +16,11 @@ class TEXTEDITOR_EXPORT KateHighlighter : public QObject
     Q_OBJECT
 public:
     explicit KateHighlighter(QObject *parent = 0);
+    virtual ~KateHighlighter();
     static void setColorStyle(TextEditor::SyntaxHighlighter *h,const ColorStyleScheme*);
     static void setTabSize(TextEditor::SyntaxHighlighter *h, int tabSize);
 public:
+    void setCacheFile(const QString &fileName);
     void loadPath(const QString &definitionsPaths);
     QStringList mimeTypes() const;
     QStringList mimeTypePatterns(const QString &mimeType) const;
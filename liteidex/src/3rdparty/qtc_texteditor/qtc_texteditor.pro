@@ -5,6 +5,7 @@ CONFIG += staticlib
 
 include(../../liteideutils.pri)
 include(../../utils/colorstyle/colorstyle.pri)
+include(../../utils/fileutil/fileutil.pri)
 
 DEFINES += TEXTEDITOR_LIBRARY
 INCLUDEPATH += .
@@ -20,6 +21,7 @@ HEADERS += \
     generichighlighter/reuse.h \
     generichighlighter/progressdata.h \
     generichighlighter/keywordlist.h \
+    generichighlighter/keywordmatcher.h \
     generichighlighter/itemdata.h \
     generichighlighter/includerulesinstruction.h \
     generichighlighter/highlighterexception.h \
@@ -29,8 +31,10 @@ HEADERS += \
     generichighlighter/highlightdefinition.h \
     generichighlighter/dynamicrule.h \
     generichighlighter/context.h \
+    generichighlighter/contextswitch.h \
     katehighlighter.h \
     generichighlighter/manager2.h \
+    generichighlighter/highlightdefinitioncache.h \
     colorscheme.h
 
 SOURCES += \
@@ -42,6 +46,7 @@ SOURCES += \
     generichighlighter/rule.cpp \
     generichighlighter/progressdata.cpp \
     generichighlighter/keywordlist.cpp \
+    generichighlighter/keywordmatcher.cpp \
     generichighlighter/itemdata.cpp \
     generichighlighter/includerulesinstruction.cpp \
     generichighlighter/highlighter.cpp \
@@ -52,4 +57,5 @@ SOURCES += \
     generichighlighter/context.cpp \
     katehighlighter.cpp \
     generichighlighter/manager2.cpp \
+    generichighlighter/highlightdefinitioncache.cpp \
     colorscheme.cpp
@@ -48,7 +48,10 @@
 #include <qtextcursor.h>
 #include <qdebug.h>
 #include <qtextedit.h>
+#include <qplaintextedit.h>
+#include <qscrollbar.h>
 #include <qtimer.h>
+#include <qelapsedtimer.h>
 
 using namespace TextEditor;
 
@@ -58,14 +61,25 @@ class TextEditor::SyntaxHighlighterPrivate
     Q_DECLARE_PUBLIC(SyntaxHighlighter)
 public:
     inline SyntaxHighlighterPrivate()
-        : q_ptr(0), rehighlightPending(false), inReformatBlocks(false)
+        : q_ptr(0), rehighlightPending(false), inReformatBlocks(false),
+          asyncHighlight(false), continueScheduled(false), pendingFrom(-1), pendingEnd(-1)
     {}
 
     QPointer<QTextDocument> doc;
+    QPointer<QPlainTextEdit> editor;
 
     void _q_reformatBlocks(int from, int charsRemoved, int charsAdded);
     void reformatBlocks(int from, int charsRemoved, int charsAdded);
     void reformatBlock(const QTextBlock &block, int from, int charsRemoved, int charsAdded);
+    void highlightBlocks(QTextBlock block, int endPosition, int from, int charsRemoved, int charsAdded,
+                         int stopPosition);
+
+    void _q_continueHighlight();
+    void _q_viewportChanged();
+    bool visibleBlocks(QTextBlock *first, QTextBlock *last) const;
+    void highlightVisibleBlocks();
+    void schedulePending(int position, int endPosition);
+    void clearPending();
 
     inline void rehighlight(QTextCursor &cursor, QTextCursor::MoveOperation operation) {
         inReformatBlocks = true;
@@ -89,6 +103,13 @@ public:
     QTextBlock currentBlock;
     bool rehighlightPending;
     bool inReformatBlocks;
+
+    // Async mode: blocks from pendingFrom on still need highlighting, at least up to pendingEnd.
+    enum { AsyncSliceMsecs = 20 };
+    bool asyncHighlight;
+    bool continueScheduled;
+    int pendingFrom;
+    int pendingEnd;
 };
 
 static bool adjustRange(QTextLayout::FormatRange &range, int from, int charsRemoved, int charsAdded) {
@@ -183,8 +204,18 @@ void SyntaxHighlighterPrivate::applyFormatChanges(int from, int charsRemoved, in
 
 void SyntaxHighlighterPrivate::_q_reformatBlocks(int from, int charsRemoved, int charsAdded)
 {
-    if (!inReformatBlocks)
-        reformatBlocks(from, charsRemoved, charsAdded);
+    if (inReformatBlocks)
+        return;
+
+    if (pendingFrom != -1) {
+        // Keep the pending range on the same text.
+        const int delta = charsAdded - charsRemoved;
+        if (pendingFrom > from)
+            pendingFrom = qMax(from, pendingFrom + delta);
+        if (pendingEnd > from)
+            pendingEnd = qMax(from, pendingEnd + delta);
+    }
+    reformatBlocks(from, charsRemoved, charsAdded);
 }
 
 void SyntaxHighlighterPrivate::reformatBlocks(int from, int charsRemoved, int charsAdded)
@@ -202,9 +233,39 @@ void SyntaxHighlighterPrivate::reformatBlocks(int from, int charsRemoved, int ch
     else
         endPosition =  doc->lastBlock().position() + doc->lastBlock().length(); //doc->docHandle()->length();
 
+    int stopPosition = -1;
+    QTextBlock firstVisible;
+    QTextBlock lastVisible;
+    if (asyncHighlight && visibleBlocks(&firstVisible, &lastVisible))
+        stopPosition = lastVisible.position() + lastVisible.length();
+
+    highlightBlocks(block, endPosition, from, charsRemoved, charsAdded, stopPosition);
+
+    if (pendingFrom != -1)
+        highlightVisibleBlocks();
+}
+
+// Highlights from block on until endPosition is reached and block states are stable again. In
+// async mode the pass stops at stopPosition or once the time slice is spent, and the remaining
+// blocks are left to the event loop.
+void SyntaxHighlighterPrivate::highlightBlocks(QTextBlock block, int endPosition, int from,
+                                               int charsRemoved, int charsAdded, int stopPosition)
+{
+    QElapsedTimer timer;
+    timer.start();
+
     bool forceHighlightOfNextBlock = false;
+    bool firstBlock = true;
 
     while (block.isValid() && (block.position() < endPosition || forceHighlightOfNextBlock)) {
+        if (asyncHighlight && !firstBlock &&
+                ((stopPosition >= 0 && block.position() >= stopPosition) ||
+                 timer.elapsed() >= AsyncSliceMsecs)) {
+            schedulePending(block.position(), qMax(endPosition, block.position() + 1));
+            break;
+        }
+        firstBlock = false;
+
         const int stateBeforeHighlight = block.userState();
 
         reformatBlock(block, from, charsRemoved, charsAdded);
@@ -217,6 +278,99 @@ void SyntaxHighlighterPrivate::reformatBlocks(int from, int charsRemoved, int ch
     formatChanges.clear();
 }
 
+// The visible blocks are taken from the scroll bar, the layout of the viewport editor is not
+// up to date while the document is changing.
+bool SyntaxHighlighterPrivate::visibleBlocks(QTextBlock *first, QTextBlock *last) const
+{
+    if (!editor || editor->document() != doc)
+        return false;
+
+    const int line = editor->verticalScrollBar()->value();
+    const int lines = editor->viewport()->height() / qMax(1, editor->fontMetrics().lineSpacing());
+    *first = doc->findBlockByLineNumber(line);
+    *last = doc->findBlockByLineNumber(line + lines);
+    if (!first->isValid())
+        return false;
+    if (!last->isValid())
+        *last = doc->lastBlock();
+    return true;
+}
+
+// Highlights the visible blocks that are still pending right away, starting from whatever
+// state the previous block has. The pending pass fixes them up when it gets there.
+void SyntaxHighlighterPrivate::highlightVisibleBlocks()
+{
+    QTextBlock block;
+    QTextBlock last;
+    if (!visibleBlocks(&block, &last))
+        return;
+
+    const QTextBlock pending = doc->findBlock(pendingFrom);
+    if (!pending.isValid() || pending.blockNumber() > last.blockNumber())
+        return;
+    if (block.blockNumber() < pending.blockNumber())
+        block = pending;
+
+    while (block.isValid() && block.blockNumber() <= last.blockNumber()) {
+        reformatBlock(block, -1, 0, 0);
+        block = block.next();
+    }
+    formatChanges.clear();
+
+    // The block following the visible ones was highlighted from an older state.
+    pendingEnd = qMax(pendingEnd, last.position() + last.length() + 1);
+}
+
+void SyntaxHighlighterPrivate::schedulePending(int position, int endPosition)
+{
+    if (pendingFrom == -1) {
+        pendingFrom = position;
+        pendingEnd = endPosition;
+    } else {
+        pendingFrom = qMin(pendingFrom, position);
+        pendingEnd = qMax(pendingEnd, endPosition);
+    }
+    if (!continueScheduled) {
+        continueScheduled = true;
+        QTimer::singleShot(0, q_func(), SLOT(_q_continueHighlight()));
+    }
+}
+
+void SyntaxHighlighterPrivate::clearPending()
+{
+    pendingFrom = -1;
+    pendingEnd = -1;
+}
+
+void SyntaxHighlighterPrivate::_q_continueHighlight()
+{
+    continueScheduled = false;
+    if (!doc || pendingFrom == -1)
+        return;
+
+    QTextBlock block = doc->findBlock(pendingFrom);
+    const int endPosition = pendingEnd;
+    clearPending();
+    if (!block.isValid())
+        return;
+
+    // No edit block here: opening one bumps the document revision, and listeners that
+    // skip format-only changes by revision would take every slice for a text edit.
+    inReformatBlocks = true;
+    highlightBlocks(block, endPosition, -1, 0, 0, -1);
+    inReformatBlocks = false;
+}
+
+void SyntaxHighlighterPrivate::_q_viewportChanged()
+{
+    if (!doc || pendingFrom == -1)
+        return;
+
+    inReformatBlocks = true;
+    highlightVisibleBlocks();
+    inReformatBlocks = false;
+}
+
 void SyntaxHighlighterPrivate::reformatBlock(const QTextBlock &block, int from, int charsRemoved, int charsAdded)
 {
     Q_Q(SyntaxHighlighter);
@@ -372,6 +526,7 @@ void SyntaxHighlighter::setDocument(QTextDocument *doc)
         cursor.endEditBlock();
     }
     d->doc = doc;
+    d->clearPending();
     if (d->doc) {
         connect(d->doc, SIGNAL(contentsChange(int,int,int)),
                 this, SLOT(_q_reformatBlocks(int,int,int)));
@@ -390,6 +545,58 @@ QTextDocument *SyntaxHighlighter::document() const
     return d->doc;
 }
 
+/*!
+    Enables or disables asynchronous highlighting. When enabled, a change is
+    highlighted right away only up to the end of the blocks visible in the
+    viewport editor, and the rest of the document is highlighted in short
+    batches from the event loop. Edits made meanwhile move the pending range.
+
+    \sa setViewportEditor()
+*/
+void SyntaxHighlighter::setAsyncHighlight(bool async)
+{
+    Q_D(SyntaxHighlighter);
+    d->asyncHighlight = async;
+    if (!async && d->pendingFrom != -1) {
+        const int from = d->pendingFrom;
+        const int end = d->pendingEnd;
+        d->clearPending();
+        if (d->doc) {
+            QTextCursor cursor(d->doc);
+            d->inReformatBlocks = true;
+            cursor.beginEditBlock();
+            d->highlightBlocks(d->doc->findBlock(from), end, -1, 0, 0, -1);
+            cursor.endEditBlock();
+            d->inReformatBlocks = false;
+        }
+    }
+}
+
+bool SyntaxHighlighter::isAsyncHighlight() const
+{
+    Q_D(const SyntaxHighlighter);
+    return d->asyncHighlight;
+}
+
+/*!
+    Sets the \a editor showing the document. In asynchronous mode its visible
+    blocks are highlighted first, and again when it is scrolled over blocks
+    that are still pending.
+
+    \sa setAsyncHighlight()
+*/
+void SyntaxHighlighter::setViewportEditor(QPlainTextEdit *editor)
+{
+    Q_D(SyntaxHighlighter);
+    if (d->editor)
+        disconnect(d->editor->verticalScrollBar(), SIGNAL(valueChanged(int)),
+                   this, SLOT(_q_viewportChanged()));
+    d->editor = editor;
+    if (d->editor)
+        connect(d->editor->verticalScrollBar(), SIGNAL(valueChanged(int)),
+                this, SLOT(_q_viewportChanged()));
+}
+
 /*!
     \since 4.2
 
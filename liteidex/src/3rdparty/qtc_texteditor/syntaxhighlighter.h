@@ -55,6 +55,7 @@ class QFont;
 class QColor;
 class QTextBlockUserData;
 class QTextEdit;
+class QPlainTextEdit;
 QT_END_NAMESPACE
 
 namespace TextEditor {
@@ -75,6 +76,10 @@ public:
     QTextDocument *document() const;
 
     void setExtraAdditionalFormats(const QTextBlock& block, const QList<QTextLayout::FormatRange> &formats);
+
+    void setAsyncHighlight(bool async);
+    bool isAsyncHighlight() const;
+    void setViewportEditor(QPlainTextEdit *editor);
 signals:
     void foldIndentChanged(QTextBlock block);
 public Q_SLOTS:
@@ -104,6 +109,8 @@ private:
     Q_DISABLE_COPY(SyntaxHighlighter)
     Q_PRIVATE_SLOT(d_ptr, void _q_reformatBlocks(int from, int charsRemoved, int charsAdded))
     Q_PRIVATE_SLOT(d_ptr, void _q_delayedRehighlight())
+    Q_PRIVATE_SLOT(d_ptr, void _q_continueHighlight())
+    Q_PRIVATE_SLOT(d_ptr, void _q_viewportChanged())
 
     QScopedPointer<SyntaxHighlighterPrivate> d_ptr;
 };
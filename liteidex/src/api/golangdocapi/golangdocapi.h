@@ -62,6 +62,7 @@ public:
     virtual PkgApiEnum findExp(const QString &tag, QString &exp) const = 0;
     virtual QStringList findDocUrl(const QString &tag) const = 0;
     virtual QString findDocInfo(const QString &tag) const = 0;
+    virtual QString memoryReport() const { return QString(); }
 };
 
 class IGolangDoc : public IObject
@@ -28,6 +28,9 @@
 #include <QTextCursor>
 #include <QCompleter>
 #include <QStandardItem>
+#include <QModelIndex>
+
+class QTextDocument;
 
 namespace LiteApi {
 
@@ -90,9 +93,9 @@ class ICompleter : public QObject
 public:
     ICompleter(QObject *parent): QObject(parent) {}
     virtual QCompleter *completer() const = 0;
-    virtual QStandardItem *findRoot(const QString &name) = 0;
-    virtual void clearChildItem(QStandardItem *root) = 0;
-    virtual void appendChildItem(QStandardItem *root,QString name,const QString &kind, const QString &info,const QIcon &icon, bool temp) = 0;
+    virtual QModelIndex findRoot(const QString &name) = 0;
+    virtual void clearChildItem(const QModelIndex &root) = 0;
+    virtual void appendChildItem(const QModelIndex &root,QString name,const QString &kind, const QString &info,const QIcon &icon, bool temp) = 0;
     virtual bool appendItem(const QString &name,const QIcon &icon, bool temp) = 0;
     virtual bool appendItemEx(const QString &name,const QString &kind, const QString &info,const QIcon &icon, bool temp) = 0;
     virtual void appendItems(QStringList items, const QString &kind, const QString &info,const QIcon &icon, bool temp) = 0;
@@ -130,8 +133,24 @@ signals:
     void markChanged();
 };
 
+// IUtf8Snapshot is the UTF-8 text of a document kept up to date per edited
+// block, one per document shared by every plugin. object() emits
+// blocksChanged(int from, int removed, int added).
+class IUtf8Snapshot
+{
+public:
+    virtual ~IUtf8Snapshot() {}
+    virtual QObject *object() = 0;
+    virtual QTextDocument *document() const = 0;
+    virtual QByteArray data() const = 0;
+    virtual int revision() const = 0;
+    virtual int byteOffset(int pos) const = 0;
+};
+
 } //namespace LiteApi
 
+Q_DECLARE_INTERFACE(LiteApi::IUtf8Snapshot,"LiteApi.IUtf8Snapshot/X18")
+
 
 #endif //__LITEEDITORAPI_H__
 
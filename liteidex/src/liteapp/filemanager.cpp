@@ -565,6 +565,20 @@ void FileManager::editorCreated(LiteApi::IEditor *editor)
         updateFileState(fileName);
         m_fileWatcher->addPath(fileName);
     }
+    connect(editor,SIGNAL(reloaded()),this,SLOT(editorReloaded()));
+}
+
+void FileManager::editorReloaded()
+{
+    LiteApi::IEditor *editor = qobject_cast<LiteApi::IEditor*>(sender());
+    if (!editor || editor->filePath().isEmpty()) {
+        return;
+    }
+    QString fileName = editor->filePath();
+    updateFileState(fileName);
+    //a file replaced by rename drops the old watch
+    m_fileWatcher->removePath(fileName);
+    m_fileWatcher->addPath(fileName);
 }
 
 void FileManager::editorAboutToClose(LiteApi::IEditor *editor)
@@ -76,6 +76,7 @@ public slots:
     void fileChanged(QString);
     void editorSaved(LiteApi::IEditor*);
     void editorCreated(LiteApi::IEditor*);
+    void editorReloaded();
     void editorAboutToClose(LiteApi::IEditor*);
     void checkForReload();
     void cleanRecent();
@@ -0,0 +1,199 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: astserver.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "astserver.h"
+#include <QDir>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+AstServer::AstServer(QObject *parent) :
+    QObject(parent),
+    m_lastId(0),
+    m_available(true),
+    m_replied(false),
+    m_replyId(0),
+    m_replySize(-1),
+    m_replyOk(false)
+{
+    m_process = new QProcess(this);
+    connect(m_process,SIGNAL(readyReadStandardOutput()),this,SLOT(readStdout()));
+    connect(m_process,SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(processFinished(int,QProcess::ExitStatus)));
+    connect(m_process,SIGNAL(error(QProcess::ProcessError)),this,SLOT(processError(QProcess::ProcessError)));
+}
+
+AstServer::~AstServer()
+{
+    if (m_process->state() != QProcess::NotRunning) {
+        disconnect(m_process,0,this,0);
+        m_process->closeWriteChannel();
+        if (!m_process->waitForFinished(500)) {
+            m_process->kill();
+            m_process->waitForFinished(500);
+        }
+    }
+}
+
+void AstServer::setCommand(const QString &cmd)
+{
+    m_cmd = cmd;
+}
+
+bool AstServer::isAvailable() const
+{
+    return m_available && !m_cmd.isEmpty();
+}
+
+void AstServer::ensureStarted()
+{
+    if (m_process->state() != QProcess::NotRunning) {
+        return;
+    }
+    m_buffer.clear();
+    m_replySize = -1;
+    //writes are buffered until the process runs
+    m_process->start(m_cmd,QStringList() << "-server");
+    QMapIterator<QString,QByteArray> i(m_overlays);
+    while (i.hasNext()) {
+        i.next();
+        sendUpdate(i.key(),i.value());
+    }
+}
+
+void AstServer::sendUpdate(const QString &filePath, const QByteArray &data)
+{
+    QByteArray req = "update "+QByteArray::number(data.size())+"\n";
+    req += filePath.toUtf8();
+    req += "\n";
+    m_process->write(req);
+    m_process->write(data);
+}
+
+void AstServer::updateFile(const QString &filePath, const QByteArray &data)
+{
+    QString path = QDir::cleanPath(filePath);
+    QMap<QString,QByteArray>::const_iterator it = m_overlays.constFind(path);
+    if (it != m_overlays.constEnd() && it.value() == data) {
+        return;
+    }
+    m_overlays.insert(path,data);
+    if (m_process->state() == QProcess::NotRunning) {
+        //sent with the next request
+        return;
+    }
+    sendUpdate(path,data);
+}
+
+void AstServer::removeFile(const QString &filePath)
+{
+    QString path = QDir::cleanPath(filePath);
+    if (!m_overlays.remove(path)) {
+        return;
+    }
+    if (m_process->state() == QProcess::NotRunning) {
+        return;
+    }
+    m_process->write("remove\n"+path.toUtf8()+"\n");
+}
+
+int AstServer::requestFiles(const QString &dir, const QStringList &fileNames)
+{
+    ensureStarted();
+    int id = ++m_lastId;
+    QByteArray req = "files "+QByteArray::number(id)+" "+QByteArray::number(fileNames.size())+" binary\n";
+    req += QDir::cleanPath(dir).toUtf8();
+    req += "\n";
+    foreach (QString name, fileNames) {
+        req += name.toUtf8();
+        req += "\n";
+    }
+    m_process->write(req);
+    m_pending.append(id);
+    return id;
+}
+
+// <id> <ok|error> <size>\n<data>
+void AstServer::readStdout()
+{
+    m_buffer += m_process->readAllStandardOutput();
+    while (true) {
+        if (m_replySize < 0) {
+            int pos = m_buffer.indexOf('\n');
+            if (pos < 0) {
+                break;
+            }
+            QList<QByteArray> header = m_buffer.left(pos).split(' ');
+            m_buffer.remove(0,pos+1);
+            if (header.size() != 3) {
+                continue;
+            }
+            m_replyId = header.at(0).toInt();
+            m_replyOk = (header.at(1) == "ok");
+            m_replySize = header.at(2).toInt();
+        }
+        if (m_buffer.size() < m_replySize) {
+            break;
+        }
+        QByteArray data = m_buffer.left(m_replySize);
+        m_buffer.remove(0,m_replySize);
+        m_replySize = -1;
+        m_replied = true;
+        m_pending.removeAll(m_replyId);
+        if (m_replyOk) {
+            emit finished(m_replyId,data);
+        } else {
+            emit failed(m_replyId,data);
+        }
+    }
+}
+
+void AstServer::stopped()
+{
+    if (!m_replied) {
+        m_available = false;
+    }
+    QList<int> pending = m_pending;
+    m_pending.clear();
+    foreach (int id, pending) {
+        emit failed(id,QByteArray());
+    }
+}
+
+void AstServer::processFinished(int /*code*/, QProcess::ExitStatus /*status*/)
+{
+    stopped();
+}
+
+void AstServer::processError(QProcess::ProcessError error)
+{
+    //finished is not emitted when the process could not start
+    if (error == QProcess::FailedToStart) {
+        stopped();
+    }
+}
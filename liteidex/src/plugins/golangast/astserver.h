@@ -0,0 +1,74 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: astserver.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef ASTSERVER_H
+#define ASTSERVER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QMap>
+
+// AstServer talks to a resident "goastview -server" process. unsaved
+// editor contents are sent with updateFile, the helper keeps the parsed
+// files until they change, see tools/goastview/server.go.
+class AstServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AstServer(QObject *parent = 0);
+    ~AstServer();
+    void setCommand(const QString &cmd);
+    // false once the helper exited without answering, an old goastview
+    // without server mode
+    bool isAvailable() const;
+    void updateFile(const QString &filePath, const QByteArray &data);
+    void removeFile(const QString &filePath);
+    int requestFiles(const QString &dir, const QStringList &fileNames);
+signals:
+    void finished(int id, const QByteArray &data);
+    void failed(int id, const QByteArray &error);
+protected slots:
+    void readStdout();
+    void processFinished(int code, QProcess::ExitStatus status);
+    void processError(QProcess::ProcessError error);
+protected:
+    void ensureStarted();
+    void sendUpdate(const QString &filePath, const QByteArray &data);
+    void stopped();
+protected:
+    QProcess   *m_process;
+    QString     m_cmd;
+    QByteArray  m_buffer;
+    // resent when the helper is restarted
+    QMap<QString,QByteArray> m_overlays;
+    QList<int>  m_pending;
+    int         m_lastId;
+    bool        m_available;
+    bool        m_replied;
+    int         m_replyId;
+    int         m_replySize;
+    bool        m_replyOk;
+};
+
+#endif // ASTSERVER_H
@@ -29,7 +29,11 @@
 #include <QSortFilterProxyModel>
 #include <QFont>
 #include <QVBoxLayout>
+#include <QVector>
+#include <QHash>
+#include <QSet>
 #include <QDebug>
+#include <string.h>
 //lite_memory_check_begin
 #if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
      #define _CRTDBG_MAP_ALLOC
@@ -74,6 +78,7 @@ AstWidget::AstWidget(bool outline, LiteApi::IApplication *app, QWidget *parent)
 void AstWidget::clear()
 {
     m_model->clear();
+    m_outlineFiles.clear();
     m_filterEdit->clear();
 }
 
@@ -226,21 +231,28 @@ static QString tagName(const QString &tag)
     return QString();
 }
 
-// level,tag,name,index,x,y
-void AstWidget::updateModel(const QByteArray &data)
+struct AstNode
 {
-    //save state
-    SymbolTreeState state;
-    m_tree->saveState(&state);
-
-    m_model->clear();
+    QString tag;
+    QString name;
+    QString fileName;
+    int     line;
+    int     col;
+    bool    pub;
+    QVector<int> children;
+};
 
+// level,tag,name,index,x,y
+static void parseAstNodes(const QByteArray &data, QVector<AstNode> &nodes)
+{
+    //node 0 is the root
+    nodes.append(AstNode());
     QList<QByteArray> array = data.split('\n');
-    QMap<int,QStandardItem*> items;
+    QMap<int,int> items;
     QStringList indexFiles;
     bool ok = false;
     bool bmain = false;
-    QMap<QString,GolangAstItem*> level1NameItemMap;
+    QMap<QString,int> level1NameItemMap;
     foreach (QByteArray line, array) {
         QList<QByteArray> info = line.split(',');
         if (info.size() == 2 && info.at(0) == "@") {
@@ -271,55 +283,340 @@ void AstWidget::updateModel(const QByteArray &data)
                 continue;
             }
         }
-        GolangAstItem *item = 0;
         if (level == 1) {
-            item = level1NameItemMap.value(name);
-            if (item != 0) {
-                items[level] = item;
+            int id = level1NameItemMap.value(name,-1);
+            if (id != -1) {
+                items[level] = id;
                 continue;
             }
         }
-        item = new GolangAstItem;
-        if (level == 1) {
-            level1NameItemMap.insert(name,item);
-        }
-        item->setTagName(tag);
-        item->setText(name);
-        if (!bmain && (name.at(0).isLower() || name.at(0) == '_')) {
-            item->setIcon(GolangAstIcon::instance()->iconFromTag(tag,false));
-        } else {
-            item->setIcon(GolangAstIcon::instance()->iconFromTag(tag));
-        }
-        if (tag.at(0) == '+') {
-            item->setToolTip(QString("%1").arg(tagName(tag)));
-        } else {
-            item->setToolTip(QString("%1 : %2").arg(tagName(tag)).arg(name));
-        }
+        AstNode node;
+        node.tag = tag;
+        node.name = name;
+        node.line = 0;
+        node.col = 0;
+        node.pub = bmain || !(name.at(0).isLower() || name.at(0) == '_');
         if (info.size() >= 6) {
             int index = info[3].toInt(&ok);
             if (ok && index >= 0 && index < indexFiles.size()) {
-                item->setFileName(indexFiles.at(index));
+                node.fileName = indexFiles.at(index);
             }
             int line = info[4].toInt(&ok);
             if (ok) {
-                item->setLine(line);
+                node.line = line;
             }
             int col = info[5].toInt(&ok);
             if (ok) {
-                item->setCol(col);
+                node.col = col;
             }
         }
-        QStandardItem *parent = items.value(level-1,0);
-        if (parent ) {
-            parent->appendRow(item);
-        } else {
-            m_model->appendRow(item);
+        int id = nodes.size();
+        nodes.append(node);
+        if (level == 1) {
+            level1NameItemMap.insert(name,id);
+        }
+        nodes[items.value(level-1,0)].children.append(id);
+        items[level] = id;
+    }
+}
+
+static void setAstItem(GolangAstItem *item, const AstNode &node)
+{
+    item->setFileName(node.fileName);
+    item->setLine(node.line);
+    item->setCol(node.col);
+    item->setHash(0);
+    //the setters below emit dataChanged, skip them when nothing changed
+    QIcon icon = node.pub ? GolangAstIcon::instance()->iconFromTag(node.tag) :
+                            GolangAstIcon::instance()->iconFromTag(node.tag,false);
+    if (item->icon().cacheKey() != icon.cacheKey()) {
+        item->setIcon(icon);
+    }
+    QString tip;
+    if (node.tag.at(0) == '+') {
+        tip = QString("%1").arg(tagName(node.tag));
+    } else {
+        tip = QString("%1 : %2").arg(tagName(node.tag)).arg(node.name);
+    }
+    if (item->toolTip() != tip) {
+        item->setToolTip(tip);
+    }
+}
+
+static GolangAstItem *createAstItem(const QVector<AstNode> &nodes, int id)
+{
+    const AstNode &node = nodes.at(id);
+    GolangAstItem *item = new GolangAstItem;
+    item->setTagName(node.tag);
+    item->setText(node.name);
+    setAstItem(item,node);
+    foreach (int child, node.children) {
+        item->appendRow(createAstItem(nodes,child));
+    }
+    return item;
+}
+
+static inline QString astKey(const QString &tag, const QString &name)
+{
+    return tag+QLatin1Char(',')+name;
+}
+
+// merge the children of node id into parent, items are matched by tag and
+// name so unchanged items and their view state are kept
+static void mergeAstItems(QStandardItem *parent, const QVector<AstNode> &nodes, int id)
+{
+    const QVector<int> &children = nodes.at(id).children;
+    QHash<QString,QList<QStandardItem*> > oldItems;
+    for (int i = 0; i < parent->rowCount(); i++) {
+        GolangAstItem *item = (GolangAstItem*)parent->child(i);
+        oldItems[astKey(item->tagName(),item->text())].append(item);
+    }
+    QVector<QStandardItem*> matched(children.size(),0);
+    QSet<QStandardItem*> keep;
+    for (int i = 0; i < children.size(); i++) {
+        const AstNode &node = nodes.at(children.at(i));
+        QHash<QString,QList<QStandardItem*> >::iterator it = oldItems.find(astKey(node.tag,node.name));
+        if (it != oldItems.end() && !it.value().isEmpty()) {
+            matched[i] = it.value().takeFirst();
+            keep.insert(matched[i]);
+        }
+    }
+    for (int i = parent->rowCount()-1; i >= 0; i--) {
+        if (!keep.contains(parent->child(i))) {
+            parent->removeRow(i);
+        }
+    }
+    for (int i = 0; i < children.size(); i++) {
+        QStandardItem *item = matched.at(i);
+        if (!item) {
+            parent->insertRow(i,createAstItem(nodes,children.at(i)));
+            continue;
+        }
+        if (parent->child(i) != item) {
+            //moved declaration, only this subtree is rebuilt in the view
+            parent->insertRow(i,parent->takeRow(item->row()));
+        }
+        setAstItem((GolangAstItem*)item,nodes.at(children.at(i)));
+        mergeAstItems(item,nodes,children.at(i));
+    }
+}
+
+// binary outline of goastview, see tools/goastview/outline.go
+static const int BinaryOutlineVersion = 1;
+
+static bool isBinaryOutline(const QByteArray &data)
+{
+    return data.size() >= 5 && memcmp(data.constData(),"\0LAO",4) == 0;
+}
+
+struct AstRecord
+{
+    int         tag;
+    const char *name;
+    int         nameSize;
+    int         file;
+    int         line;
+    int         col;
+    uint        hash;
+    const char *begin;
+    const char *end;
+};
+
+// AstReader decodes the binary outline in place, names are converted
+// only for the records that are merged into the model
+class AstReader
+{
+public:
+    AstReader(const char *begin, const char *end) :
+        m_ptr(begin), m_end(end), m_error(false)
+    {}
+    bool atEnd() const
+    {
+        return m_error || m_ptr >= m_end;
+    }
+    bool hasError() const
+    {
+        return m_error;
+    }
+    const char *pos() const
+    {
+        return m_ptr;
+    }
+    quint64 readUvarint()
+    {
+        quint64 v = 0;
+        for (int shift = 0; m_ptr < m_end && shift < 64; shift += 7) {
+            uchar c = uchar(*m_ptr++);
+            v |= quint64(c & 0x7f) << shift;
+            if (!(c & 0x80)) {
+                return v;
+            }
         }
-        items[level] = item;
+        m_error = true;
+        return 0;
+    }
+    const char *readBytes(quint64 size)
+    {
+        if (m_error || quint64(m_end-m_ptr) < size) {
+            m_error = true;
+            return 0;
+        }
+        const char *ptr = m_ptr;
+        m_ptr += size;
+        return ptr;
     }
+    bool readRecord(AstRecord &rec)
+    {
+        const uchar *tag = (const uchar*)readBytes(1);
+        rec.tag = tag ? *tag : 0;
+        quint64 size = readUvarint();
+        rec.name = readBytes(size);
+        rec.nameSize = int(size);
+        rec.file = int(readUvarint())-1;
+        rec.line = int(readUvarint());
+        rec.col = int(readUvarint());
+        const uchar *hash = (const uchar*)readBytes(4);
+        rec.hash = hash ? (hash[0] | hash[1] << 8 | hash[2] << 16 | uint(hash[3]) << 24) : 0;
+        size = readUvarint();
+        rec.begin = readBytes(size);
+        rec.end = rec.begin+size;
+        return !m_error;
+    }
+protected:
+    const char *m_ptr;
+    const char *m_end;
+    bool        m_error;
+};
 
-    //load state
-    m_tree->loadState(proxyModel,&state);
+static QString binaryTag(int tag)
+{
+    static QStringList tags;
+    if (tags.isEmpty()) {
+        tags << "" << "p" << "t" << "s" << "i" << "v" << "c" << "f"
+             << "+v" << "+c" << "+f" << "tm" << "tf" << "tv";
+    }
+    return tags.value(tag);
+}
+
+static AstNode recordNode(const AstRecord &rec, const QStringList &files, bool bmain)
+{
+    AstNode node;
+    node.tag = binaryTag(rec.tag);
+    node.name = QString::fromUtf8(rec.name,rec.nameSize);
+    node.fileName = files.value(rec.file);
+    node.line = rec.line;
+    node.col = rec.col;
+    node.pub = bmain || node.name.isEmpty() || !(node.name.at(0).isLower() || node.name.at(0) == '_');
+    return node;
+}
+
+static GolangAstItem *createRecordItem(const AstRecord &rec, const QStringList &files, bool bmain)
+{
+    AstNode node = recordNode(rec,files,bmain);
+    GolangAstItem *item = new GolangAstItem;
+    item->setTagName(node.tag);
+    item->setText(node.name);
+    setAstItem(item,node);
+    item->setHash(rec.hash);
+    AstReader reader(rec.begin,rec.end);
+    while (!reader.atEnd()) {
+        AstRecord child;
+        if (!reader.readRecord(child)) {
+            break;
+        }
+        item->appendRow(createRecordItem(child,files,bmain));
+    }
+    return item;
+}
+
+// like mergeAstItems, a matched item with the same subtree hash is left
+// untouched and its children are not decoded
+static void mergeRecordItems(QStandardItem *parent, const char *begin, const char *end,
+                             const QStringList &files, bool bmain, bool useHash)
+{
+    QVector<AstRecord> records;
+    QVector<QString> names;
+    AstReader reader(begin,end);
+    while (!reader.atEnd()) {
+        AstRecord rec;
+        if (!reader.readRecord(rec)) {
+            break;
+        }
+        records.append(rec);
+        names.append(QString::fromUtf8(rec.name,rec.nameSize));
+    }
+    QHash<QString,QList<QStandardItem*> > oldItems;
+    for (int i = 0; i < parent->rowCount(); i++) {
+        GolangAstItem *item = (GolangAstItem*)parent->child(i);
+        oldItems[astKey(item->tagName(),item->text())].append(item);
+    }
+    QVector<QStandardItem*> matched(records.size(),0);
+    QSet<QStandardItem*> keep;
+    for (int i = 0; i < records.size(); i++) {
+        QHash<QString,QList<QStandardItem*> >::iterator it = oldItems.find(astKey(binaryTag(records.at(i).tag),names.at(i)));
+        if (it != oldItems.end() && !it.value().isEmpty()) {
+            matched[i] = it.value().takeFirst();
+            keep.insert(matched[i]);
+        }
+    }
+    for (int i = parent->rowCount()-1; i >= 0; i--) {
+        if (!keep.contains(parent->child(i))) {
+            parent->removeRow(i);
+        }
+    }
+    for (int i = 0; i < records.size(); i++) {
+        const AstRecord &rec = records.at(i);
+        bool pkgMain = bmain;
+        if (parent == parent->model()->invisibleRootItem() && rec.tag == 1) {
+            pkgMain = (names.at(i) == "main");
+        }
+        GolangAstItem *item = (GolangAstItem*)matched.at(i);
+        if (!item) {
+            parent->insertRow(i,createRecordItem(rec,files,pkgMain));
+            continue;
+        }
+        if (parent->child(i) != item) {
+            parent->insertRow(i,parent->takeRow(item->row()));
+        }
+        if (useHash && item->hash() == rec.hash) {
+            continue;
+        }
+        setAstItem(item,recordNode(rec,files,pkgMain));
+        item->setHash(rec.hash);
+        mergeRecordItems(item,rec.begin,rec.end,files,pkgMain,useHash);
+    }
+}
+
+void AstWidget::updateModel(const QByteArray &data)
+{
+    if (isBinaryOutline(data)) {
+        if (data.at(4) != BinaryOutlineVersion) {
+            return;
+        }
+        AstReader reader(data.constData()+5,data.constData()+data.size());
+        QStringList files;
+        int count = int(reader.readUvarint());
+        for (int i = 0; i < count && !reader.hasError(); i++) {
+            quint64 size = reader.readUvarint();
+            const char *name = reader.readBytes(size);
+            if (name) {
+                files.append(QString::fromUtf8(name,int(size)));
+            }
+        }
+        if (reader.hasError()) {
+            return;
+        }
+        //file indexes are only comparable with the same file list
+        bool useHash = (files == m_outlineFiles);
+        m_outlineFiles = files;
+        mergeRecordItems(m_model->invisibleRootItem(),reader.pos(),data.constData()+data.size(),
+                         files,false,useHash);
+    } else {
+        QVector<AstNode> nodes;
+        parseAstNodes(data,nodes);
+        mergeAstItems(m_model->invisibleRootItem(),nodes,0);
+        m_outlineFiles.clear();
+    }
 
     if (m_bOutline && m_bFirst) {
         //m_tree->expandToDepth(1);
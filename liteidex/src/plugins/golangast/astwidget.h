@@ -63,6 +63,7 @@ protected:
     QSortFilterProxyModel *proxyModel;
     LiteApi::IApplication *m_liteApp;
     QString m_workPath;
+    QStringList m_outlineFiles;
 };
 
 #endif // ASTWIDGET_H
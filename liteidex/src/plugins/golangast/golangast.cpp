@@ -25,6 +25,7 @@
 #include "golangastitem.h"
 #include "golangasticon.h"
 #include "astwidget.h"
+#include "astserver.h"
 
 #include <QStackedWidget>
 #include <QDockWidget>
@@ -37,6 +38,8 @@
 #include <QDir>
 #include <QAction>
 #include <QLabel>
+#include <QPlainTextEdit>
+#include <QTextDocument>
 #include <QDebug>
 //lite_memory_check_begin
 #if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
@@ -54,6 +57,7 @@ GolangAst::GolangAst(LiteApi::IApplication *app, QObject *parent) :
     m_liteApp(app)
 {
     m_currentEditor = 0;
+    m_editorRevision = -1;
     m_blankWidget = new QLabel(tr("No outline available"));
     m_blankWidget->setAlignment(Qt::AlignCenter);
 
@@ -68,6 +72,12 @@ GolangAst::GolangAst(LiteApi::IApplication *app, QObject *parent) :
     m_processFile = new QProcess(this);
     m_timerFile = new QTimer(this);
 
+    m_astServer = new AstServer(this);
+    m_astServer->setCommand(goastviewCmd());
+    m_astId = 0;
+    m_astFileId = 0;
+    m_astFileEditor = 0;
+
     QAction *projAct = m_liteApp->toolWindowManager()->addToolWindow(Qt::RightDockWidgetArea,m_projectAstWidget,"classview",tr("Class View"),false);
     QAction *fileAct = m_liteApp->toolWindowManager()->addToolWindow(Qt::RightDockWidgetArea,m_stackedWidget,"outline",tr("Outline"),false);
     connect(projAct,SIGNAL(toggled(bool)),this,SLOT(astProjectEnable(bool)));
@@ -82,6 +92,8 @@ GolangAst::GolangAst(LiteApi::IApplication *app, QObject *parent) :
     connect(m_timer,SIGNAL(timeout()),this,SLOT(updateAstNow()));
     connect(m_processFile,SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(finishedProcessFile(int,QProcess::ExitStatus)));
     connect(m_timerFile,SIGNAL(timeout()),this,SLOT(updateAstNowFile()));
+    connect(m_astServer,SIGNAL(finished(int,QByteArray)),this,SLOT(finishedServer(int,QByteArray)));
+    connect(m_astServer,SIGNAL(failed(int,QByteArray)),this,SLOT(failedServer(int,QByteArray)));
     connect(m_projectAstWidget,SIGNAL(doubleClicked(QModelIndex)),this,SLOT(doubleClickedTree(QModelIndex)));
 
     m_liteApp->extension()->addObject("LiteApi.IGolangAst",this);
@@ -97,12 +109,26 @@ GolangAst::~GolangAst()
         m_timerFile->stop();
     }
     delete m_processFile;
+    delete m_astServer;
     m_liteApp->toolWindowManager()->removeToolWindow(m_projectAstWidget);
     m_liteApp->toolWindowManager()->removeToolWindow(m_stackedWidget);
     delete m_projectAstWidget;
     delete m_stackedWidget;
 }
 
+QString GolangAst::goastviewCmd() const
+{
+#ifdef Q_OS_WIN
+    QString goastview = "goastview.exe";
+#else
+    QString goastview = "goastview";
+#endif
+    QString cmd = m_liteApp->applicationPath();
+    cmd += "/";
+    cmd += goastview;
+    return cmd;
+}
+
 QIcon GolangAst::iconFromTag(const QString &tag, bool pub) const
 {
     return GolangAstIcon::instance()->iconFromTag(tag,pub);
@@ -260,6 +286,10 @@ void GolangAst::editorCreated(LiteApi::IEditor *editor)
                 AstWidget *w = new AstWidget(true,m_liteApp);
                 w->setWorkPath(info.absolutePath());
                 connect(w,SIGNAL(doubleClicked(QModelIndex)),this,SLOT(doubleClickedTree(QModelIndex)));
+                QPlainTextEdit *ed = LiteApi::getPlainTextEdit(editor);
+                if (ed) {
+                    connect(ed->document(),SIGNAL(contentsChange(int,int,int)),this,SLOT(editorContentsChange(int,int,int)));
+                }
                 m_stackedWidget->addWidget(w);
                 m_editorAstWidgetMap.insert(editor,w);
             }
@@ -275,6 +305,32 @@ void GolangAst::editorAboutToClose(LiteApi::IEditor *editor)
     }
     m_stackedWidget->removeWidget(w);
     m_editorAstWidgetMap.remove(editor);
+    if (m_astFileEditor == editor) {
+        m_astFileEditor = 0;
+    }
+    m_astServer->removeFile(editor->filePath());
+}
+
+void GolangAst::editorContentsChange(int /*pos*/, int removed, int added)
+{
+    //only the resident helper sees unsaved contents
+    if (!m_astServer->isAvailable() || !m_currentEditor) {
+        return;
+    }
+    QPlainTextEdit *ed = LiteApi::getPlainTextEdit(m_currentEditor);
+    if (!ed || ed->document() != sender()) {
+        return;
+    }
+    //highlighter passes change formats only and keep the text revision
+    int revision = ed->document()->revision();
+    if (removed == added && revision == m_editorRevision) {
+        return;
+    }
+    m_editorRevision = revision;
+    updateAstFile();
+    if (m_updateFilePaths.contains(QFileInfo(m_currentEditor->filePath()).filePath())) {
+        updateAst();
+    }
 }
 
 void GolangAst::editorChanged(LiteApi::IEditor *editor)
@@ -282,6 +338,11 @@ void GolangAst::editorChanged(LiteApi::IEditor *editor)
     m_editorFileName.clear();
     m_editorFilePath.clear();
     m_currentEditor = editor;
+    m_editorRevision = -1;
+    QPlainTextEdit *ed = LiteApi::getPlainTextEdit(editor);
+    if (ed) {
+        m_editorRevision = ed->document()->revision();
+    }
     AstWidget *w = m_editorAstWidgetMap.value(editor);
     if (w) {
         m_stackedWidget->setCurrentWidget(w);
@@ -334,25 +395,22 @@ void GolangAst::updateAstNow()
     if (m_updateFileNames.isEmpty()) {
         return;
     }
-#ifdef Q_OS_WIN
-    QString goastview = "goastview.exe";
-#else
-    QString goastview = "goastview";
-#endif
-    QString cmd = m_liteApp->applicationPath();
-    cmd += "/";
-    cmd += goastview;
+    if (m_astServer->isAvailable()) {
+        m_astId = m_astServer->requestFiles(m_projectAstWidget->workPath(),m_updateFileNames);
+        return;
+    }
 
     QStringList args;
     args << "-files";
     args << m_updateFileNames.join(" ");
 
-    m_process->start(cmd,args);
+    m_process->start(goastviewCmd(),args);
 }
 
 void GolangAst::updateAstFile()
 {
-    m_timerFile->start(1000);
+    //no process startup with the resident helper, follow edits closer
+    m_timerFile->start(m_astServer->isAvailable() ? 300 : 1000);
 }
 
 void GolangAst::updateAstNowFile()
@@ -363,21 +421,23 @@ void GolangAst::updateAstNowFile()
     if (m_editorFileName.isEmpty()) {
         return;
     }
-#ifdef Q_OS_WIN
-    QString goastview = "goastview.exe";
-#else
-    QString goastview = "goastview";
-#endif
-    QString cmd = m_liteApp->applicationPath();
-    cmd += "/";
-    cmd += goastview;
+    if (m_astServer->isAvailable()) {
+        LiteApi::ITextEditor *textEditor = LiteApi::getTextEditor(m_currentEditor);
+        if (textEditor && textEditor->isModified()) {
+            m_astServer->updateFile(m_editorFilePath,textEditor->utf8Data());
+        } else {
+            m_astServer->removeFile(m_editorFilePath);
+        }
+        m_astFileEditor = m_currentEditor;
+        m_astFileId = m_astServer->requestFiles(QFileInfo(m_editorFilePath).absolutePath(),QStringList() << m_editorFileName);
+        return;
+    }
     QStringList args;
     args << "-files";
     args << m_editorFileName;
-    m_processFile->start(cmd,args);
+    m_processFile->start(goastviewCmd(),args);
 }
 
-
 void GolangAst::finishedProcess(int code,QProcess::ExitStatus status)
 {
     if (code == 0 && status == QProcess::NormalExit) {
@@ -403,6 +463,32 @@ void GolangAst::finishedProcessFile(int code,QProcess::ExitStatus status)
     }
 }
 
+void GolangAst::finishedServer(int id, const QByteArray &data)
+{
+    if (id == m_astId) {
+        m_projectAstWidget->updateModel(data);
+    } else if (id == m_astFileId && m_astFileEditor) {
+        AstWidget *w = m_editorAstWidgetMap.value(m_astFileEditor);
+        if (w) {
+            w->updateModel(data);
+        }
+    }
+}
+
+void GolangAst::failedServer(int id, const QByteArray &/*error*/)
+{
+    //parse errors keep the last outline, a missing helper falls back to
+    //one goastview process per update
+    if (m_astServer->isAvailable()) {
+        return;
+    }
+    if (id == m_astId) {
+        updateAstNow();
+    } else if (id == m_astFileId) {
+        updateAstNowFile();
+    }
+}
+
 void GolangAst::doubleClickedTree(QModelIndex index)
 {
     AstWidget *w = (AstWidget*)sender();
@@ -34,6 +34,7 @@
 class QStackedWidget;
 class AstWidget;
 class QLabel;
+class AstServer;
 
 class GolangAst : public LiteApi::IGolangAst
 {
@@ -48,6 +49,8 @@ public:
     void updateModel(const QByteArray &data);
     void loadProject(LiteApi::IProject *project);
     void loadProjectPath(const QString &path);
+protected:
+    QString goastviewCmd() const;
 public slots:
     void astProjectEnable(bool);
     void astFileEnable(bool);
@@ -57,8 +60,11 @@ public slots:
     void editorAboutToClose(LiteApi::IEditor *editor);
     void editorChanged(LiteApi::IEditor*);
     void editorSaved(LiteApi::IEditor*);
+    void editorContentsChange(int,int,int);
     void finishedProcess(int,QProcess::ExitStatus);
     void finishedProcessFile(int,QProcess::ExitStatus);
+    void finishedServer(int,const QByteArray&);
+    void failedServer(int,const QByteArray&);
     void updateAst();
     void updateAstNow();
     void updateAstFile();
@@ -70,6 +76,10 @@ protected:
     QTimer  *m_timerFile;
     QProcess *m_process;
     QProcess *m_processFile;
+    AstServer *m_astServer;
+    int        m_astId;
+    int        m_astFileId;
+    LiteApi::IEditor *m_astFileEditor;
     QStringList m_updateFileNames;
     QStringList m_updateFilePaths;
     QString m_editorFileName;
@@ -79,6 +89,7 @@ protected:
     QLabel    *m_blankWidget;
     AstWidget *m_projectAstWidget;
     LiteApi::IEditor *m_currentEditor;
+    int        m_editorRevision;
     QMap<LiteApi::IEditor*,AstWidget*> m_editorAstWidgetMap;
 };
 
@@ -3,7 +3,9 @@ TEMPLATE = lib
 
 include (../../liteideplugin.pri)
 include (../../api/golangastapi/golangastapi.pri)
+include (../../api/liteenvapi/liteenvapi.pri)
 include (../../utils/symboltreeview/symboltreeview.pri)
+include (../../utils/fileutil/fileutil.pri)
 include (../../3rdparty/qtc_editutil/qtc_editutil.pri)
 
 DEFINES += GOLANGAST_LIBRARY
@@ -11,13 +13,19 @@ DEFINES += GOLANGAST_LIBRARY
 SOURCES += golangastplugin.cpp \
     golangast.cpp \
     golangasticon.cpp \
-    astwidget.cpp
+    astwidget.cpp \
+    astserver.cpp \
+    gosymbolindex.cpp \
+    workspacesymbol.cpp
 
 HEADERS += golangastplugin.h\
         golangast_global.h \
     golangast.h \
     golangasticon.h \
     astwidget.h \
+    astserver.h \
+    gosymbolindex.h \
+    workspacesymbol.h \
     golangastitem.h
 
 RESOURCES += \
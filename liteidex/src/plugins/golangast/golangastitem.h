@@ -29,6 +29,9 @@
 class GolangAstItem : public QStandardItem
 {
 public:
+    GolangAstItem() : m_line(0), m_col(0), m_hash(0)
+    {
+    }
     void setTagName(const QString &tagName)
     {
         m_tagName = tagName;
@@ -61,11 +64,21 @@ public:
     {
         return m_col;
     }
+    // subtree hash of the binary outline, 0 if unknown
+    void setHash(uint hash)
+    {
+        m_hash = hash;
+    }
+    uint hash() const
+    {
+        return m_hash;
+    }
 protected:
     QString m_tagName;
     QString m_fileName;
     int     m_line;
     int     m_col;
+    uint    m_hash;
 };
 
 
@@ -22,6 +22,7 @@
 // Creator: visualfc <visualfc@gmail.com>
 
 #include "golangastplugin.h"
+#include "workspacesymbol.h"
 #include <QAction>
 //lite_memory_check_begin
 #if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
@@ -40,7 +41,8 @@ GolangAstPlugin::GolangAstPlugin()
 
 bool GolangAstPlugin::load(LiteApi::IApplication *app)
 {
-    new GolangAst(app,this);
+    GolangAst *ast = new GolangAst(app,this);
+    new WorkspaceSymbol(app,ast,this);
     return true;
 }
 
@@ -50,6 +50,7 @@ public:
         m_info->setAnchor("visualfc");
         m_info->setVer("x15.3");
         m_info->setInfo("Golang Ast View");
+        m_info->appendDepend("plugin/liteenv");
     }
 };
 
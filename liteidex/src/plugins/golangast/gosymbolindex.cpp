@@ -0,0 +1,995 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: gosymbolindex.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "gosymbolindex.h"
+#include "fileutil/fileutil.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSet>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <string.h>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+static quint32 IndexMarker = 0x4c475349; //LGSI
+static qint32 IndexVersion = 2;
+//the index is written at most once a minute and when the indexer is destroyed
+static int IndexSaveInterval = 60000;
+
+namespace {
+
+enum TokenKind {
+    TokenEOF,
+    TokenIdent,
+    TokenLiteral,
+    TokenNewline,
+    TokenChar
+};
+
+struct Token
+{
+    TokenKind   kind;
+    const char *ptr;
+    int         size;
+    int         line;
+    const char *lineStart;
+};
+
+inline bool isIdentChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9') || c == '_' || (c & 0x80);
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isWord(const Token &tok, const char *word)
+{
+    int size = int(strlen(word));
+    return tok.size == size && memcmp(tok.ptr,word,size) == 0;
+}
+
+// GoScanner splits go source into the few token classes needed to find
+// top level declarations, comments are dropped and a general comment
+// containing a newline acts like a newline.
+class GoScanner
+{
+public:
+    GoScanner(const char *data, int size) :
+        m_ptr(data), m_end(data+size), m_lineStart(data), m_line(1)
+    {}
+    Token next()
+    {
+        Token tok;
+        tok.ptr = m_ptr;
+        tok.size = 0;
+        tok.line = m_line;
+        tok.lineStart = m_lineStart;
+        while (m_ptr < m_end) {
+            char c = *m_ptr;
+            if (c == '\n') {
+                m_ptr++;
+                tok.kind = TokenNewline;
+                newline();
+                return tok;
+            }
+            if (c == ' ' || c == '\t' || c == '\r') {
+                m_ptr++;
+                continue;
+            }
+            if (c == '/' && m_ptr+1 < m_end && m_ptr[1] == '/') {
+                while (m_ptr < m_end && *m_ptr != '\n') {
+                    m_ptr++;
+                }
+                continue;
+            }
+            if (c == '/' && m_ptr+1 < m_end && m_ptr[1] == '*') {
+                bool hasNewline = false;
+                m_ptr += 2;
+                while (m_ptr < m_end) {
+                    if (*m_ptr == '*' && m_ptr+1 < m_end && m_ptr[1] == '/') {
+                        m_ptr += 2;
+                        break;
+                    }
+                    if (*m_ptr++ == '\n') {
+                        hasNewline = true;
+                        newline();
+                    }
+                }
+                if (hasNewline) {
+                    tok.kind = TokenNewline;
+                    return tok;
+                }
+                continue;
+            }
+            break;
+        }
+        if (m_ptr >= m_end) {
+            tok.kind = TokenEOF;
+            return tok;
+        }
+        tok.ptr = m_ptr;
+        tok.line = m_line;
+        tok.lineStart = m_lineStart;
+        char c = *m_ptr;
+        if (isDigit(c) || (c == '.' && m_ptr+1 < m_end && isDigit(m_ptr[1]))) {
+            while (m_ptr < m_end && (isIdentChar(*m_ptr) || *m_ptr == '.')) {
+                m_ptr++;
+            }
+            tok.kind = TokenLiteral;
+        } else if (isIdentChar(c)) {
+            while (m_ptr < m_end && isIdentChar(*m_ptr)) {
+                m_ptr++;
+            }
+            tok.kind = TokenIdent;
+        } else if (c == '"' || c == '\'') {
+            m_ptr++;
+            while (m_ptr < m_end && *m_ptr != c && *m_ptr != '\n') {
+                if (*m_ptr == '\\' && m_ptr+1 < m_end) {
+                    m_ptr++;
+                }
+                m_ptr++;
+            }
+            if (m_ptr < m_end && *m_ptr == c) {
+                m_ptr++;
+            }
+            tok.kind = TokenLiteral;
+        } else if (c == '`') {
+            m_ptr++;
+            while (m_ptr < m_end && *m_ptr != '`') {
+                if (*m_ptr++ == '\n') {
+                    newline();
+                }
+            }
+            if (m_ptr < m_end) {
+                m_ptr++;
+            }
+            tok.kind = TokenLiteral;
+        } else {
+            m_ptr++;
+            // ++ and -- end a statement like an operand
+            if ((c == '+' || c == '-') && m_ptr < m_end && *m_ptr == c) {
+                m_ptr++;
+            }
+            tok.kind = TokenChar;
+        }
+        tok.size = int(m_ptr-tok.ptr);
+        return tok;
+    }
+protected:
+    void newline()
+    {
+        m_line++;
+        m_lineStart = m_ptr;
+    }
+protected:
+    const char *m_ptr;
+    const char *m_end;
+    const char *m_lineStart;
+    int         m_line;
+};
+
+enum ScanState {
+    StateNone,
+    StatePackage,
+    StateFunc,
+    StateRecv,
+    StateFuncName,
+    StateSpec,
+    StateTypeKind,
+    StateNames,
+    StateNextName
+};
+
+// editor columns count utf-16 units, the source is utf-8 bytes
+inline int textColumn(const char *begin, const char *end)
+{
+    int col = 1;
+    for (const char *p = begin; p < end; p++) {
+        uchar c = uchar(*p);
+        if ((c & 0xC0) == 0x80) {
+            continue;
+        }
+        //four byte sequences are a surrogate pair
+        col += (c >= 0xF0) ? 2 : 1;
+    }
+    return col;
+}
+
+inline void appendSymbol(QVector<GoSymbol> &symbols, const Token &tok, char kind, const QString &recv)
+{
+    if (tok.size == 1 && tok.ptr[0] == '_') {
+        return;
+    }
+    if (kind == 'f' && isWord(tok,"init")) {
+        return;
+    }
+    GoSymbol sym;
+    sym.name = QString::fromUtf8(tok.ptr,tok.size);
+    sym.kind = kind;
+    sym.line = tok.line;
+    sym.col = textColumn(tok.lineStart,tok.ptr);
+    if (kind == 'm') {
+        sym.recv = recv;
+    }
+    symbols.append(sym);
+}
+
+class SymbolLess
+{
+public:
+    SymbolLess(const QVector<GoSymbolFile> &files) : m_files(files) {}
+    const QString &name(const GoSymbolRef &ref) const
+    {
+        return m_files.at(ref.file).symbols.at(ref.symbol).name;
+    }
+    bool operator()(const GoSymbolRef &a, const GoSymbolRef &b) const
+    {
+        int r = QString::compare(name(a),name(b),Qt::CaseInsensitive);
+        if (r == 0) {
+            r = QString::compare(name(a),name(b));
+        }
+        return r < 0;
+    }
+    bool operator()(const GoSymbolRef &a, const QString &key) const
+    {
+        return QString::compare(name(a),key,Qt::CaseInsensitive) < 0;
+    }
+    bool operator()(const QString &key, const GoSymbolRef &a) const
+    {
+        return QString::compare(key,name(a),Qt::CaseInsensitive) < 0;
+    }
+protected:
+    const QVector<GoSymbolFile> &m_files;
+};
+
+inline bool matchQualifier(const GoSymbolFile &file, const GoSymbol &sym, const QString &qualifier)
+{
+    return file.pkgName.startsWith(qualifier,Qt::CaseInsensitive) ||
+            sym.recv.startsWith(qualifier,Qt::CaseInsensitive);
+}
+
+class GoSymbolScanTask : public QRunnable
+{
+public:
+    GoSymbolScanTask(const QStringList &files, GoSymbolFile *result, int begin, int end, volatile bool *stop) :
+        m_files(files), m_result(result), m_begin(begin), m_end(end), m_stop(stop)
+    {}
+    virtual void run()
+    {
+        for (int i = m_begin; i < m_end && !*m_stop; i++) {
+            GoSymbolFile &entry = m_result[i];
+            QFileInfo info(m_files.at(i));
+            entry.path = info.filePath();
+            entry.mtime = info.lastModified().toTime_t();
+            entry.size = info.size();
+            QFile file(entry.path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                continue;
+            }
+            scanGoSymbols(file.readAll(),entry.pkgName,entry.symbols);
+        }
+    }
+protected:
+    const QStringList &m_files;
+    GoSymbolFile  *m_result;
+    int            m_begin;
+    int            m_end;
+    volatile bool *m_stop;
+};
+
+} // namespace
+
+void scanGoSymbols(const QByteArray &data, QString &pkgName, QVector<GoSymbol> &symbols)
+{
+    GoScanner scanner(data.constData(),data.size());
+    ScanState state = StateNone;
+    char kind = 0;
+    char groupKind = 0;
+    int groupDepth = 0;
+    bool specStart = false;
+    bool declStart = true;
+    int brace = 0;
+    int paren = 0;
+    int bracket = 0;
+    int recvDepth = 0;
+    QString recv;
+    bool semicolon = false;
+    for (;;) {
+        Token tok = scanner.next();
+        if (tok.kind == TokenEOF) {
+            break;
+        }
+        char ch = 0;
+        if (tok.kind == TokenNewline) {
+            if (!semicolon) {
+                continue;
+            }
+            ch = ';';
+        } else if (tok.kind == TokenChar && tok.size == 1) {
+            ch = tok.ptr[0];
+        }
+        semicolon = false;
+        bool inGroup = groupDepth > 0 && paren == groupDepth && brace == 0 && bracket == 0;
+        if (tok.kind == TokenIdent) {
+            semicolon = true;
+            switch (state) {
+            case StatePackage:
+                pkgName = QString::fromUtf8(tok.ptr,tok.size);
+                state = StateNone;
+                break;
+            case StateFunc:
+                appendSymbol(symbols,tok,'f',recv);
+                state = StateNone;
+                break;
+            case StateFuncName:
+                appendSymbol(symbols,tok,'m',recv);
+                state = StateNone;
+                break;
+            case StateRecv:
+                if (paren == recvDepth && bracket == 0) {
+                    recv = QString::fromUtf8(tok.ptr,tok.size);
+                }
+                break;
+            case StateSpec:
+            case StateNextName:
+                appendSymbol(symbols,tok,kind,recv);
+                state = (kind == 't') ? StateTypeKind : StateNames;
+                break;
+            case StateTypeKind:
+                if (bracket > 0) {
+                    //type parameters
+                    break;
+                }
+                if (!symbols.isEmpty() && isWord(tok,"struct")) {
+                    symbols.last().kind = 's';
+                } else if (!symbols.isEmpty() && isWord(tok,"interface")) {
+                    symbols.last().kind = 'i';
+                }
+                state = StateNone;
+                break;
+            case StateNames:
+                state = StateNone;
+                break;
+            case StateNone:
+                if (declStart) {
+                    if (isWord(tok,"package")) {
+                        state = StatePackage;
+                    } else if (isWord(tok,"func")) {
+                        state = StateFunc;
+                    } else if (isWord(tok,"type")) {
+                        state = StateSpec;
+                        kind = 't';
+                    } else if (isWord(tok,"var")) {
+                        state = StateSpec;
+                        kind = 'v';
+                    } else if (isWord(tok,"const")) {
+                        state = StateSpec;
+                        kind = 'c';
+                    }
+                } else if (inGroup && specStart) {
+                    kind = groupKind;
+                    appendSymbol(symbols,tok,kind,recv);
+                    state = (kind == 't') ? StateTypeKind : StateNames;
+                }
+                break;
+            }
+            specStart = false;
+            declStart = false;
+            continue;
+        }
+        declStart = false;
+        if (tok.kind == TokenLiteral) {
+            semicolon = true;
+        } else if (tok.kind == TokenChar && tok.size == 2) {
+            semicolon = true;
+        }
+        switch (ch) {
+        case '(':
+            if (state == StateFunc) {
+                state = StateRecv;
+                recvDepth = paren+1;
+                recv.clear();
+            } else if (state == StateSpec) {
+                groupDepth = paren+1;
+                groupKind = kind;
+                specStart = true;
+                state = StateNone;
+                paren++;
+                continue;
+            }
+            paren++;
+            break;
+        case ')':
+            semicolon = true;
+            paren = qMax(0,paren-1);
+            if (state == StateRecv && paren < recvDepth) {
+                state = StateFuncName;
+                specStart = false;
+                continue;
+            }
+            if (groupDepth > 0 && paren < groupDepth) {
+                groupDepth = 0;
+            }
+            break;
+        case '[':
+            bracket++;
+            break;
+        case ']':
+            semicolon = true;
+            bracket = qMax(0,bracket-1);
+            break;
+        case '{':
+            brace++;
+            break;
+        case '}':
+            semicolon = true;
+            brace = qMax(0,brace-1);
+            break;
+        case ';':
+            specStart = inGroup;
+            declStart = groupDepth == 0 && brace == 0 && paren == 0 && bracket == 0;
+            if (state != StateRecv) {
+                state = StateNone;
+            }
+            continue;
+        case ',':
+            if (state == StateNames) {
+                state = StateNextName;
+                specStart = false;
+                continue;
+            }
+            break;
+        }
+        specStart = false;
+        if (state == StateTypeKind && (bracket > 0 || ch == ']')) {
+            continue;
+        }
+        if (state != StateRecv) {
+            state = StateNone;
+        }
+    }
+}
+
+GoSymbolIndex::GoSymbolIndex() :
+    m_symbolCount(0), m_emptyCount(0), m_revision(0), m_modified(false)
+{
+}
+
+bool GoSymbolIndex::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 marker;
+    qint32 version;
+    stream >> marker >> version;
+    if (stream.status() != QDataStream::Ok || marker != IndexMarker ||
+            version != IndexVersion) {
+        return false;
+    }
+    QVector<GoSymbolFile> files;
+    qint32 count;
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        GoSymbolFile entry;
+        qint32 symbolCount;
+        stream >> entry.path >> entry.pkgName >> entry.mtime >> entry.size >> symbolCount;
+        for (int j = 0; j < symbolCount && stream.status() == QDataStream::Ok; j++) {
+            GoSymbol sym;
+            qint8 kind;
+            qint32 line, col;
+            stream >> sym.name >> sym.recv >> kind >> line >> col;
+            sym.kind = char(kind);
+            sym.line = line;
+            sym.col = col;
+            entry.symbols.append(sym);
+        }
+        files.append(entry);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    rebuild(files);
+    QMutexLocker locker(&m_mutex);
+    m_modified = false;
+    return true;
+}
+
+bool GoSymbolIndex::save(const QString &fileName)
+{
+    //write a shared copy outside the lock, lookups go on meanwhile
+    m_mutex.lock();
+    QVector<GoSymbolFile> files = m_files;
+    int fileCount = m_fileIndex.size();
+    int revision = m_revision;
+    m_mutex.unlock();
+
+    QByteArray data;
+    QDataStream stream(&data,QIODevice::WriteOnly);
+    stream << IndexMarker << IndexVersion;
+    stream << qint32(fileCount);
+    foreach (const GoSymbolFile &entry, files) {
+        if (entry.path.isEmpty()) {
+            continue;
+        }
+        stream << entry.path << entry.pkgName << entry.mtime << entry.size;
+        stream << qint32(entry.symbols.size());
+        foreach (const GoSymbol &sym, entry.symbols) {
+            stream << sym.name << sym.recv << qint8(sym.kind) << qint32(sym.line) << qint32(sym.col);
+        }
+    }
+    if (stream.status() != QDataStream::Ok || !FileUtil::replaceFile(fileName,data)) {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (m_revision == revision) {
+        m_modified = false;
+    }
+    return true;
+}
+
+bool GoSymbolIndex::isModified() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_modified;
+}
+
+int GoSymbolIndex::fileCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_fileIndex.size();
+}
+
+int GoSymbolIndex::symbolCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_symbolCount;
+}
+
+QHash<QString,QPair<uint,qint64> > GoSymbolIndex::stamps() const
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString,QPair<uint,qint64> > stamps;
+    stamps.reserve(m_fileIndex.size());
+    foreach (const GoSymbolFile &entry, m_files) {
+        if (!entry.path.isEmpty()) {
+            stamps.insert(entry.path,qMakePair(entry.mtime,entry.size));
+        }
+    }
+    return stamps;
+}
+
+void GoSymbolIndex::update(const QVector<GoSymbolFile> &files, const QStringList &removed)
+{
+    //only the indexer thread writes, change copies outside the lock and
+    //publish files and sorted array in one step
+    m_mutex.lock();
+    QVector<GoSymbolFile> allFiles = m_files;
+    QHash<QString,int> fileIndex = m_fileIndex;
+    QVector<GoSymbolRef> sorted = m_sorted;
+    int emptyCount = m_emptyCount;
+    m_mutex.unlock();
+
+    QSet<int> changed;
+    foreach (const QString &fileName, removed) {
+        QHash<QString,int>::iterator it = fileIndex.find(fileName);
+        if (it == fileIndex.end()) {
+            continue;
+        }
+        allFiles[it.value()] = GoSymbolFile();
+        changed.insert(it.value());
+        fileIndex.erase(it);
+        emptyCount++;
+    }
+    foreach (const GoSymbolFile &entry, files) {
+        int index = fileIndex.value(entry.path,-1);
+        if (index == -1) {
+            index = allFiles.size();
+            allFiles.append(entry);
+            fileIndex.insert(entry.path,index);
+        } else {
+            allFiles[index] = entry;
+        }
+        changed.insert(index);
+    }
+    if (changed.isEmpty()) {
+        return;
+    }
+    if (emptyCount > fileIndex.size()) {
+        //too many empty slots, compact the files
+        QVector<GoSymbolFile> live;
+        live.reserve(fileIndex.size());
+        foreach (const GoSymbolFile &entry, allFiles) {
+            if (!entry.path.isEmpty()) {
+                live.append(entry);
+            }
+        }
+        rebuild(live);
+        QMutexLocker locker(&m_mutex);
+        m_modified = true;
+        return;
+    }
+    sorted = mergeFiles(allFiles,sorted,changed);
+
+    QMutexLocker locker(&m_mutex);
+    m_files = allFiles;
+    m_fileIndex = fileIndex;
+    m_sorted = sorted;
+    m_symbolCount = sorted.size();
+    m_emptyCount = emptyCount;
+    m_modified = true;
+    m_revision++;
+}
+
+// drop the symbols of the changed slots from the sorted array and insert
+// their new symbols, the kept entries are copied in order, not sorted again
+QVector<GoSymbolRef> GoSymbolIndex::mergeFiles(const QVector<GoSymbolFile> &files,
+                                               const QVector<GoSymbolRef> &sorted,
+                                               const QSet<int> &changed)
+{
+    SymbolLess less(files);
+    QVector<GoSymbolRef> added;
+    foreach (int index, changed) {
+        for (int j = 0; j < files.at(index).symbols.size(); j++) {
+            GoSymbolRef ref;
+            ref.file = index;
+            ref.symbol = j;
+            added.append(ref);
+        }
+    }
+    std::sort(added.begin(),added.end(),less);
+
+    QVector<GoSymbolRef> kept;
+    kept.reserve(sorted.size());
+    foreach (const GoSymbolRef &ref, sorted) {
+        if (!changed.contains(ref.file)) {
+            kept.append(ref);
+        }
+    }
+
+    QVector<GoSymbolRef> merged;
+    merged.reserve(kept.size()+added.size());
+    QVector<GoSymbolRef>::const_iterator from = kept.constBegin();
+    foreach (const GoSymbolRef &ref, added) {
+        QVector<GoSymbolRef>::const_iterator to = std::upper_bound(from,kept.constEnd(),ref,less);
+        for (; from != to; ++from) {
+            merged.append(*from);
+        }
+        merged.append(ref);
+    }
+    for (; from != kept.constEnd(); ++from) {
+        merged.append(*from);
+    }
+    return merged;
+}
+
+void GoSymbolIndex::rebuild(const QVector<GoSymbolFile> &files)
+{
+    QVector<GoSymbolRef> sorted;
+    QHash<QString,int> fileIndex;
+    int count = 0;
+    foreach (const GoSymbolFile &entry, files) {
+        count += entry.symbols.size();
+    }
+    sorted.reserve(count);
+    fileIndex.reserve(files.size());
+    for (int i = 0; i < files.size(); i++) {
+        fileIndex.insert(files.at(i).path,i);
+        for (int j = 0; j < files.at(i).symbols.size(); j++) {
+            GoSymbolRef ref;
+            ref.file = i;
+            ref.symbol = j;
+            sorted.append(ref);
+        }
+    }
+    std::sort(sorted.begin(),sorted.end(),SymbolLess(files));
+
+    QMutexLocker locker(&m_mutex);
+    m_files = files;
+    m_fileIndex = fileIndex;
+    m_sorted = sorted;
+    m_symbolCount = count;
+    m_emptyCount = 0;
+    m_revision++;
+}
+
+GoSymbolMatch GoSymbolIndex::match(const GoSymbolRef &ref) const
+{
+    const GoSymbolFile &file = m_files.at(ref.file);
+    const GoSymbol &sym = file.symbols.at(ref.symbol);
+    GoSymbolMatch m;
+    m.name = sym.name;
+    m.recv = sym.recv;
+    m.pkgName = file.pkgName;
+    m.filePath = file.path;
+    m.kind = sym.kind;
+    m.line = sym.line;
+    m.col = sym.col;
+    return m;
+}
+
+QList<GoSymbolMatch> GoSymbolIndex::find(const QString &text, int limit) const
+{
+    QList<GoSymbolMatch> result;
+    QString name = text.trimmed();
+    QString qualifier;
+    int pos = name.lastIndexOf('.');
+    if (pos >= 0) {
+        qualifier = name.left(pos);
+        name = name.mid(pos+1);
+    }
+    if (name.isEmpty() && qualifier.isEmpty()) {
+        return result;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    SymbolLess less(m_files);
+    //prefix matches are one range of the sorted array
+    QVector<GoSymbolRef>::const_iterator it = std::lower_bound(m_sorted.constBegin(),m_sorted.constEnd(),name,less);
+    for (; it != m_sorted.constEnd() && result.size() < limit; ++it) {
+        const GoSymbolFile &file = m_files.at(it->file);
+        const GoSymbol &sym = file.symbols.at(it->symbol);
+        if (!sym.name.startsWith(name,Qt::CaseInsensitive)) {
+            break;
+        }
+        if (!qualifier.isEmpty() && !matchQualifier(file,sym,qualifier)) {
+            continue;
+        }
+        result.append(match(*it));
+    }
+    if (name.isEmpty()) {
+        return result;
+    }
+    //then names containing the text
+    for (it = m_sorted.constBegin(); it != m_sorted.constEnd() && result.size() < limit; ++it) {
+        const GoSymbolFile &file = m_files.at(it->file);
+        const GoSymbol &sym = file.symbols.at(it->symbol);
+        if (sym.name.size() <= name.size() ||
+                sym.name.startsWith(name,Qt::CaseInsensitive) ||
+                !sym.name.contains(name,Qt::CaseInsensitive)) {
+            continue;
+        }
+        if (!qualifier.isEmpty() && !matchQualifier(file,sym,qualifier)) {
+            continue;
+        }
+        result.append(match(*it));
+    }
+    return result;
+}
+
+QList<GoSymbolMatch> GoSymbolIndex::findExact(const QString &name, const QString &qualifier) const
+{
+    QList<GoSymbolMatch> result;
+    if (name.isEmpty()) {
+        return result;
+    }
+    QMutexLocker locker(&m_mutex);
+    SymbolLess less(m_files);
+    QVector<GoSymbolRef>::const_iterator it = std::lower_bound(m_sorted.constBegin(),m_sorted.constEnd(),name,less);
+    for (; it != m_sorted.constEnd(); ++it) {
+        const GoSymbolFile &file = m_files.at(it->file);
+        const GoSymbol &sym = file.symbols.at(it->symbol);
+        if (sym.name.compare(name,Qt::CaseInsensitive) != 0) {
+            break;
+        }
+        if (sym.name != name) {
+            continue;
+        }
+        if (!qualifier.isEmpty() && file.pkgName != qualifier && sym.recv != qualifier) {
+            continue;
+        }
+        result.append(match(*it));
+    }
+    return result;
+}
+
+GoSymbolIndexThread::GoSymbolIndexThread(GoSymbolIndex *index, QObject *parent) :
+    QThread(parent),
+    m_index(index),
+    m_fullScan(false),
+    m_loaded(false),
+    m_stop(false)
+{
+}
+
+GoSymbolIndexThread::~GoSymbolIndexThread()
+{
+    stop();
+    wait();
+    if (m_loaded && !m_cacheFile.isEmpty() && m_index->isModified()) {
+        m_index->save(m_cacheFile);
+    }
+}
+
+void GoSymbolIndexThread::setCacheFile(const QString &fileName)
+{
+    m_cacheFile = fileName;
+}
+
+void GoSymbolIndexThread::setRoots(const QStringList &roots)
+{
+    QMutexLocker locker(&m_mutex);
+    m_roots.clear();
+    foreach (QString root, roots) {
+        m_roots.append(QDir::cleanPath(QDir::fromNativeSeparators(root)+"/src"));
+    }
+    m_roots.removeDuplicates();
+    m_fullScan = true;
+}
+
+void GoSymbolIndexThread::updateFiles(const QStringList &files)
+{
+    QMutexLocker locker(&m_mutex);
+    m_files.append(files);
+}
+
+bool GoSymbolIndexThread::hasPending() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_stop && (m_fullScan || !m_files.isEmpty());
+}
+
+void GoSymbolIndexThread::stop()
+{
+    m_stop = true;
+}
+
+void GoSymbolIndexThread::walk(const QString &path, QStringList &files) const
+{
+    if (m_stop) {
+        return;
+    }
+    QDir dir(path);
+    foreach (QFileInfo info, dir.entryInfoList(QDir::Dirs|QDir::Files|QDir::NoDotAndDotDot|QDir::NoSymLinks)) {
+        QString name = info.fileName();
+        if (info.isDir()) {
+            if (name.startsWith('.') || name.startsWith('_') || name == "testdata") {
+                continue;
+            }
+            walk(info.filePath(),files);
+        } else if (name.endsWith(".go") && !name.endsWith("_test.go")) {
+            files.append(info.filePath());
+        }
+    }
+}
+
+bool GoSymbolIndexThread::underRoots(const QString &fileName, const QStringList &roots) const
+{
+    if (!fileName.endsWith(".go") || fileName.endsWith("_test.go")) {
+        return false;
+    }
+    foreach (QString root, roots) {
+        if (fileName.startsWith(root+"/")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GoSymbolIndexThread::run()
+{
+    if (!m_loaded) {
+        m_index->load(m_cacheFile);
+        m_loaded = true;
+    }
+    while (!m_stop) {
+        m_mutex.lock();
+        bool fullScan = m_fullScan;
+        QStringList roots = m_roots;
+        QStringList updates = m_files;
+        m_fullScan = false;
+        m_files.clear();
+        m_mutex.unlock();
+        if (!fullScan && updates.isEmpty()) {
+            break;
+        }
+
+        QHash<QString,QPair<uint,qint64> > stamps = m_index->stamps();
+        QStringList files;
+        QStringList removed;
+        if (fullScan) {
+            foreach (QString root, roots) {
+                walk(root,files);
+            }
+            QSet<QString> seen;
+            foreach (const QString &fileName, files) {
+                seen.insert(fileName);
+            }
+            QHash<QString,QPair<uint,qint64> >::const_iterator it = stamps.constBegin();
+            for (; it != stamps.constEnd(); ++it) {
+                if (!seen.contains(it.key())) {
+                    removed.append(it.key());
+                }
+            }
+        } else {
+            foreach (QString fileName, updates) {
+                fileName = QDir::cleanPath(fileName);
+                if (!underRoots(fileName,roots)) {
+                    continue;
+                }
+                if (QFile::exists(fileName)) {
+                    files.append(fileName);
+                } else if (stamps.contains(fileName)) {
+                    removed.append(fileName);
+                }
+            }
+        }
+        if (m_stop) {
+            break;
+        }
+        QStringList changed;
+        foreach (const QString &fileName, files) {
+            QHash<QString,QPair<uint,qint64> >::const_iterator it = stamps.constFind(fileName);
+            if (it != stamps.constEnd()) {
+                QFileInfo info(fileName);
+                if (it.value().first == info.lastModified().toTime_t() &&
+                        it.value().second == info.size()) {
+                    continue;
+                }
+            }
+            changed.append(fileName);
+        }
+        if (changed.isEmpty() && removed.isEmpty()) {
+            continue;
+        }
+
+        //each task fills its own slots of the result
+        QVector<GoSymbolFile> result(changed.size());
+        QThreadPool pool;
+        pool.setMaxThreadCount(QThread::idealThreadCount());
+        const int chunk = 64;
+        for (int i = 0; i < changed.size(); i += chunk) {
+            pool.start(new GoSymbolScanTask(changed,result.data(),i,qMin(i+chunk,changed.size()),&m_stop));
+        }
+        pool.waitForDone();
+        if (m_stop) {
+            break;
+        }
+        m_index->update(result,removed);
+        //a full scan is written at once, saved editors are batched
+        if (!m_cacheFile.isEmpty() && (fullScan || !m_saveTimer.isValid() ||
+                                        m_saveTimer.elapsed() > IndexSaveInterval)) {
+            m_index->save(m_cacheFile);
+            m_saveTimer.start();
+        }
+    }
+}
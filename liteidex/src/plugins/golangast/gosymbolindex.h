@@ -0,0 +1,141 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: gosymbolindex.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef GOSYMBOLINDEX_H
+#define GOSYMBOLINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QElapsedTimer>
+
+struct GoSymbol
+{
+    GoSymbol() : kind(0), line(0), col(0) {}
+    QString name;
+    QString recv;
+    char    kind;   // ast tag: f,m,t,s,i,v,c
+    int     line;
+    int     col;    // utf-16 column, 1-based
+};
+
+struct GoSymbolFile
+{
+    GoSymbolFile() : mtime(0), size(0) {}
+    QString path;
+    QString pkgName;
+    uint    mtime;
+    qint64  size;
+    QVector<GoSymbol> symbols;
+};
+
+struct GoSymbolMatch
+{
+    QString name;
+    QString recv;
+    QString pkgName;
+    QString filePath;
+    char    kind;
+    int     line;
+    int     col;
+};
+
+struct GoSymbolRef
+{
+    int file;
+    int symbol;
+};
+
+// scan the top level declarations of a go source file, no type checking
+void scanGoSymbols(const QByteArray &data, QString &pkgName, QVector<GoSymbol> &symbols);
+
+// GoSymbolIndex keeps the top level declarations of every package under
+// the GOROOT and GOPATH source trees. Names are kept in a case insensitive
+// sorted array, prefix lookup is a binary search. One indexer thread
+// writes, an update only replaces the slots of the changed files and
+// merges their symbols into the sorted array. Updates are built on copies
+// and published together, files and sorted array always match.
+class GoSymbolIndex
+{
+public:
+    GoSymbolIndex();
+    bool load(const QString &fileName);
+    bool save(const QString &fileName);
+    bool isModified() const;
+    int fileCount() const;
+    int symbolCount() const;
+    QHash<QString,QPair<uint,qint64> > stamps() const;
+    void update(const QVector<GoSymbolFile> &files, const QStringList &removed);
+    // text is name or qualifier.name, qualifier is package or receiver
+    QList<GoSymbolMatch> find(const QString &text, int limit) const;
+    QList<GoSymbolMatch> findExact(const QString &name, const QString &qualifier) const;
+protected:
+    void rebuild(const QVector<GoSymbolFile> &files);
+    static QVector<GoSymbolRef> mergeFiles(const QVector<GoSymbolFile> &files,
+                                           const QVector<GoSymbolRef> &sorted,
+                                           const QSet<int> &changed);
+    GoSymbolMatch match(const GoSymbolRef &ref) const;
+protected:
+    mutable QMutex          m_mutex;
+    QVector<GoSymbolFile>   m_files;    // removed files leave an empty slot
+    QHash<QString,int>      m_fileIndex;
+    QVector<GoSymbolRef>    m_sorted;
+    int                     m_symbolCount;
+    int                     m_emptyCount;
+    int                     m_revision;
+    bool                    m_modified;
+};
+
+class GoSymbolIndexThread : public QThread
+{
+public:
+    GoSymbolIndexThread(GoSymbolIndex *index, QObject *parent);
+    ~GoSymbolIndexThread();
+    void setCacheFile(const QString &fileName);
+    void setRoots(const QStringList &roots);
+    void updateFiles(const QStringList &files);
+    bool hasPending() const;
+    void stop();
+protected:
+    virtual void run();
+    void walk(const QString &path, QStringList &files) const;
+    bool underRoots(const QString &fileName, const QStringList &roots) const;
+protected:
+    mutable QMutex  m_mutex;
+    GoSymbolIndex  *m_index;
+    QString         m_cacheFile;
+    QStringList     m_roots;
+    QStringList     m_files;
+    QElapsedTimer   m_saveTimer;
+    bool            m_fullScan;
+    bool            m_loaded;
+    volatile bool   m_stop;
+};
+
+#endif // GOSYMBOLINDEX_H
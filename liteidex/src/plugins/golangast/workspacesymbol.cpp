@@ -0,0 +1,379 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: workspacesymbol.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "workspacesymbol.h"
+#include "gosymbolindex.h"
+#include <QLineEdit>
+#include <QTreeView>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QStandardItemModel>
+#include <QStandardItem>
+#include <QKeyEvent>
+#include <QCoreApplication>
+#include <QMainWindow>
+#include <QPlainTextEdit>
+#include <QTextBlock>
+#include <QAction>
+#include <QMenu>
+#include <QFileInfo>
+#include <QDir>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+enum {
+    FilePathRole = Qt::UserRole+1,
+    LineRole,
+    ColumnRole
+};
+
+static int MaxSymbolResult = 200;
+
+static QString symbolTag(char kind)
+{
+    if (kind == 'm') {
+        return "tm";
+    }
+    return QString(QChar(kind));
+}
+
+static bool isIdentChar(const QChar &ch)
+{
+    return ch.isLetterOrNumber() || ch == '_';
+}
+
+WorkspaceSymbolDialog::WorkspaceSymbolDialog(GoSymbolIndex *index, LiteApi::IGolangAst *ast, QWidget *parent) :
+    QDialog(parent,Qt::Popup),
+    m_index(index),
+    m_ast(ast)
+{
+    m_edit = new QLineEdit;
+    m_view = new QTreeView;
+    m_model = new QStandardItemModel(this);
+    m_view->setModel(m_model);
+    m_view->setRootIsDecorated(false);
+    m_view->setUniformRowHeights(true);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setFocusPolicy(Qt::NoFocus);
+    m_view->header()->hide();
+
+    QVBoxLayout *layout = new QVBoxLayout;
+    layout->setMargin(2);
+    layout->setSpacing(2);
+    layout->addWidget(m_edit);
+    layout->addWidget(m_view);
+    this->setLayout(layout);
+
+    m_edit->installEventFilter(this);
+
+    connect(m_edit,SIGNAL(textChanged(QString)),this,SLOT(filterChanged(QString)));
+    connect(m_view,SIGNAL(activated(QModelIndex)),this,SLOT(activated(QModelIndex)));
+}
+
+void WorkspaceSymbolDialog::popup(const QString &text)
+{
+    QWidget *parent = this->parentWidget();
+    if (parent) {
+        QRect rc = parent->geometry();
+        int width = qMax(400,rc.width()/2);
+        this->resize(width,qMin(400,rc.height()*2/3));
+        this->move(rc.left()+(rc.width()-width)/2,rc.top()+rc.height()/8);
+    }
+    m_edit->setText(text);
+    filterChanged(text);
+    m_edit->selectAll();
+    this->show();
+    this->raise();
+    this->activateWindow();
+    m_edit->setFocus();
+}
+
+void WorkspaceSymbolDialog::filterChanged(const QString &text)
+{
+    m_model->clear();
+    QList<GoSymbolMatch> matches = m_index->find(text,MaxSymbolResult);
+    foreach (const GoSymbolMatch &m, matches) {
+        bool pub = m.name.at(0).isUpper();
+        QString name = m.name;
+        if (!m.recv.isEmpty()) {
+            name = m.recv+"."+m.name;
+        }
+        QStandardItem *item = new QStandardItem(m_ast->iconFromTag(symbolTag(m.kind),pub),name);
+        item->setData(m.filePath,FilePathRole);
+        item->setData(m.line,LineRole);
+        item->setData(m.col,ColumnRole);
+        item->setToolTip(m.filePath);
+        QStandardItem *info = new QStandardItem(QString("%1  %2:%3").
+                                                arg(m.pkgName).
+                                                arg(QFileInfo(m.filePath).fileName()).
+                                                arg(m.line));
+        info->setToolTip(m.filePath);
+        m_model->appendRow(QList<QStandardItem*>() << item << info);
+    }
+    m_view->resizeColumnToContents(0);
+    if (m_model->rowCount() > 0) {
+        m_view->setCurrentIndex(m_model->index(0,0));
+    }
+}
+
+void WorkspaceSymbolDialog::activated(const QModelIndex &index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    QModelIndex first = m_model->index(index.row(),0);
+    QString filePath = first.data(FilePathRole).toString();
+    int line = first.data(LineRole).toInt();
+    int col = first.data(ColumnRole).toInt();
+    this->hide();
+    emit symbolActivated(filePath,line,col);
+}
+
+bool WorkspaceSymbolDialog::eventFilter(QObject *obj, QEvent *event)
+{
+    if (obj == m_edit && event->type() == QEvent::KeyPress) {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        switch (keyEvent->key()) {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QCoreApplication::sendEvent(m_view,event);
+            return true;
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            activated(m_view->currentIndex());
+            return true;
+        }
+    }
+    return QDialog::eventFilter(obj,event);
+}
+
+WorkspaceSymbol::WorkspaceSymbol(LiteApi::IApplication *app, LiteApi::IGolangAst *ast, QObject *parent) :
+    QObject(parent),
+    m_liteApp(app),
+    m_ast(ast),
+    m_dialog(0),
+    m_loaded(false)
+{
+    m_index = new GoSymbolIndex;
+    m_thread = new GoSymbolIndexThread(m_index,this);
+    m_thread->setCacheFile(QFileInfo(m_liteApp->storagePath(),"gosymbols.index").filePath());
+
+    LiteApi::IActionContext *actionContext = m_liteApp->actionManager()->getActionContext(this,"GoSymbol");
+
+    m_symbolAct = new QAction(tr("Go to Symbol in Workspace"),this);
+    actionContext->regAction(m_symbolAct,"GotoWorkspaceSymbol","Ctrl+Shift+T");
+
+    m_jumpAct = new QAction(tr("Jump to Workspace Declaration"),this);
+    actionContext->regAction(m_jumpAct,"JumpToWorkspaceDeclaration","Ctrl+Shift+J");
+
+    //the symbol popup is not bound to an editor
+    m_liteApp->mainWindow()->addAction(m_symbolAct);
+
+    connect(m_symbolAct,SIGNAL(triggered()),this,SLOT(showSymbols()));
+    connect(m_jumpAct,SIGNAL(triggered()),this,SLOT(jumpToDeclaration()));
+    connect(m_thread,SIGNAL(finished()),this,SLOT(indexFinished()));
+    connect(m_liteApp,SIGNAL(loaded()),this,SLOT(appLoaded()));
+    connect(m_liteApp,SIGNAL(broadcast(QString,QString,QString)),this,SLOT(broadcast(QString,QString,QString)));
+    connect(m_liteApp->editorManager(),SIGNAL(editorCreated(LiteApi::IEditor*)),this,SLOT(editorCreated(LiteApi::IEditor*)));
+    connect(m_liteApp->editorManager(),SIGNAL(editorSaved(LiteApi::IEditor*)),this,SLOT(editorSaved(LiteApi::IEditor*)));
+
+    LiteApi::IEnvManager *envManager = LiteApi::findExtensionObject<LiteApi::IEnvManager*>(m_liteApp,"LiteApi.IEnvManager");
+    if (envManager) {
+        connect(envManager,SIGNAL(currentEnvChanged(LiteApi::IEnv*)),this,SLOT(currentEnvChanged(LiteApi::IEnv*)));
+    }
+}
+
+WorkspaceSymbol::~WorkspaceSymbol()
+{
+    delete m_thread;
+    delete m_index;
+}
+
+void WorkspaceSymbol::appLoaded()
+{
+    m_loaded = true;
+    rescan();
+}
+
+void WorkspaceSymbol::currentEnvChanged(LiteApi::IEnv*)
+{
+    rescan();
+}
+
+void WorkspaceSymbol::broadcast(QString module,QString id,QString)
+{
+    if (module == "golangpackage" && id == "reloadgopath") {
+        rescan();
+    }
+}
+
+void WorkspaceSymbol::rescan()
+{
+    if (!m_loaded) {
+        return;
+    }
+    m_thread->setRoots(LiteApi::getGopathList(m_liteApp,true));
+    startIndex();
+}
+
+void WorkspaceSymbol::startIndex()
+{
+    if (!m_thread->isRunning()) {
+        m_thread->start(QThread::LowPriority);
+    }
+}
+
+void WorkspaceSymbol::indexFinished()
+{
+    //requests that came in after the indexer checked its queue
+    if (m_thread->hasPending()) {
+        startIndex();
+    }
+}
+
+void WorkspaceSymbol::editorCreated(LiteApi::IEditor *editor)
+{
+    if (!editor || editor->mimeType() != "text/x-gosrc") {
+        return;
+    }
+    QMenu *menu = LiteApi::getEditMenu(editor);
+    if (menu) {
+        menu->addSeparator();
+        menu->addAction(m_symbolAct);
+        menu->addAction(m_jumpAct);
+    }
+    menu = LiteApi::getContextMenu(editor);
+    if (menu) {
+        menu->addAction(m_jumpAct);
+    }
+}
+
+void WorkspaceSymbol::editorSaved(LiteApi::IEditor *editor)
+{
+    if (!m_loaded || !editor) {
+        return;
+    }
+    QString fileName = editor->filePath();
+    if (fileName.endsWith(".go")) {
+        m_thread->updateFiles(QStringList() << fileName);
+        startIndex();
+    }
+}
+
+void WorkspaceSymbol::showSymbols()
+{
+    QString text;
+    QPlainTextEdit *ed = LiteApi::getPlainTextEdit(m_liteApp->editorManager()->currentEditor());
+    if (ed) {
+        text = ed->textCursor().selectedText();
+    }
+    popupSymbols(text);
+}
+
+void WorkspaceSymbol::popupSymbols(const QString &text)
+{
+    if (!m_dialog) {
+        m_dialog = new WorkspaceSymbolDialog(m_index,m_ast,m_liteApp->mainWindow());
+        connect(m_dialog,SIGNAL(symbolActivated(QString,int,int)),this,SLOT(gotoSymbol(QString,int,int)));
+    }
+    m_dialog->popup(text);
+}
+
+void WorkspaceSymbol::jumpToDeclaration()
+{
+    LiteApi::IEditor *editor = m_liteApp->editorManager()->currentEditor();
+    QPlainTextEdit *ed = LiteApi::getPlainTextEdit(editor);
+    if (!ed) {
+        return;
+    }
+    QTextCursor cursor = ed->textCursor();
+    QString text = cursor.block().text();
+    int pos = cursor.position()-cursor.block().position();
+    int start = pos;
+    int end = pos;
+    while (start > 0 && isIdentChar(text.at(start-1))) {
+        start--;
+    }
+    while (end < text.size() && isIdentChar(text.at(end))) {
+        end++;
+    }
+    QString name = text.mid(start,end-start);
+    if (name.isEmpty()) {
+        return;
+    }
+    QString qualifier;
+    if (start > 1 && text.at(start-1) == '.') {
+        int qstart = start-1;
+        while (qstart > 0 && isIdentChar(text.at(qstart-1))) {
+            qstart--;
+        }
+        qualifier = text.mid(qstart,start-1-qstart);
+    }
+
+    QList<GoSymbolMatch> matches = m_index->findExact(name,qualifier);
+    if (matches.isEmpty() && !qualifier.isEmpty()) {
+        //qualifier is a variable, not a package or type
+        matches = m_index->findExact(name,QString());
+    }
+    if (matches.isEmpty()) {
+        m_liteApp->appendLog("GoSymbol",QString("not find declaration of %1").arg(name));
+        return;
+    }
+    //prefer the package of the current file
+    if (matches.size() > 1 && qualifier.isEmpty()) {
+        QString dir = QFileInfo(editor->filePath()).absolutePath();
+        QList<GoSymbolMatch> local;
+        foreach (const GoSymbolMatch &m, matches) {
+            if (QFileInfo(m.filePath).absolutePath() == dir) {
+                local.append(m);
+            }
+        }
+        if (!local.isEmpty()) {
+            matches = local;
+        }
+    }
+    if (matches.size() == 1) {
+        gotoSymbol(matches.first().filePath,matches.first().line,matches.first().col);
+        return;
+    }
+    popupSymbols(qualifier.isEmpty() ? name : qualifier+"."+name);
+}
+
+void WorkspaceSymbol::gotoSymbol(const QString &filePath, int line, int col)
+{
+    LiteApi::IEditor *editor = m_liteApp->fileManager()->openEditor(filePath,true);
+    LiteApi::ITextEditor *textEditor = LiteApi::getTextEditor(editor);
+    if (!textEditor) {
+        return;
+    }
+    textEditor->gotoLine(line-1,col-1,true);
+}
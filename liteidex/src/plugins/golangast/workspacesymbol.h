@@ -0,0 +1,91 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: workspacesymbol.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef WORKSPACESYMBOL_H
+#define WORKSPACESYMBOL_H
+
+#include "liteapi/liteapi.h"
+#include "liteenvapi/liteenvapi.h"
+#include "golangastapi/golangastapi.h"
+#include <QDialog>
+
+class QLineEdit;
+class QTreeView;
+class QStandardItemModel;
+class QModelIndex;
+class GoSymbolIndex;
+class GoSymbolIndexThread;
+
+class WorkspaceSymbolDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    WorkspaceSymbolDialog(GoSymbolIndex *index, LiteApi::IGolangAst *ast, QWidget *parent = 0);
+    void popup(const QString &text);
+signals:
+    void symbolActivated(const QString &filePath, int line, int col);
+public slots:
+    void filterChanged(const QString &text);
+    void activated(const QModelIndex &index);
+protected:
+    virtual bool eventFilter(QObject *obj, QEvent *event);
+protected:
+    GoSymbolIndex      *m_index;
+    LiteApi::IGolangAst *m_ast;
+    QLineEdit          *m_edit;
+    QTreeView          *m_view;
+    QStandardItemModel *m_model;
+};
+
+class WorkspaceSymbol : public QObject
+{
+    Q_OBJECT
+public:
+    WorkspaceSymbol(LiteApi::IApplication *app, LiteApi::IGolangAst *ast, QObject *parent = 0);
+    ~WorkspaceSymbol();
+public slots:
+    void appLoaded();
+    void currentEnvChanged(LiteApi::IEnv*);
+    void broadcast(QString,QString,QString);
+    void editorCreated(LiteApi::IEditor*);
+    void editorSaved(LiteApi::IEditor*);
+    void indexFinished();
+    void showSymbols();
+    void jumpToDeclaration();
+    void gotoSymbol(const QString &filePath, int line, int col);
+protected:
+    void rescan();
+    void startIndex();
+    void popupSymbols(const QString &text);
+protected:
+    LiteApi::IApplication *m_liteApp;
+    LiteApi::IGolangAst   *m_ast;
+    GoSymbolIndex         *m_index;
+    GoSymbolIndexThread   *m_thread;
+    WorkspaceSymbolDialog *m_dialog;
+    QAction *m_symbolAct;
+    QAction *m_jumpAct;
+    bool     m_loaded;
+};
+
+#endif // WORKSPACESYMBOL_H
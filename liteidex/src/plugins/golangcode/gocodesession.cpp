@@ -0,0 +1,256 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: gocodesession.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "gocodesession.h"
+#include <QTimer>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+GocodeProcessBackend::GocodeProcessBackend(QObject *parent) :
+    GocodeBackend(parent),
+    m_id(0)
+{
+    m_process = new QProcess(this);
+    connect(m_process,SIGNAL(started()),this,SLOT(started()));
+    connect(m_process,SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(finished(int,QProcess::ExitStatus)));
+    connect(m_process,SIGNAL(error(QProcess::ProcessError)),this,SLOT(error(QProcess::ProcessError)));
+}
+
+void GocodeProcessBackend::setCommand(const QString &cmd)
+{
+    m_cmd = cmd;
+}
+
+QString GocodeProcessBackend::command() const
+{
+    return m_cmd;
+}
+
+void GocodeProcessBackend::setProcessEnvironment(const QProcessEnvironment &env)
+{
+    m_process->setProcessEnvironment(env);
+}
+
+bool GocodeProcessBackend::isValid() const
+{
+    return !m_cmd.isEmpty();
+}
+
+void GocodeProcessBackend::start(int id, const GocodeRequest &req)
+{
+    m_id = id;
+    m_input = req.input;
+    if (!req.workDir.isEmpty()) {
+        m_process->setWorkingDirectory(req.workDir);
+    }
+    m_process->start(m_cmd,req.args);
+}
+
+void GocodeProcessBackend::cancel()
+{
+    //the gocode client is short lived, only kill it once it runs
+    if (m_process->state() == QProcess::Running) {
+        m_process->kill();
+    }
+}
+
+void GocodeProcessBackend::started()
+{
+    if (!m_input.isEmpty()) {
+        m_process->write(m_input);
+        m_input.clear();
+    }
+    m_process->closeWriteChannel();
+}
+
+void GocodeProcessBackend::finished(int code, QProcess::ExitStatus status)
+{
+    QByteArray output = m_process->readAllStandardOutput();
+    emit finished(m_id,output,code == 0 && status == QProcess::NormalExit);
+}
+
+void GocodeProcessBackend::error(QProcess::ProcessError error)
+{
+    //finished is not emitted when the process could not start
+    if (error == QProcess::FailedToStart) {
+        m_input.clear();
+        emit finished(m_id,QByteArray(),false);
+    }
+}
+
+GocodeStubBackend::GocodeStubBackend(int delay, QObject *parent) :
+    GocodeBackend(parent),
+    m_id(0),
+    m_delay(delay),
+    m_canceled(false)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer,SIGNAL(timeout()),this,SLOT(timeout()));
+}
+
+bool GocodeStubBackend::isValid() const
+{
+    return true;
+}
+
+void GocodeStubBackend::start(int id, const GocodeRequest &req)
+{
+    m_id = id;
+    m_canceled = false;
+    m_output.clear();
+    if (req.args.contains("autocomplete")) {
+        m_output = "package,,fmt,,\n"
+                "func,,Errorf,,func(format string, a ...interface{}) error\n"
+                "func,,Printf,,func(format string, a ...interface{}) (n int, err error)\n"
+                "func,,Println,,func(a ...interface{}) (n int, err error)\n"
+                "type,,Stringer,,interface\n"
+                "type,,State,,interface\n"
+                "var,,Args,,[]string\n"
+                "const,,MaxInt8,,\n";
+    }
+    m_timer->start(m_delay);
+}
+
+void GocodeStubBackend::cancel()
+{
+    if (m_timer->isActive()) {
+        m_canceled = true;
+        m_timer->start(0);
+    }
+}
+
+void GocodeStubBackend::timeout()
+{
+    emit finished(m_id,m_canceled ? QByteArray() : m_output,!m_canceled);
+}
+
+GocodeSession::GocodeSession(QObject *parent) :
+    QObject(parent),
+    m_backend(0),
+    m_busy(false),
+    m_hasPending(false),
+    m_resetPending(false),
+    m_restartPending(false),
+    m_lastId(0)
+{
+    m_current.id = 0;
+    m_pending.id = 0;
+}
+
+void GocodeSession::setBackend(GocodeBackend *backend)
+{
+    if (m_backend == backend) {
+        return;
+    }
+    if (m_backend) {
+        disconnect(m_backend,0,this,0);
+        m_backend->deleteLater();
+    }
+    m_backend = backend;
+    m_busy = false;
+    if (m_backend) {
+        m_backend->setParent(this);
+        connect(m_backend,SIGNAL(finished(int,QByteArray,bool)),this,SLOT(backendFinished(int,QByteArray,bool)));
+        startNext();
+    }
+}
+
+GocodeBackend *GocodeSession::backend() const
+{
+    return m_backend;
+}
+
+bool GocodeSession::isValid() const
+{
+    return m_backend && m_backend->isValid();
+}
+
+int GocodeSession::request(const GocodeRequest &req)
+{
+    m_pending.id = ++m_lastId;
+    m_pending.req = req;
+    m_hasPending = true;
+    if (!m_busy) {
+        startNext();
+    } else if (m_current.id > 0) {
+        m_backend->cancel();
+    }
+    return m_pending.id;
+}
+
+void GocodeSession::reset()
+{
+    m_resetPending = true;
+    m_restartPending = false;
+    startNext();
+}
+
+void GocodeSession::startNext()
+{
+    if (m_busy || !isValid()) {
+        return;
+    }
+    if (m_resetPending || m_restartPending) {
+        //close the daemon, then run the client once so it starts a new
+        //daemon with the current environment
+        m_current.id = 0;
+        m_current.req = GocodeRequest();
+        if (m_resetPending) {
+            m_resetPending = false;
+            m_restartPending = true;
+            m_current.req.args << "close";
+        } else {
+            m_restartPending = false;
+        }
+    } else if (m_hasPending) {
+        m_hasPending = false;
+        m_current = m_pending;
+    } else {
+        return;
+    }
+    m_busy = true;
+    m_backend->start(m_current.id,m_current.req);
+}
+
+void GocodeSession::backendFinished(int id, const QByteArray &output, bool ok)
+{
+    if (!m_busy || id != m_current.id) {
+        return;
+    }
+    m_busy = false;
+    if (id > 0) {
+        if (ok && id == m_lastId) {
+            QString tag = m_current.req.tag;
+            emit completed(id,tag,output);
+        }
+    }
+    startNext();
+}
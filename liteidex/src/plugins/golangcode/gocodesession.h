@@ -0,0 +1,133 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: gocodesession.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef GOCODESESSION_H
+#define GOCODESESSION_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+class QTimer;
+
+struct GocodeRequest
+{
+    QStringList args;
+    QByteArray  input;
+    QString     workDir;
+    // returned with the reply, the completion root of the request
+    QString     tag;
+};
+
+// GocodeBackend runs one request at a time and always answers a started
+// request with finished, also when it was cancelled.
+class GocodeBackend : public QObject
+{
+    Q_OBJECT
+public:
+    GocodeBackend(QObject *parent) : QObject(parent) {}
+    virtual bool isValid() const = 0;
+    virtual void start(int id, const GocodeRequest &req) = 0;
+    virtual void cancel() = 0;
+signals:
+    void finished(int id, const QByteArray &output, bool ok);
+};
+
+class GocodeProcessBackend : public GocodeBackend
+{
+    Q_OBJECT
+public:
+    GocodeProcessBackend(QObject *parent);
+    void setCommand(const QString &cmd);
+    QString command() const;
+    void setProcessEnvironment(const QProcessEnvironment &env);
+    virtual bool isValid() const;
+    virtual void start(int id, const GocodeRequest &req);
+    virtual void cancel();
+protected slots:
+    void started();
+    void finished(int code, QProcess::ExitStatus status);
+    void error(QProcess::ProcessError error);
+protected:
+    QProcess   *m_process;
+    QString     m_cmd;
+    QByteArray  m_input;
+    int         m_id;
+};
+
+// GocodeStubBackend answers autocomplete with a fixed candidate list
+// after a delay, it is used when LITEIDE_GOCODE_STUB is set.
+class GocodeStubBackend : public GocodeBackend
+{
+    Q_OBJECT
+public:
+    GocodeStubBackend(int delay, QObject *parent);
+    virtual bool isValid() const;
+    virtual void start(int id, const GocodeRequest &req);
+    virtual void cancel();
+protected slots:
+    void timeout();
+protected:
+    QTimer     *m_timer;
+    QByteArray  m_output;
+    int         m_id;
+    int         m_delay;
+    bool        m_canceled;
+};
+
+// GocodeSession keeps at most one request running and one waiting. a new
+// request replaces the waiting one and cancels the running one, replies
+// that are not for the latest request id are dropped. reset closes the
+// gocode daemon and starts it again before the next request.
+class GocodeSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GocodeSession(QObject *parent = 0);
+    void setBackend(GocodeBackend *backend);
+    GocodeBackend *backend() const;
+    bool isValid() const;
+    int request(const GocodeRequest &req);
+    void reset();
+signals:
+    void completed(int id, const QString &tag, const QByteArray &output);
+protected slots:
+    void backendFinished(int id, const QByteArray &output, bool ok);
+protected:
+    struct Entry {
+        int           id;
+        GocodeRequest req;
+    };
+    void startNext();
+protected:
+    GocodeBackend *m_backend;
+    Entry   m_current;
+    Entry   m_pending;
+    bool    m_busy;
+    bool    m_hasPending;
+    bool    m_resetPending;
+    bool    m_restartPending;
+    int     m_lastId;
+};
+
+#endif // GOCODESESSION_H
@@ -22,8 +22,9 @@
 // Creator: visualfc <visualfc@gmail.com>
 
 #include "golangcode.h"
+#include "gocodesession.h"
 #include "fileutil/fileutil.h"
-#include <QProcess>
+#include "textsnapshot/textsnapshot.h"
 #include <QTextDocument>
 #include <QAbstractItemView>
 #include <QApplication>
@@ -41,12 +42,23 @@
 GolangCode::GolangCode(LiteApi::IApplication *app, QObject *parent) :
     QObject(parent),
     m_liteApp(app),
-    m_completer(0)
+    m_completer(0),
+    m_gocode(0)
 {
-    m_process = new QProcess(this);
-    m_breset = false;
-    connect(m_process,SIGNAL(started()),this,SLOT(started()));
-    connect(m_process,SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(finished(int,QProcess::ExitStatus)));
+    m_session = new GocodeSession(this);
+    connect(m_session,SIGNAL(completed(int,QString,QByteArray)),this,SLOT(completed(int,QString,QByteArray)));
+    //LITEIDE_GOCODE_STUB=delay answers from a fixed list without gocode
+    QByteArray stub = qgetenv("LITEIDE_GOCODE_STUB");
+    if (!stub.isEmpty()) {
+        bool ok = false;
+        int delay = stub.toInt(&ok);
+        m_session->setBackend(new GocodeStubBackend(ok ? delay : 20,m_session));
+        m_gocodeCmd = "gocode-stub";
+        m_liteApp->appendLog("GolangCode","Using the gocode stub backend");
+    } else {
+        m_gocode = new GocodeProcessBackend(m_session);
+        m_session->setBackend(m_gocode);
+    }
 
     m_envManager = LiteApi::findExtensionObject<LiteApi::IEnvManager*>(m_liteApp,"LiteApi.IEnvManager");
     if (m_envManager) {
@@ -76,18 +88,25 @@ GolangCode::~GolangCode()
 
 void GolangCode::resetGocode()
 {
-    if (!m_gocodeCmd.isEmpty()) {
-        m_breset = true;
-        m_process->start(m_gocodeCmd,QStringList() << "close");
-        m_process->setEnvironment(LiteApi::getGoEnvironment(m_liteApp).toStringList());
+    if (!m_session->isValid()) {
+        return;
     }
+    //the restarted daemon inherits the environment of the client
+    if (m_gocode) {
+        m_gocode->setProcessEnvironment(LiteApi::getGoEnvironment(m_liteApp));
+    }
+    m_session->reset();
 }
 
 void GolangCode::currentEnvChanged(LiteApi::IEnv* e)
 {    
+    if (!m_gocode) {
+        return;
+    }
     QProcessEnvironment env = LiteApi::getGoEnvironment(m_liteApp);
     m_gocodeCmd = FileUtil::lookupGoBin("gocode",m_liteApp);
-    m_process->setProcessEnvironment(env);
+    m_gocode->setCommand(m_gocodeCmd);
+    m_gocode->setProcessEnvironment(env);
 
     if (m_gocodeCmd.isEmpty()) {
          m_liteApp->appendLog("GolangCode","Could not find gocode (hint: is gocode installed?)",true);
@@ -108,7 +127,7 @@ void GolangCode::currentEditorChanged(LiteApi::IEditor *editor)
         return;
     }
     m_fileName = QFileInfo(filePath).fileName();
-    m_process->setWorkingDirectory(QFileInfo(filePath).path());
+    m_workDir = QFileInfo(filePath).path();
 }
 
 void GolangCode::setCompleter(LiteApi::ICompleter *completer)
@@ -130,33 +149,28 @@ void GolangCode::prefixChanged(QTextCursor cur,QString pre)
         return;
     }
 
-    if (m_process->state() == QProcess::Running) {
-        return;
-    }
-
+    QString preWord;
     if (pre.endsWith('.')) {
-        m_preWord = pre;
-    } else if (pre.length() == 1) {
-        m_preWord.clear();
-    } else {
+        preWord = pre;
+    } else if (pre.length() != 1) {
         return;
     }
 
     m_prefix = pre;
-    m_lastPrefix = m_prefix;
 
-    if (!m_preWord.isEmpty()) {
+    if (!preWord.isEmpty()) {
         m_completer->clearItemChilds(m_prefix);
     }
 
-    QString src = cur.document()->toPlainText();
-    src = src.replace("\r\n","\n");
-    m_writeData = src.left(cur.position()).toUtf8();
-    QStringList args;
-    args << "-in" << "" << "-f" << "csv" << "autocomplete" << m_fileName << QString::number(m_writeData.length());
-    m_writeData = src.toUtf8();
-    m_breset = false;
-    m_process->start(m_gocodeCmd,args);
+    //the snapshot is kept up to date per edited block
+    LiteApi::IUtf8Snapshot *snapshot = Utf8Snapshot::attach(cur.document());
+    GocodeRequest req;
+    req.args << "-in" << "" << "-f" << "csv" << "autocomplete" << m_fileName << QString::number(snapshot->byteOffset(cur.position()));
+    req.input = snapshot->data();
+    req.workDir = m_workDir;
+    req.tag = preWord;
+    //a newer request supersedes this one if gocode is still busy
+    m_session->request(req);
 }
 
 void GolangCode::wordCompleted(QString,QString)
@@ -164,39 +178,12 @@ void GolangCode::wordCompleted(QString,QString)
     m_prefix.clear();
 }
 
-void GolangCode::started()
-{
-    if (m_writeData.isEmpty()) {
-        m_process->closeWriteChannel();
-        return;
-    }
-    m_process->write(m_writeData);
-    m_process->closeWriteChannel();
-    m_writeData.clear();
-}
-
-void GolangCode::finished(int code,QProcess::ExitStatus)
+void GolangCode::completed(int /*id*/, const QString &preWord, const QByteArray &read)
 {
-    if (code != 0) {
-        return;
-    }
-
-    if (m_breset) {
-        m_breset = false;
-        m_process->start(m_gocodeCmd);
-        return;
-    }
-
     if (m_prefix.isEmpty()) {
         return;
     }
 
-    if (m_prefix != m_lastPrefix) {
-        m_prefix.clear();
-        return;
-    }
-
-    QByteArray read = m_process->readAllStandardOutput();
     QList<QByteArray> all = read.split('\n');
     //func,,Fprint,,func(w io.Writer, a ...interface{}) (n int, error os.Error)
     //type,,Formatter,,interface
@@ -204,7 +191,7 @@ void GolangCode::finished(int code,QProcess::ExitStatus)
     //var,,Args,,[]string
     int n = 0;
     QIcon icon;
-    QStandardItem *root= m_completer->findRoot(m_preWord);
+    QModelIndex root = m_completer->findRoot(preWord);
     foreach (QByteArray bs, all) {
         QStringList word = QString::fromUtf8(bs,bs.size()).split(",,");
         if (word.count() != 3) {
@@ -237,7 +224,7 @@ void GolangCode::finished(int code,QProcess::ExitStatus)
         if (m_golangAst) {
             icon = m_golangAst->iconFromTagEnum(tag,true);
         }
-        //m_completer->appendItemEx(m_preWord+word.at(1),kind,info,icon,true);
+        //m_completer->appendItemEx(preWord+word.at(1),kind,info,icon,true);
         m_completer->appendChildItem(root,word.at(1),kind,info,icon,true);
         n++;
     }
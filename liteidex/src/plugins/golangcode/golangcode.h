@@ -29,7 +29,8 @@
 #include "liteenvapi/liteenvapi.h"
 #include "golangastapi/golangastapi.h"
 
-class QProcess;
+class GocodeSession;
+class GocodeProcessBackend;
 
 class GolangCode : public QObject
 {
@@ -44,19 +45,16 @@ public slots:
     void currentEnvChanged(LiteApi::IEnv*);
     void prefixChanged(QTextCursor,QString);
     void wordCompleted(QString,QString);
-    void started();
-    void finished(int,QProcess::ExitStatus);
+    void completed(int,const QString&,const QByteArray&);
     void broadcast(QString,QString,QString);
 protected:
     LiteApi::IApplication *m_liteApp;
     LiteApi::ICompleter   *m_completer;
-    QString     m_preWord;
     QString     m_prefix;
-    QString     m_lastPrefix;
     QString     m_fileName;
-    bool        m_breset;
-    QProcess   *m_process;
-    QByteArray  m_writeData;
+    QString     m_workDir;
+    GocodeSession *m_session;
+    GocodeProcessBackend *m_gocode;
     LiteApi::IEnvManager *m_envManager;
     LiteApi::IGolangAst *m_golangAst;
     QString     m_gocodeCmd;
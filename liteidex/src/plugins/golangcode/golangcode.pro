@@ -6,13 +6,16 @@ include (../../api/liteenvapi/liteenvapi.pri)
 include(../../api/golangastapi/golangastapi.pri)
 include(../../utils/fileutil/fileutil.pri)
 include(../../utils/processex/processex.pri)
+include(../../utils/textsnapshot/textsnapshot.pri)
 include (../../3rdparty/qtc_editutil/qtc_editutil.pri)
 
 DEFINES += GOLANGCODE_LIBRARY
 
 SOURCES += golangcodeplugin.cpp \
-    golangcode.cpp
+    golangcode.cpp \
+    gocodesession.cpp
 
 HEADERS += golangcodeplugin.h\
         golangcode_global.h \
-    golangcode.h
+    golangcode.h \
+    gocodesession.h
@@ -0,0 +1,98 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapimodel.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "golangapimodel.h"
+#include "golangapi/golangapiindex.h"
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+GolangApiModel::GolangApiModel(QObject *parent) :
+    QAbstractListModel(parent), m_index(0)
+{
+}
+
+void GolangApiModel::setIndex(const GolangApiIndex *index)
+{
+    beginResetModel();
+    m_index = index;
+    updateRows();
+    endResetModel();
+}
+
+void GolangApiModel::setFilter(const QString &filter)
+{
+    beginResetModel();
+    m_filter = filter.trimmed();
+    updateRows();
+    endResetModel();
+}
+
+QString GolangApiModel::filter() const
+{
+    return m_filter;
+}
+
+void GolangApiModel::updateRows()
+{
+    m_rows.clear();
+    if (m_index && !m_filter.isEmpty()) {
+        m_rows = m_index->match(m_filter);
+    }
+}
+
+int GolangApiModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !m_index) {
+        return 0;
+    }
+    //no filter, every entry in index order
+    if (m_filter.isEmpty()) {
+        return m_index->size();
+    }
+    return m_rows.size();
+}
+
+QVariant GolangApiModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || !m_index || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    int row = index.row();
+    if (!m_filter.isEmpty()) {
+        if (row >= m_rows.size()) {
+            return QVariant();
+        }
+        row = m_rows.at(row);
+    }
+    if (row >= m_index->size()) {
+        return QVariant();
+    }
+    return m_index->at(row).fullName();
+}
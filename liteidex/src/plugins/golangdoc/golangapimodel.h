@@ -0,0 +1,52 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapimodel.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef GOLANGAPIMODEL_H
+#define GOLANGAPIMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+
+class GolangApiIndex;
+
+// GolangApiModel shows the api index without copying it, names are built
+// only for the rows the view asks for.
+class GolangApiModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit GolangApiModel(QObject *parent = 0);
+    void setIndex(const GolangApiIndex *index);
+    void setFilter(const QString &filter);
+    QString filter() const;
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+protected:
+    void updateRows();
+protected:
+    const GolangApiIndex *m_index;
+    QString      m_filter;
+    QVector<int> m_rows;
+};
+
+#endif // GOLANGAPIMODEL_H
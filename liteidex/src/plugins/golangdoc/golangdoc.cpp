@@ -27,6 +27,7 @@
 #include "fileutil/fileutil.h"
 #include "htmlutil/htmlutil.h"
 #include "golangapi/golangapi.h"
+#include "golangapimodel.h"
 #include "documentbrowser/documentbrowser.h"
 #include "qjson/include/QJson/Parser"
 
@@ -97,10 +98,12 @@ GolangDoc::GolangDoc(LiteApi::IApplication *app, QObject *parent) :
     m_findFilterModel = new QSortFilterProxyModel(this);
     m_findFilterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
     m_findFilterModel->setSourceModel(m_findResultModel);
+    m_apiModel = new GolangApiModel(this);
 
     m_findResultListView = new ListViewEx;
     m_findResultListView->setEditTriggers(0);
-    m_findResultListView->setModel(m_findFilterModel);
+    m_findResultListView->setUniformItemSizes(true);
+    m_findResultListView->setModel(m_apiModel);
 
     m_findEdit = new Utils::FilterLineEdit(200);
     m_tagInfo = new QLabel;
@@ -108,6 +111,7 @@ GolangDoc::GolangDoc(LiteApi::IApplication *app, QObject *parent) :
     //m_tagInfo->setScaledContents(true);
 
     m_golangApiThread = new GolangApiThread(this);
+    m_golangApiThread->setCacheFile(QFileInfo(m_liteApp->storagePath(),"golangapi.cache").filePath());
 
     QVBoxLayout *mainLayout = new QVBoxLayout;
     mainLayout->setMargin(1);
@@ -425,6 +429,7 @@ void GolangDoc::findOutput(QByteArray data,bool bStderr)
 
 void GolangDoc::findFinish(bool error,int code,QString /*msg*/)
 {
+    m_findResultListView->setModel(m_findFilterModel);
     if (!error && code == 0) {
         QStringList array = QString(m_findData.trimmed()).split(',');
         if (array.size() >= 2 && array.at(0) == "$find") {
@@ -869,11 +874,7 @@ void GolangDoc::doubleClickListView(QModelIndex index)
     if (!index.isValid()) {
         return;
     }
-    QModelIndex src =  m_findFilterModel->mapToSource(index);
-    if (!src.isValid()) {
-        return;
-    }
-    QString tag = m_findResultModel->data(src,Qt::DisplayRole).toString();
+    QString tag = index.data(Qt::DisplayRole).toString();
     if (!tag.isEmpty()){
         QStringList urlList = m_golangApiThread->api()->findDocUrl(tag);
         if (!urlList.isEmpty()) {
@@ -897,11 +898,7 @@ void GolangDoc::currentIndexChanged(QModelIndex index)
     if (!index.isValid()) {
         return;
     }
-    QModelIndex src =  m_findFilterModel->mapToSource(index);
-    if (!src.isValid()) {
-        return;
-    }
-    QString tag = m_findResultModel->data(src,Qt::DisplayRole).toString();
+    QString tag = index.data(Qt::DisplayRole).toString();
     if (!tag.isEmpty()){
         m_tagInfo->setText(m_golangApiThread->api()->findDocInfo(tag));
     }
@@ -924,10 +921,15 @@ void GolangDoc::documentLoaded()
 
 void GolangDoc::filterTextChanged(QString str)
 {
-    m_findFilterModel->setFilterFixedString(str);
+    QAbstractItemModel *model = m_findResultListView->model();
+    if (model == m_apiModel) {
+        m_apiModel->setFilter(str);
+    } else {
+        m_findFilterModel->setFilterFixedString(str);
+    }
     m_findResultListView->verticalScrollBar()->setValue(0);
-    if (m_findFilterModel->rowCount() > 0) {
-        m_findResultListView->setCurrentIndex(m_findFilterModel->index(0,0));
+    if (model->rowCount() > 0) {
+        m_findResultListView->setCurrentIndex(model->index(0,0));
     }
 }
 
@@ -943,13 +945,17 @@ void GolangDoc::goapiFinish(bool error,int code,QString)
 {
     if (!error && code == 0) {
         m_liteApp->globalCookie().insert("goalngdoc.goapi.data",m_goapiData);
+        m_apiModel->setIndex(0);
         m_golangApiThread->loadData(m_goapiData);
     }
 }
 
 void GolangDoc::loadApiFinished()
 {
-    m_findResultModel->setStringList(m_golangApiThread->all());
+    m_apiModel->setIndex(m_golangApiThread->index());
+    m_apiModel->setFilter(m_findEdit->text());
+    m_findResultListView->setModel(m_apiModel);
+    m_liteApp->appendLog("GolangApi",m_golangApiThread->api()->memoryReport());
 }
 
 void GolangDoc::lookupStarted()
@@ -1031,6 +1037,7 @@ void GolangDoc::helpFinish(bool error, int code, QString)
 void GolangDoc::appLoaded()
 {
     m_goapiData = m_liteApp->globalCookie().value("goalngdoc.goapi.data").toByteArray();
+    m_apiModel->setIndex(0);
     if (!m_goapiData.isEmpty()) {
         m_golangApiThread->loadData(m_goapiData);
         return;
@@ -1039,6 +1046,16 @@ void GolangDoc::appLoaded()
     QFileInfo info(m_liteApp->storagePath(),"golangapi.txt");
     if (info.exists()) {
         m_golangApiThread->loadFile(info.filePath());
+    } else {
+        //no goapi output yet, use the api files of the go release
+        QDir dir(m_goroot+"/api");
+        QStringList files;
+        foreach (QFileInfo api, dir.entryInfoList(QStringList() << "go1*.txt" << "next.txt",QDir::Files,QDir::Name)) {
+            files.append(api.filePath());
+        }
+        if (!files.isEmpty()) {
+            m_golangApiThread->loadFiles(files);
+        }
     }
     if (!m_toolWindowAct->isChecked()) {
         return;
@@ -46,6 +46,7 @@ class DocumentBrowser;
 class QSortFilterProxyModel;
 class GolangApi;
 class GolangApiThread;
+class GolangApiModel;
 
 class ListViewEx : public QListView
 {
@@ -116,6 +117,7 @@ protected:
     QComboBox *m_godocFindComboBox;
     QStringListModel *m_findResultModel;
     QSortFilterProxyModel *m_findFilterModel;
+    GolangApiModel *m_apiModel;
     ListViewEx *m_findResultListView;
     Utils::FilterLineEdit *m_findEdit;
     QLabel     *m_tagInfo;
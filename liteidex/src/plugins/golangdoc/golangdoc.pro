@@ -19,13 +19,15 @@ DEFINES += GOLANGDOC_LIBRARY
 SOURCES += golangdocplugin.cpp \
     golangdoc.cpp \
     golangdocoptionfactory.cpp \
-    golangdocoption.cpp
+    golangdocoption.cpp \
+    golangapimodel.cpp
 
 HEADERS += golangdocplugin.h\
         golangdoc_global.h \
     golangdoc.h \
     golangdocoptionfactory.h \
-    golangdocoption.h
+    golangdocoption.h \
+    golangapimodel.h
 
 FORMS += \
     golangdocoption.ui
@@ -0,0 +1,662 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: completermodel.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "completermodel.h"
+#include <QtAlgorithms>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+// hash table slots: 0 empty, -1 deleted, otherwise a node id
+static const int TableMinSize = 64;
+
+struct NodeLessThan
+{
+    NodeLessThan(const CompleterModel *model) : m_model(model) {}
+    bool operator()(int a, int b) const {
+        return m_model->compareNode(a,b) < 0;
+    }
+    const CompleterModel *m_model;
+};
+
+CompleterModel::CompleterModel(QObject *parent) :
+    QAbstractItemModel(parent),
+    m_cs(Qt::CaseSensitive),
+    m_batch(0),
+    m_generation(0)
+{
+    init();
+}
+
+void CompleterModel::init()
+{
+    m_nodes.clear();
+    m_free.clear();
+    m_table = QVector<int>(TableMinSize,0);
+    m_tableUsed = 0;
+    m_tableDeleted = 0;
+    m_text.clear();
+    m_garbage = 0;
+    m_icons.clear();
+    m_iconMap.clear();
+    m_dirty.clear();
+    m_generation++;
+    Node root;
+    root.parent = -1;
+    root.hash = 0;
+    root.mask = 0;
+    root.name = root.nameSize = 0;
+    root.kind = root.kindSize = 0;
+    root.info = root.infoSize = 0;
+    root.icon = -1;
+    root.temp = false;
+    root.used = true;
+    m_nodes.append(root);
+}
+
+void CompleterModel::setSortCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (m_cs == cs) {
+        return;
+    }
+    emit layoutAboutToBeChanged();
+    QModelIndexList oldList = persistentIndexList();
+    m_cs = cs;
+    m_generation++;
+    for (int i = 0; i < m_nodes.size(); i++) {
+        if (m_nodes.at(i).used) {
+            sortChildren(i);
+        }
+    }
+    QModelIndexList newList;
+    foreach (QModelIndex index, oldList) {
+        newList.append(indexFromNode(nodeFromIndex(index)));
+    }
+    changePersistentIndexList(oldList,newList);
+    emit layoutChanged();
+}
+
+Qt::CaseSensitivity CompleterModel::sortCaseSensitivity() const
+{
+    return m_cs;
+}
+
+QString CompleterModel::text(int offset, int size) const
+{
+    return m_text.mid(offset,size);
+}
+
+int CompleterModel::appendText(const QString &text)
+{
+    int offset = m_text.size();
+    m_text.append(text);
+    return offset;
+}
+
+int CompleterModel::compareNode(int a, int b) const
+{
+    const Node &na = m_nodes.at(a);
+    const Node &nb = m_nodes.at(b);
+    QStringRef sa(&m_text,na.name,na.nameSize);
+    QStringRef sb(&m_text,nb.name,nb.nameSize);
+    int r = QStringRef::compare(sa,sb,m_cs);
+    if (r == 0 && m_cs == Qt::CaseInsensitive) {
+        r = QStringRef::compare(sa,sb,Qt::CaseSensitive);
+    }
+    return r;
+}
+
+int CompleterModel::compareName(const QString &name, int node) const
+{
+    const Node &n = m_nodes.at(node);
+    QStringRef ref(&m_text,n.name,n.nameSize);
+    int r = QStringRef::compare(ref,name,m_cs);
+    if (r == 0 && m_cs == Qt::CaseInsensitive) {
+        r = QStringRef::compare(ref,name,Qt::CaseSensitive);
+    }
+    return -r;
+}
+
+int CompleterModel::lowerBound(int parent, const QString &name) const
+{
+    const QVector<int> &children = m_nodes.at(parent).children;
+    int lo = 0;
+    int hi = children.size();
+    while (lo < hi) {
+        int mid = (lo+hi)/2;
+        if (compareName(name,children.at(mid)) > 0) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int CompleterModel::rowOf(int node) const
+{
+    int parent = m_nodes.at(node).parent;
+    const QVector<int> &children = m_nodes.at(parent).children;
+    if (m_batch == 0) {
+        int lo = 0;
+        int hi = children.size();
+        while (lo < hi) {
+            int mid = (lo+hi)/2;
+            if (compareNode(children.at(mid),node) < 0) {
+                lo = mid+1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < children.size() && children.at(lo) == node) {
+            return lo;
+        }
+    }
+    return children.indexOf(node);
+}
+
+uint CompleterModel::hashOf(int parent, const QString &name) const
+{
+    uint h = uint(parent)*0x9e3779b9U;
+    const ushort *p = name.utf16();
+    for (int i = 0; i < name.size(); i++) {
+        h = h*31+p[i];
+    }
+    return h;
+}
+
+int CompleterModel::findSlot(int parent, const QString &name, uint hash) const
+{
+    int mask = m_table.size()-1;
+    int i = hash & mask;
+    while (true) {
+        int id = m_table.at(i);
+        if (id == 0) {
+            return -1;
+        }
+        if (id > 0) {
+            const Node &n = m_nodes.at(id);
+            if (n.hash == hash && n.parent == parent && n.nameSize == name.size() &&
+                    QStringRef(&m_text,n.name,n.nameSize) == name) {
+                return i;
+            }
+        }
+        i = (i+1) & mask;
+    }
+}
+
+void CompleterModel::insertSlot(int node)
+{
+    if ((m_tableUsed+m_tableDeleted+1)*2 > m_table.size()) {
+        rehash(m_tableUsed*4 >= m_table.size() ? m_table.size()*2 : m_table.size());
+    }
+    int mask = m_table.size()-1;
+    int i = m_nodes.at(node).hash & mask;
+    while (m_table.at(i) > 0) {
+        i = (i+1) & mask;
+    }
+    if (m_table.at(i) < 0) {
+        m_tableDeleted--;
+    }
+    m_table[i] = node;
+    m_tableUsed++;
+}
+
+void CompleterModel::removeSlot(int node)
+{
+    int mask = m_table.size()-1;
+    int i = m_nodes.at(node).hash & mask;
+    while (m_table.at(i) != 0) {
+        if (m_table.at(i) == node) {
+            m_table[i] = -1;
+            m_tableUsed--;
+            m_tableDeleted++;
+            return;
+        }
+        i = (i+1) & mask;
+    }
+}
+
+void CompleterModel::rehash(int size)
+{
+    m_table = QVector<int>(size,0);
+    m_tableUsed = 0;
+    m_tableDeleted = 0;
+    int mask = size-1;
+    for (int id = 1; id < m_nodes.size(); id++) {
+        if (!m_nodes.at(id).used) {
+            continue;
+        }
+        int i = m_nodes.at(id).hash & mask;
+        while (m_table.at(i) != 0) {
+            i = (i+1) & mask;
+        }
+        m_table[i] = id;
+        m_tableUsed++;
+    }
+}
+
+int CompleterModel::findChild(int parent, const QString &name) const
+{
+    int slot = findSlot(parent,name,hashOf(parent,name));
+    return slot >= 0 ? m_table.at(slot) : -1;
+}
+
+int CompleterModel::addChild(int parent, const QString &name, bool *isNew)
+{
+    uint hash = hashOf(parent,name);
+    int slot = findSlot(parent,name,hash);
+    if (slot >= 0) {
+        if (isNew) {
+            *isNew = false;
+        }
+        return m_table.at(slot);
+    }
+    int pos = 0;
+    if (m_batch == 0) {
+        pos = lowerBound(parent,name);
+        beginInsertRows(indexFromNode(parent),pos,pos);
+    }
+    int id = 0;
+    if (!m_free.isEmpty()) {
+        id = m_free.last();
+        m_free.pop_back();
+    } else {
+        id = m_nodes.size();
+        m_nodes.append(Node());
+    }
+    Node &n = m_nodes[id];
+    n.parent = parent;
+    n.hash = hash;
+    n.mask = textMask(name.constData(),name.size());
+    n.name = appendText(name);
+    n.nameSize = name.size();
+    n.kind = n.kindSize = 0;
+    n.info = n.infoSize = 0;
+    n.icon = -1;
+    n.temp = false;
+    n.used = true;
+    n.children.clear();
+    insertSlot(id);
+    m_generation++;
+    if (m_batch == 0) {
+        m_nodes[parent].children.insert(pos,id);
+        endInsertRows();
+    } else {
+        m_nodes[parent].children.append(id);
+        m_dirty.insert(parent);
+    }
+    if (isNew) {
+        *isNew = true;
+    }
+    return id;
+}
+
+void CompleterModel::setItem(int node, const QString &kind, const QString &info, const QIcon &icon, bool temp)
+{
+    if (node <= 0) {
+        return;
+    }
+    int iconId = -1;
+    if (!icon.isNull()) {
+        QHash<qint64,int>::const_iterator it = m_iconMap.constFind(icon.cacheKey());
+        if (it != m_iconMap.constEnd()) {
+            iconId = it.value();
+        } else {
+            iconId = m_icons.size();
+            m_icons.append(icon);
+            m_iconMap.insert(icon.cacheKey(),iconId);
+        }
+    }
+    Node &n = m_nodes[node];
+    m_garbage += n.kindSize+n.infoSize;
+    n.kind = appendText(kind);
+    n.kindSize = kind.size();
+    n.info = appendText(info);
+    n.infoSize = info.size();
+    n.icon = iconId;
+    n.temp = temp;
+    if (m_batch == 0) {
+        QModelIndex index = indexFromNode(node);
+        emit dataChanged(index,index);
+    }
+}
+
+QString CompleterModel::name(int node) const
+{
+    const Node &n = m_nodes.at(node);
+    return text(n.name,n.nameSize);
+}
+
+QString CompleterModel::kind(int node) const
+{
+    const Node &n = m_nodes.at(node);
+    return text(n.kind,n.kindSize);
+}
+
+QString CompleterModel::info(int node) const
+{
+    const Node &n = m_nodes.at(node);
+    return text(n.info,n.infoSize);
+}
+
+bool CompleterModel::isTemp(int node) const
+{
+    return m_nodes.at(node).temp;
+}
+
+void CompleterModel::freeNode(int node)
+{
+    removeSlot(node);
+    m_generation++;
+    Node &n = m_nodes[node];
+    QVector<int> children = n.children;
+    m_garbage += n.nameSize+n.kindSize+n.infoSize;
+    n.children.clear();
+    n.used = false;
+    m_free.append(node);
+    foreach (int child, children) {
+        freeNode(child);
+    }
+}
+
+void CompleterModel::removeChildren(int parent)
+{
+    QVector<int> children = m_nodes.at(parent).children;
+    if (children.isEmpty()) {
+        return;
+    }
+    if (m_batch == 0) {
+        beginRemoveRows(indexFromNode(parent),0,children.size()-1);
+    }
+    m_nodes[parent].children.clear();
+    foreach (int child, children) {
+        freeNode(child);
+    }
+    if (m_batch == 0) {
+        endRemoveRows();
+    }
+    compactText();
+}
+
+void CompleterModel::removeTemp(int parent)
+{
+    int i = m_nodes.at(parent).children.size();
+    while (i > 0) {
+        i--;
+        int id = m_nodes.at(parent).children.at(i);
+        if (!m_nodes.at(id).temp) {
+            removeTemp(id);
+            continue;
+        }
+        //remove runs of temp siblings at once
+        int last = i;
+        while (i > 0 && m_nodes.at(m_nodes.at(parent).children.at(i-1)).temp) {
+            i--;
+        }
+        if (m_batch == 0) {
+            beginRemoveRows(indexFromNode(parent),i,last);
+        }
+        QVector<int> removed = m_nodes.at(parent).children.mid(i,last-i+1);
+        m_nodes[parent].children.remove(i,last-i+1);
+        foreach (int child, removed) {
+            freeNode(child);
+        }
+        if (m_batch == 0) {
+            endRemoveRows();
+        }
+    }
+}
+
+void CompleterModel::removeTemp()
+{
+    removeTemp(0);
+    compactText();
+}
+
+void CompleterModel::clear()
+{
+    beginResetModel();
+    init();
+    endResetModel();
+}
+
+void CompleterModel::compactText()
+{
+    if (m_garbage < 4096 || m_garbage*2 < m_text.size()) {
+        return;
+    }
+    QString text;
+    text.reserve(m_text.size()-m_garbage);
+    for (int i = 1; i < m_nodes.size(); i++) {
+        Node &n = m_nodes[i];
+        if (!n.used) {
+            continue;
+        }
+        int name = text.size();
+        text.append(m_text.constData()+n.name,n.nameSize);
+        int kind = text.size();
+        text.append(m_text.constData()+n.kind,n.kindSize);
+        int info = text.size();
+        text.append(m_text.constData()+n.info,n.infoSize);
+        n.name = name;
+        n.kind = kind;
+        n.info = info;
+    }
+    m_text = text;
+    m_garbage = 0;
+}
+
+void CompleterModel::sortChildren(int node)
+{
+    QVector<int> &children = m_nodes[node].children;
+    qSort(children.begin(),children.end(),NodeLessThan(this));
+}
+
+void CompleterModel::beginBatch()
+{
+    if (m_batch++ == 0) {
+        beginResetModel();
+    }
+}
+
+void CompleterModel::endBatch()
+{
+    if (--m_batch > 0) {
+        return;
+    }
+    foreach (int node, m_dirty) {
+        if (m_nodes.at(node).used) {
+            sortChildren(node);
+        }
+    }
+    m_dirty.clear();
+    endResetModel();
+}
+
+int CompleterModel::nodeFromIndex(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return 0;
+    }
+    return int(index.internalId());
+}
+
+QModelIndex CompleterModel::indexFromNode(int node) const
+{
+    if (node <= 0) {
+        return QModelIndex();
+    }
+    return createIndex(rowOf(node),0,quint32(node));
+}
+
+QModelIndex CompleterModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column != 0) {
+        return QModelIndex();
+    }
+    const QVector<int> &children = m_nodes.at(nodeFromIndex(parent)).children;
+    if (row >= children.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row,column,quint32(children.at(row)));
+}
+
+QModelIndex CompleterModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    return indexFromNode(m_nodes.at(nodeFromIndex(child)).parent);
+}
+
+int CompleterModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    return m_nodes.at(nodeFromIndex(parent)).children.size();
+}
+
+int CompleterModel::columnCount(const QModelIndex &/*parent*/) const
+{
+    return 1;
+}
+
+QStringRef CompleterModel::nameRef(int node) const
+{
+    const Node &n = m_nodes.at(node);
+    return QStringRef(&m_text,n.name,n.nameSize);
+}
+
+// one bit per folded ascii letter and digit, one for '_' and one for
+// anything else. a name can only match a query whose bits it has.
+quint64 CompleterModel::textMask(const QChar *text, int size)
+{
+    quint64 mask = 0;
+    for (int i = 0; i < size; i++) {
+        ushort c = text[i].unicode();
+        if (c >= 'A' && c <= 'Z') {
+            mask |= quint64(1) << (c-'A');
+        } else if (c >= 'a' && c <= 'z') {
+            mask |= quint64(1) << (c-'a');
+        } else if (c >= '0' && c <= '9') {
+            mask |= quint64(1) << (26+c-'0');
+        } else if (c == '_') {
+            mask |= quint64(1) << 36;
+        } else {
+            mask |= quint64(1) << 37;
+        }
+    }
+    return mask;
+}
+
+QVariant CompleterModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    return nodeData(nodeFromIndex(index),role);
+}
+
+QVariant CompleterModel::nodeData(int node, int role) const
+{
+    const Node &n = m_nodes.at(node);
+    switch (role) {
+    case Qt::DisplayRole:
+        if (n.infoSize == 0) {
+            return text(n.name,n.nameSize);
+        }
+        return QString("%1\t%2").arg(text(n.name,n.nameSize)).arg(text(n.info,n.infoSize));
+    case Qt::EditRole:
+    case NameRole:
+        return text(n.name,n.nameSize);
+    case Qt::DecorationRole:
+        if (n.icon >= 0) {
+            return m_icons.at(n.icon);
+        }
+        break;
+    case KindRole:
+        return text(n.kind,n.kindSize);
+    case InfoRole:
+        return text(n.info,n.infoSize);
+    case TempRole:
+        return n.temp;
+    }
+    return QVariant();
+}
+
+// children are kept sorted as they are added, nothing to do here
+void CompleterModel::sort(int /*column*/, Qt::SortOrder /*order*/)
+{
+}
+
+CompletionListModel::CompletionListModel(CompleterModel *source, QObject *parent) :
+    QAbstractListModel(parent),
+    m_source(source)
+{
+}
+
+void CompletionListModel::setResult(const QString &path, const QVector<int> &nodes)
+{
+    beginResetModel();
+    m_path = path;
+    m_nodes = nodes;
+    endResetModel();
+}
+
+void CompletionListModel::clearResult()
+{
+    if (m_nodes.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    m_nodes.clear();
+    endResetModel();
+}
+
+int CompletionListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_nodes.size();
+}
+
+QVariant CompletionListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_nodes.size()) {
+        return QVariant();
+    }
+    int node = m_nodes.at(index.row());
+    if (role == PathRole) {
+        return m_path+m_source->nameRef(node).toString();
+    }
+    return m_source->nodeData(node,role);
+}
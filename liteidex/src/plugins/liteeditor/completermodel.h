@@ -0,0 +1,151 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: completermodel.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef COMPLETERMODEL_H
+#define COMPLETERMODEL_H
+
+#include <QAbstractItemModel>
+#include <QAbstractListModel>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QIcon>
+
+// CompleterModel is the word tree of LiteCompleter. nodes live in one
+// vector and are found by an open addressing hash of (parent,name), all
+// strings share one buffer. children are always kept sorted by name so
+// QCompleter can run its binary search on them, a batch defers sorting
+// to the end. node 0 is the invisible root.
+class CompleterModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum {
+        NameRole = Qt::UserRole+2,
+        KindRole,
+        InfoRole,
+        TempRole
+    };
+    explicit CompleterModel(QObject *parent = 0);
+    void setSortCaseSensitivity(Qt::CaseSensitivity cs);
+    Qt::CaseSensitivity sortCaseSensitivity() const;
+    int findChild(int parent, const QString &name) const;
+    int addChild(int parent, const QString &name, bool *isNew = 0);
+    void setItem(int node, const QString &kind, const QString &info, const QIcon &icon, bool temp);
+    QString name(int node) const;
+    QString kind(int node) const;
+    QString info(int node) const;
+    bool isTemp(int node) const;
+    void removeChildren(int parent);
+    void removeTemp();
+    void clear();
+    void beginBatch();
+    void endBatch();
+    int nodeFromIndex(const QModelIndex &index) const;
+    QModelIndex indexFromNode(int node) const;
+    QVariant nodeData(int node, int role) const;
+    // for completion engines, valid until the next change
+    int generation() const { return m_generation; }
+    const QVector<int> &children(int node) const { return m_nodes.at(node).children; }
+    QStringRef nameRef(int node) const;
+    quint64 nameMask(int node) const { return m_nodes.at(node).mask; }
+    static quint64 textMask(const QChar *text, int size);
+public:
+    virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    virtual QModelIndex parent(const QModelIndex &child) const;
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+protected:
+    struct Node {
+        int  parent;
+        uint hash;
+        quint64 mask;
+        int  name;
+        int  nameSize;
+        int  kind;
+        int  kindSize;
+        int  info;
+        int  infoSize;
+        int  icon;
+        bool temp;
+        bool used;
+        QVector<int> children;
+    };
+    friend struct NodeLessThan;
+    void init();
+    QString text(int offset, int size) const;
+    int appendText(const QString &text);
+    int compareNode(int a, int b) const;
+    int compareName(const QString &name, int node) const;
+    int rowOf(int node) const;
+    int lowerBound(int parent, const QString &name) const;
+    uint hashOf(int parent, const QString &name) const;
+    int findSlot(int parent, const QString &name, uint hash) const;
+    void insertSlot(int node);
+    void removeSlot(int node);
+    void rehash(int size);
+    void freeNode(int node);
+    void sortChildren(int node);
+    void compactText();
+    void removeTemp(int parent);
+protected:
+    QVector<Node>  m_nodes;
+    QVector<int>   m_free;
+    QVector<int>   m_table;
+    int            m_tableUsed;
+    int            m_tableDeleted;
+    QString        m_text;
+    int            m_garbage;
+    QList<QIcon>   m_icons;
+    QHash<qint64,int> m_iconMap;
+    Qt::CaseSensitivity m_cs;
+    int            m_batch;
+    QSet<int>      m_dirty;
+    int            m_generation;
+};
+
+// CompletionListModel is the flat ranked result list QCompleter shows,
+// rows refer to nodes of a CompleterModel.
+class CompletionListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum {
+        PathRole = CompleterModel::TempRole+1
+    };
+    explicit CompletionListModel(CompleterModel *source, QObject *parent = 0);
+    void setResult(const QString &path, const QVector<int> &nodes);
+    void clearResult();
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+protected:
+    CompleterModel *m_source;
+    QString         m_path;
+    QVector<int>    m_nodes;
+};
+
+#endif // COMPLETERMODEL_H
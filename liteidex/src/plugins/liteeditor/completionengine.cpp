@@ -0,0 +1,298 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: completionengine.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "completionengine.h"
+#include "completermodel.h"
+#include <algorithm>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+static inline ushort foldChar(QChar c)
+{
+    ushort u = c.unicode();
+    if (u < 128) {
+        return (u >= 'A' && u <= 'Z') ? u+32 : u;
+    }
+    return c.toLower().unicode();
+}
+
+// start of name, after '_' or a non word char, lower to upper case and
+// letter to digit changes
+static inline bool isBoundary(const QChar *s, int i)
+{
+    if (i == 0) {
+        return true;
+    }
+    QChar p = s[i-1];
+    QChar c = s[i];
+    if (p == QLatin1Char('_') || !p.isLetterOrNumber()) {
+        return true;
+    }
+    if (p.isLower() && c.isUpper()) {
+        return true;
+    }
+    return p.isLetter() && c.isDigit();
+}
+
+static inline ushort matchChar(QChar c, Qt::CaseSensitivity cs)
+{
+    return cs == Qt::CaseSensitive ? c.unicode() : foldChar(c);
+}
+
+static bool canMatch(const QChar *s, int n, int from, const ushort *q, int m, Qt::CaseSensitivity cs)
+{
+    int j = from;
+    for (int i = 0; i < m; i++) {
+        while (j < n && matchChar(s[j],cs) != q[i]) {
+            j++;
+        }
+        if (j >= n) {
+            return false;
+        }
+        j++;
+    }
+    return true;
+}
+
+CompletionEngine::CompletionEngine(CompleterModel *model) :
+    m_model(model),
+    m_limit(500),
+    m_caseSensitivity(Qt::CaseInsensitive),
+    m_parent(-1),
+    m_generation(-1),
+    m_hasQuery(false),
+    m_clock(0)
+{
+}
+
+void CompletionEngine::setLimit(int limit)
+{
+    m_limit = limit;
+}
+
+int CompletionEngine::limit() const
+{
+    return m_limit;
+}
+
+void CompletionEngine::setCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (m_caseSensitivity == cs) {
+        return;
+    }
+    m_caseSensitivity = cs;
+    m_hasQuery = false;
+    m_matches.clear();
+}
+
+void CompletionEngine::reset()
+{
+    m_parent = -1;
+    m_generation = -1;
+    m_nodes.clear();
+    m_masks.clear();
+    m_hasQuery = false;
+    m_query.clear();
+    m_matches.clear();
+}
+
+void CompletionEngine::updateCandidates(int parent)
+{
+    if (m_parent == parent && m_generation == m_model->generation()) {
+        return;
+    }
+    m_parent = parent;
+    m_generation = m_model->generation();
+    m_nodes = m_model->children(parent);
+    m_masks.resize(m_nodes.size());
+    for (int i = 0; i < m_nodes.size(); i++) {
+        m_masks[i] = m_model->nameMask(m_nodes.at(i));
+    }
+    m_hasQuery = false;
+    m_matches.clear();
+}
+
+uint CompletionEngine::nameHash(const QChar *name, int size) const
+{
+    uint h = 0;
+    for (int i = 0; i < size; i++) {
+        h = h*31+name[i].unicode();
+    }
+    return h;
+}
+
+bool CompletionEngine::matchScore(const QChar *name, int size, int &score) const
+{
+    int m = m_folded.size();
+    score = 0;
+    if (m == 0) {
+        return true;
+    }
+    if (m > size) {
+        return false;
+    }
+    const ushort *q = m_folded.constData();
+    int pos = 0;
+    int prev = -1;
+    int first = -1;
+    bool run = true;
+    for (int i = 0; i < m; i++) {
+        int j = pos;
+        while (j < size && matchChar(name[j],m_caseSensitivity) != q[i]) {
+            j++;
+        }
+        if (j >= size) {
+            return false;
+        }
+        int k = j;
+        //prefer the same char on a word boundary if the rest still matches
+        if ((i == 0 || j != prev+1) && !isBoundary(name,j)) {
+            for (int t = j+1; t < size; t++) {
+                if (matchChar(name[t],m_caseSensitivity) == q[i] && isBoundary(name,t) &&
+                        canMatch(name,size,t+1,q+i+1,m-i-1,m_caseSensitivity)) {
+                    k = t;
+                    break;
+                }
+            }
+        }
+        if (i == 0) {
+            first = k;
+        } else if (k == prev+1) {
+            score += 6;
+        } else {
+            run = false;
+            score -= qMin(k-pos,4);
+        }
+        if (isBoundary(name,k)) {
+            score += 10;
+        }
+        if (name[k] == m_current.at(i)) {
+            score += 2;
+        }
+        prev = k;
+        pos = k+1;
+    }
+    if (first == 0) {
+        score += 12;
+        if (run) {
+            score += 24;
+            if (m == size) {
+                score += 50;
+            }
+        }
+    } else {
+        score -= qMin(first,4);
+    }
+    //shorter names first among equal matches
+    score -= qMin(size-m,20)/4;
+    return true;
+}
+
+QVector<int> CompletionEngine::complete(int parent, const QString &query)
+{
+    updateCandidates(parent);
+    m_current = query;
+    m_folded.resize(query.size());
+    for (int i = 0; i < query.size(); i++) {
+        m_folded[i] = matchChar(query.at(i),m_caseSensitivity);
+    }
+
+    //a longer query only narrows the last matches
+    QVector<int> candidates;
+    if (m_hasQuery && query.startsWith(m_query,m_caseSensitivity)) {
+        candidates = m_matches;
+    } else {
+        //branch free mask filter over the contiguous mask array
+        quint64 qmask = CompleterModel::textMask(query.constData(),query.size());
+        int count = m_masks.size();
+        candidates.resize(count);
+        const quint64 *masks = m_masks.constData();
+        int *out = candidates.data();
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            out[n] = i;
+            n += ((masks[i] & qmask) == qmask);
+        }
+        candidates.resize(n);
+    }
+
+    QVector<int> matches;
+    QVector<Match> ranked;
+    matches.reserve(candidates.size());
+    ranked.reserve(candidates.size());
+    foreach (int i, candidates) {
+        QStringRef name = m_model->nameRef(m_nodes.at(i));
+        Match match;
+        if (!matchScore(name.unicode(),name.size(),match.score)) {
+            continue;
+        }
+        if (!m_recent.isEmpty()) {
+            QHash<uint,uint>::const_iterator it = m_recent.constFind(nameHash(name.unicode(),name.size()));
+            if (it != m_recent.constEnd()) {
+                uint age = m_clock-it.value();
+                match.score += age < 16 ? 40 : (age < 64 ? 20 : 8);
+            }
+        }
+        match.order = i;
+        match.node = m_nodes.at(i);
+        matches.append(i);
+        ranked.append(match);
+    }
+    m_hasQuery = true;
+    m_query = query;
+    m_matches = matches;
+
+    if (m_limit > 0 && ranked.size() > m_limit) {
+        std::partial_sort(ranked.begin(),ranked.begin()+m_limit,ranked.end());
+        ranked.resize(m_limit);
+    } else {
+        std::sort(ranked.begin(),ranked.end());
+    }
+    QVector<int> result(ranked.size());
+    for (int i = 0; i < ranked.size(); i++) {
+        result[i] = ranked.at(i).node;
+    }
+    return result;
+}
+
+void CompletionEngine::addRecent(const QString &name)
+{
+    m_recent.insert(nameHash(name.constData(),name.size()),++m_clock);
+    if (m_recent.size() > 1024) {
+        QHash<uint,uint>::iterator it = m_recent.begin();
+        while (it != m_recent.end()) {
+            if (m_clock-it.value() > 512) {
+                it = m_recent.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
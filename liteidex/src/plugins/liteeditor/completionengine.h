@@ -0,0 +1,80 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: completionengine.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef COMPLETIONENGINE_H
+#define COMPLETIONENGINE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+class CompleterModel;
+
+// CompletionEngine ranks the children of one CompleterModel node against
+// a query. a name matches when the query is a subsequence of it, case
+// folded unless case sensitive, matches on camelCase and underscore boundaries,
+// consecutive runs, prefixes and recently inserted names score higher.
+// a growing query narrows the previous matches instead of rescanning.
+class CompletionEngine
+{
+public:
+    explicit CompletionEngine(CompleterModel *model);
+    void setLimit(int limit);
+    int limit() const;
+    void setCaseSensitivity(Qt::CaseSensitivity cs);
+    QVector<int> complete(int parent, const QString &query);
+    void addRecent(const QString &name);
+    void reset();
+protected:
+    struct Match {
+        int score;
+        int order;
+        int node;
+        bool operator<(const Match &other) const {
+            return score > other.score || (score == other.score && order < other.order);
+        }
+    };
+    void updateCandidates(int parent);
+    bool matchScore(const QChar *name, int size, int &score) const;
+    uint nameHash(const QChar *name, int size) const;
+protected:
+    CompleterModel *m_model;
+    int             m_limit;
+    Qt::CaseSensitivity m_caseSensitivity;
+    // candidates of m_parent, masks kept apart for the prefilter
+    int             m_parent;
+    int             m_generation;
+    QVector<int>    m_nodes;
+    QVector<quint64> m_masks;
+    // last query and all nodes it matched, in candidate order
+    bool            m_hasQuery;
+    QString         m_query;
+    QVector<int>    m_matches;
+    // current query, folded unless case sensitive
+    QString         m_current;
+    QVector<ushort> m_folded;
+    QHash<uint,uint> m_recent;
+    uint            m_clock;
+};
+
+#endif // COMPLETIONENGINE_H
@@ -0,0 +1,187 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: documentwordindex.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "documentwordindex.h"
+#include "textsnapshot/textsnapshot.h"
+#include <QTextDocument>
+#include <QTextBlock>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+DocumentWordIndex::DocumentWordIndex(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void DocumentWordIndex::setDocument(QTextDocument *doc)
+{
+    if (m_document == doc) {
+        return;
+    }
+    if (m_snapshot) {
+        disconnect(m_snapshot,0,this,0);
+    }
+    m_document = doc;
+    LiteApi::IUtf8Snapshot *snapshot = Utf8Snapshot::attach(doc);
+    m_snapshot = snapshot ? snapshot->object() : 0;
+    if (m_snapshot) {
+        connect(m_snapshot,SIGNAL(blocksChanged(int,int,int)),this,SLOT(blocksChanged(int,int,int)));
+    }
+    rebuild();
+}
+
+QTextDocument *DocumentWordIndex::document() const
+{
+    return m_document;
+}
+
+QStringList DocumentWordIndex::find(const QString &prefix) const
+{
+    QStringList words;
+    QMap<QString,int>::const_iterator it = m_words.lowerBound(prefix);
+    while (it != m_words.constEnd() && it.key().startsWith(prefix)) {
+        words.append(it.key());
+        ++it;
+    }
+    return words;
+}
+
+int DocumentWordIndex::count(const QString &word) const
+{
+    return m_words.value(word);
+}
+
+int DocumentWordIndex::size() const
+{
+    return m_words.size();
+}
+
+void DocumentWordIndex::clear()
+{
+    m_blocks.clear();
+    m_words.clear();
+}
+
+void DocumentWordIndex::rebuild()
+{
+    clear();
+    if (!m_document) {
+        return;
+    }
+    m_blocks.reserve(m_document->blockCount());
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next()) {
+        QStringList words = blockWords(block.text());
+        addWords(words);
+        m_blocks.append(words);
+    }
+}
+
+void DocumentWordIndex::blocksChanged(int from, int removed, int added)
+{
+    if (!m_document) {
+        return;
+    }
+    if (from+removed > m_blocks.size()) {
+        rebuild();
+        return;
+    }
+    for (int i = from; i < from+removed; i++) {
+        removeWords(m_blocks.at(i));
+    }
+    m_blocks.remove(from,removed);
+    QTextBlock block = m_document->findBlockByNumber(from);
+    for (int i = 0; i < added && block.isValid(); i++, block = block.next()) {
+        QStringList words = blockWords(block.text());
+        addWords(words);
+        m_blocks.insert(from+i,words);
+    }
+}
+
+void DocumentWordIndex::addWords(const QStringList &words)
+{
+    foreach (QString word, words) {
+        m_words[word]++;
+    }
+}
+
+void DocumentWordIndex::removeWords(const QStringList &words)
+{
+    foreach (QString word, words) {
+        QMap<QString,int>::iterator it = m_words.find(word);
+        if (it == m_words.end()) {
+            continue;
+        }
+        if (--it.value() <= 0) {
+            m_words.erase(it);
+        }
+    }
+}
+
+static inline bool isWordStart(QChar c)
+{
+    return c.isLetter() || c == QLatin1Char('_');
+}
+
+static inline bool isWordChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_') ||
+            c == QLatin1Char('.') || c == QLatin1Char('@');
+}
+
+QStringList DocumentWordIndex::blockWords(const QString &text)
+{
+    QStringList words;
+    const QChar *data = text.constData();
+    int size = text.size();
+    int i = 0;
+    while (i < size) {
+        if (!isWordStart(data[i])) {
+            //skip the rest of numbers like 0x1f
+            if (data[i].isDigit()) {
+                while (i < size && data[i].isLetterOrNumber()) {
+                    i++;
+                }
+            } else {
+                i++;
+            }
+            continue;
+        }
+        int start = i;
+        while (i < size && isWordChar(data[i])) {
+            i++;
+        }
+        int end = i;
+        while (end > start && data[end-1] == QLatin1Char('.')) {
+            end--;
+        }
+        words.append(QString(data+start,end-start));
+    }
+    return words;
+}
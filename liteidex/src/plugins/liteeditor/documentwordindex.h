@@ -0,0 +1,63 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: documentwordindex.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef DOCUMENTWORDINDEX_H
+#define DOCUMENTWORDINDEX_H
+
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+
+class QTextDocument;
+
+// DocumentWordIndex counts the words of a text document, a word is an
+// identifier chain like "os.Args". only the blocks the document snapshot
+// reports as changed are scanned again.
+class DocumentWordIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DocumentWordIndex(QObject *parent = 0);
+    void setDocument(QTextDocument *doc);
+    QTextDocument *document() const;
+    QStringList find(const QString &prefix) const;
+    int count(const QString &word) const;
+    int size() const;
+    void clear();
+protected slots:
+    void blocksChanged(int from, int removed, int added);
+protected:
+    void rebuild();
+    void addWords(const QStringList &words);
+    void removeWords(const QStringList &words);
+    static QStringList blockWords(const QString &text);
+protected:
+    QPointer<QTextDocument> m_document;
+    QPointer<QObject>       m_snapshot;
+    QVector<QStringList>    m_blocks;
+    QMap<QString,int>       m_words;
+};
+
+#endif // DOCUMENTWORDINDEX_H
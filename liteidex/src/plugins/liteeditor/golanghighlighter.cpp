@@ -32,6 +32,200 @@
 #endif
 //lite_memory_check_end
 
+enum GolangCharClass {
+    CharOther = 0,
+    CharSpace,
+    CharLetter,
+    CharDigit,
+    CharDot,
+    CharQuote,
+    CharSlash
+};
+
+enum GolangWordKind {
+    WordNone = 0,
+    WordKeyword,
+    WordPredeclared
+};
+
+struct GolangCharTable
+{
+    GolangCharTable() {
+        for (int i = 0; i < 128; i++) {
+            cls[i] = CharOther;
+        }
+        for (int i = 'a'; i <= 'z'; i++) {
+            cls[i] = CharLetter;
+        }
+        for (int i = 'A'; i <= 'Z'; i++) {
+            cls[i] = CharLetter;
+        }
+        for (int i = '0'; i <= '9'; i++) {
+            cls[i] = CharDigit;
+        }
+        cls[int('_')] = CharLetter;
+        cls[int(' ')] = CharSpace;
+        cls[int('\t')] = CharSpace;
+        cls[int('.')] = CharDot;
+        cls[int('"')] = CharQuote;
+        cls[int('\'')] = CharQuote;
+        cls[int('`')] = CharQuote;
+        cls[int('/')] = CharSlash;
+    }
+    unsigned char cls[128];
+};
+
+static inline int charClass(const QChar &ch)
+{
+    static GolangCharTable table;
+    ushort c = ch.unicode();
+    if (c < 128) {
+        return table.cls[c];
+    }
+    if (ch.isLetter()) {
+        return CharLetter;
+    } else if (ch.isDigit()) {
+        return CharDigit;
+    } else if (ch.isSpace()) {
+        return CharSpace;
+    }
+    return CharOther;
+}
+
+static inline bool isIdentChar(const QChar &ch)
+{
+    int cls = charClass(ch);
+    return cls == CharLetter || cls == CharDigit;
+}
+
+struct GolangWord
+{
+    const char *word;
+    int kind;
+};
+
+// sorted by byte order for wordKind
+static const GolangWord golangWords[] = {
+    {"append", WordPredeclared},
+    {"bool", WordPredeclared},
+    {"break", WordKeyword},
+    {"byte", WordPredeclared},
+    {"cap", WordPredeclared},
+    {"case", WordKeyword},
+    {"chan", WordKeyword},
+    {"close", WordPredeclared},
+    {"closed", WordPredeclared},
+    {"complex", WordPredeclared},
+    {"complex128", WordPredeclared},
+    {"complex64", WordPredeclared},
+    {"const", WordKeyword},
+    {"continue", WordKeyword},
+    {"copy", WordPredeclared},
+    {"default", WordKeyword},
+    {"defer", WordKeyword},
+    {"else", WordKeyword},
+    {"fallthrough", WordKeyword},
+    {"false", WordPredeclared},
+    {"float32", WordPredeclared},
+    {"float64", WordPredeclared},
+    {"for", WordKeyword},
+    {"func", WordKeyword},
+    {"go", WordKeyword},
+    {"goto", WordKeyword},
+    {"if", WordKeyword},
+    {"imag", WordPredeclared},
+    {"import", WordKeyword},
+    {"int", WordPredeclared},
+    {"int16", WordPredeclared},
+    {"int32", WordPredeclared},
+    {"int64", WordPredeclared},
+    {"int8", WordPredeclared},
+    {"interface", WordKeyword},
+    {"iota", WordPredeclared},
+    {"len", WordPredeclared},
+    {"make", WordPredeclared},
+    {"map", WordKeyword},
+    {"new", WordPredeclared},
+    {"nil", WordPredeclared},
+    {"package", WordKeyword},
+    {"panic", WordPredeclared},
+    {"print", WordPredeclared},
+    {"println", WordPredeclared},
+    {"range", WordKeyword},
+    {"real", WordPredeclared},
+    {"recover", WordPredeclared},
+    {"return", WordKeyword},
+    {"select", WordKeyword},
+    {"string", WordPredeclared},
+    {"struct", WordKeyword},
+    {"switch", WordKeyword},
+    {"true", WordPredeclared},
+    {"type", WordKeyword},
+    {"uint", WordPredeclared},
+    {"uint16", WordPredeclared},
+    {"uint32", WordPredeclared},
+    {"uint64", WordPredeclared},
+    {"uint8", WordPredeclared},
+    {"uintptr", WordPredeclared},
+    {"var", WordKeyword},
+};
+
+static int compareWord(const QChar *s, int length, const char *word)
+{
+    for (int i = 0; i < length; i++) {
+        uchar w = uchar(word[i]);
+        if (w == 0) {
+            return 1;
+        }
+        ushort c = s[i].unicode();
+        if (c != w) {
+            return c < w ? -1 : 1;
+        }
+    }
+    return word[length] == 0 ? 0 : -1;
+}
+
+static int wordKind(const QChar *s, int length)
+{
+    int lo = 0;
+    int hi = int(sizeof(golangWords)/sizeof(golangWords[0]))-1;
+    while (lo <= hi) {
+        int mid = (lo+hi)/2;
+        int r = compareWord(s,length,golangWords[mid].word);
+        if (r == 0) {
+            return golangWords[mid].kind;
+        } else if (r < 0) {
+            hi = mid-1;
+        } else {
+            lo = mid+1;
+        }
+    }
+    return WordNone;
+}
+
+static int scanNumber(const QChar *data, int pos, int length)
+{
+    bool hex = false;
+    if (data[pos] == '0' && pos+1 < length && (data[pos+1] == 'x' || data[pos+1] == 'X')) {
+        hex = true;
+        pos += 2;
+    }
+    while (pos < length) {
+        ushort c = data[pos].unicode();
+        if ((hex ? (c == 'p' || c == 'P') : (c == 'e' || c == 'E')) &&
+                pos+1 < length && (data[pos+1] == '+' || data[pos+1] == '-')) {
+            pos += 2;
+            continue;
+        }
+        if (c < 128 && (charClass(data[pos]) == CharLetter ||
+                        charClass(data[pos]) == CharDigit || c == '.')) {
+            pos++;
+            continue;
+        }
+        break;
+    }
+    return pos;
+}
 
 GolangHighlighter::GolangHighlighter(QTextDocument* document):
     QSyntaxHighlighter(document), allWords(new QSet<QString>)
@@ -50,177 +244,138 @@ GolangHighlighter::GolangHighlighter(QTextDocument* document):
     singleLineCommentFormat.setForeground(Qt::darkCyan);
     multiLineCommentFormat.setForeground(Qt::darkCyan);
 
-    QString word;
-    HighlightingRule rule;
-    //number
-    rule.pattern = QRegExp("(\\b|\\.)([0-9]+|0[xX][0-9a-fA-F]+|0[0-7]+)(\\.[0-9]+)?([eE][+-]?[0-9]+i?)?\\b");
-    rule.format = numberFormat;
-
-    highlightingRules.push_back(rule);
-
-    //function
-    rule.pattern = QRegExp("\\b[a-zA-Z_][a-zA-Z0-9_]+\\s*(?=\\()");
-    rule.format = functionFormat;
-
-    highlightingRules.push_back(rule);
-
-    //indent
-    rule.pattern = QRegExp("\\b"
-                           "(bool|byte|complex64|complex128|float32|float64|"
-                           "int8|int16|int32|int64|string|uint8|uint16|uint32|uint64|"
-                           "int|uint|uintptr|"
-                           "true|false|iota|"
-                           "nil|"
-                           "append|cap|close|closed|complex|copy|imag|len|"
-                           "make|new|panic|print|println|real|recover)"
-                           "\\b");
-    rule.format = identFormat;
-    highlightingRules.append(rule);
-    //
-    word = rule.pattern.pattern();
-    word.remove("\\b");
-    word.remove("(");
-    word.remove(")");
-    foreach(QString v, word.split("|")) {
-        allWords->insert(v);
+    for (size_t i = 0; i < sizeof(golangWords)/sizeof(golangWords[0]); i++) {
+        allWords->insert(QLatin1String(golangWords[i].word));
     }
+}
 
-    //keyword
-    rule.pattern = QRegExp("\\b"
-                           "(break|default|func|interface|select|"
-                           "case|defer|go|map|struct|"
-                           "chan|else|goto|package|switch|"
-                           "const|fallthrough|if|range|type|"
-                           "continue|for|import|return|var)"
-                           "\\b");
-    rule.format = keywordFormat;
-    highlightingRules.append(rule);
-
-    word = rule.pattern.pattern();
-    word.remove("\\b");
-    word.remove("(");
-    word.remove(")");
-    foreach(QString v, word.split("|")) {
-        allWords->insert(v);
+void GolangHighlighter::addWord(const QChar *word, int length)
+{
+    if (allWords->size() >= MaxWords) {
+        return;
+    }
+    if (!allWords->contains(QString::fromRawData(word,length))) {
+        allWords->insert(QString(word,length));
     }
-
-    //quotes and comment
-    regexpQuotesAndComment = QRegExp("//|\\\"|'|`|/\\*");
 }
 
-
-bool GolangHighlighter::highlightPreBlock(QString const& text, int& startPos, int& endPos)
+// single pass over the line, the block state carries raw strings and comments
+void GolangHighlighter::highlightBlock(const QString &text)
 {
-    int state = previousBlockState();
+    const QChar *data = text.unicode();
+    const int length = text.length();
+    int pos = 0;
 
-    if (state == -1)
+    int state = previousBlockState();
+    if (state == -1) {
         state = 0;
+    }
+    setCurrentBlockState(0);
 
     if (state & STATE_BACKQUOTES) {
-        endPos = findQuotesEndPos(text, startPos, '`');
-        if (endPos == -1) {
-            setFormat(0, text.length(), quotesFormat);
+        int end = findQuotesEndPos(text, 0, '`');
+        if (end == -1) {
+            setFormat(0, length, quotesFormat);
             setCurrentBlockState(STATE_BACKQUOTES);
-            return true;
-        } else {
-            endPos += 1;
-            setFormat(0, endPos - startPos, quotesFormat);
-            startPos = endPos;
+            return;
         }
+        pos = end+1;
+        setFormat(0, pos, quotesFormat);
     } else if (state & STATE_MULTILINE_COMMENT) {
-        endPos = text.indexOf("*/", startPos);
-        if (endPos == -1) {
-            setFormat(0, text.length(), multiLineCommentFormat);
-            setCurrentBlockState(previousBlockState());
-            return true;
-        } else {
-            endPos += 2;
-            setFormat(0, endPos - startPos, multiLineCommentFormat);
-            startPos = endPos;
+        int end = findCommentEndPos(text, 0);
+        if (end == -1) {
+            setFormat(0, length, multiLineCommentFormat);
+            setCurrentBlockState(STATE_MULTILINE_COMMENT);
+            return;
         }
+        pos = end;
+        setFormat(0, pos, multiLineCommentFormat);
     } else if (state & STATE_SINGLELINE_COMMENT) {
-        setFormat(0, text.length(), singleLineCommentFormat);
+        setFormat(0, length, singleLineCommentFormat);
         if (text.endsWith("\\")) {
             setCurrentBlockState(STATE_SINGLELINE_COMMENT);
         }
-        return true;
-    }
-    return false;
-}
-
-void GolangHighlighter::highlightBlock(const QString &text)
-{
-    int startPos = 0;
-    int endPos = text.length();
-
-    setCurrentBlockState(0);
-
-    if (highlightPreBlock(text, startPos, endPos)) {
         return;
     }
 
-    //keyword and func
-    foreach (const HighlightingRule &rule, highlightingRules) {
-        QRegExp expression(rule.pattern);
-        int index = expression.indexIn(text,startPos);
-        while (index >= 0) {            
-            int length = expression.matchedLength();
-            setFormat(index, length, rule.format);
-            allWords->insert(text.mid(index,length));
-            index = expression.indexIn(text, startPos+index + length);            
+    while (pos < length) {
+        const QChar ch = data[pos];
+        switch (charClass(ch)) {
+        case CharLetter: {
+            int start = pos;
+            while (pos < length && isIdentChar(data[pos])) {
+                pos++;
+            }
+            int kind = wordKind(data+start,pos-start);
+            if (kind == WordKeyword) {
+                setFormat(start, pos-start, keywordFormat);
+            } else if (kind == WordPredeclared) {
+                setFormat(start, pos-start, identFormat);
+            } else {
+                int next = pos;
+                while (next < length && charClass(data[next]) == CharSpace) {
+                    next++;
+                }
+                if (next < length && data[next] == '(') {
+                    setFormat(start, pos-start, functionFormat);
+                    addWord(data+start,pos-start);
+                }
+            }
+            break;
         }
-    }
-
-    //quote and comment
-    while (true)
-    {
-        startPos = text.indexOf(regexpQuotesAndComment, startPos);
-        if (startPos == -1)
+        case CharDigit: {
+            int start = pos;
+            pos = scanNumber(data, pos, length);
+            setFormat(start, pos-start, numberFormat);
             break;
-
-        QString cap = regexpQuotesAndComment.cap();
-        if ((cap == "\"") || (cap == "'") || (cap == "`"))
-        {
-            endPos = findQuotesEndPos(text, startPos + 1, cap.at(0));
-            if (endPos == -1)
-            {
+        }
+        case CharDot:
+            if (pos+1 < length && charClass(data[pos+1]) == CharDigit && data[pos+1].unicode() < 128) {
+                int start = pos;
+                pos = scanNumber(data, pos+1, length);
+                setFormat(start, pos-start, numberFormat);
+            } else {
+                pos++;
+            }
+            break;
+        case CharQuote: {
+            int end = findQuotesEndPos(text, pos+1, ch);
+            if (end == -1) {
                 //multiline
-                setFormat(startPos, text.length() - startPos, quotesFormat);
-                if (cap == "`") {
+                setFormat(pos, length-pos, quotesFormat);
+                if (ch == '`') {
                     setCurrentBlockState(STATE_BACKQUOTES);
                 }
                 return;
             }
-            else
-            {
-                endPos += 1;
-                setFormat(startPos, endPos - startPos, quotesFormat);
-                startPos = endPos;
-            }
-        }
-        else if (cap == "//")
-        {
-            setFormat(startPos, text.length() - startPos, singleLineCommentFormat);
-            if (text.endsWith("\\"))
-                setCurrentBlockState(STATE_SINGLELINE_COMMENT);
-            return;
+            setFormat(pos, end+1-pos, quotesFormat);
+            pos = end+1;
+            break;
         }
-        else if (cap == "/*")
-        {
-            endPos = text.indexOf("*/", startPos+2);
-            if (endPos == -1)
-            {
-                //miltiline
-                setFormat(startPos, text.length() - startPos, multiLineCommentFormat);
-                setCurrentBlockState(STATE_MULTILINE_COMMENT);
+        case CharSlash:
+            if (pos+1 < length && data[pos+1] == '/') {
+                setFormat(pos, length-pos, singleLineCommentFormat);
+                if (text.endsWith("\\")) {
+                    setCurrentBlockState(STATE_SINGLELINE_COMMENT);
+                }
                 return;
+            } else if (pos+1 < length && data[pos+1] == '*') {
+                int end = findCommentEndPos(text, pos+2);
+                if (end == -1) {
+                    //multiline
+                    setFormat(pos, length-pos, multiLineCommentFormat);
+                    setCurrentBlockState(STATE_MULTILINE_COMMENT);
+                    return;
+                }
+                setFormat(pos, end-pos, multiLineCommentFormat);
+                pos = end;
+            } else {
+                pos++;
             }
-            else
-            {
-                endPos += 2;
-                setFormat(startPos, endPos - startPos, multiLineCommentFormat);
-                startPos = endPos;
-            }
+            break;
+        default:
+            pos++;
+            break;
         }
     }
 }
@@ -228,7 +383,7 @@ void GolangHighlighter::highlightBlock(const QString &text)
 int GolangHighlighter::findQuotesEndPos(const QString &text, int startPos, const QChar &endChar)
 {
     for (int pos = startPos; pos < text.length(); pos++)
-    {        
+    {
         if (text.at(pos) == endChar) {
             return pos;
         } else if (text.at(pos) == QChar('\\') && endChar != QChar('`')) {
@@ -237,3 +392,13 @@ int GolangHighlighter::findQuotesEndPos(const QString &text, int startPos, const
     }
     return -1;
 }
+
+// returns the position after the closing */
+int GolangHighlighter::findCommentEndPos(const QString &text, int startPos)
+{
+    int pos = text.indexOf("*/", startPos);
+    if (pos == -1) {
+        return -1;
+    }
+    return pos+2;
+}
@@ -25,7 +25,6 @@
 #define GOLANGHIGHLIGHTER_H
 
 #include <QSyntaxHighlighter>
-#include <QVector>
 #include <QTextCharFormat>
 #include <QSet>
 #include <QSharedPointer>
@@ -44,19 +43,17 @@ protected:
         STATE_SINGLELINE_COMMENT = 0x08,
         STATE_MULTILINE_COMMENT = 0x10
     };
+    enum {
+        MaxWords = 4096
+    };
     virtual void highlightBlock(const QString &text);
-    bool highlightPreBlock(const QString &text, int &startPos, int &endPos);
     int findQuotesEndPos(const QString &text, int startPos, const QChar &endChar);
+    int findCommentEndPos(const QString &text, int startPos);
+    void addWord(const QChar *word, int length);
 public:
+    // words seen so far, limited to MaxWords
     QSharedPointer< QSet<QString> >   allWords;
 private:
-    struct HighlightingRule
-    {
-        QRegExp pattern;
-        QTextCharFormat format;
-    };
-    QVector<HighlightingRule> highlightingRules;
-    QRegExp         regexpQuotesAndComment;
     QTextCharFormat functionFormat;
     QTextCharFormat singleLineCommentFormat;
     QTextCharFormat multiLineCommentFormat;
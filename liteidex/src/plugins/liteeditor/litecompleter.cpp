@@ -22,13 +22,13 @@
 // Creator: visualfc <visualfc@gmail.com>
 
 #include "litecompleter.h"
+#include "completermodel.h"
+#include "completionengine.h"
 #include "treemodelcompleter/treemodelcompleter.h"
 
 #include <QCompleter>
 #include <QPlainTextEdit>
 #include <QTextCursor>
-#include <QStandardItem>
-#include <QStandardItemModel>
 #include <QAbstractItemView>
 #include <QScrollBar>
 #include <QTextBlock>
@@ -44,80 +44,34 @@
 //lite_memory_check_end
 
 
-class WordItem : public QStandardItem
-{
-public:
-    WordItem(const QString &text) : QStandardItem(text)
-    {
-        this->setName(text);
-    }
-    enum {
-        NameRole = Qt::UserRole+2,
-        KindRole,
-        InfoRole,
-        TempRole
-    };
-    virtual QVariant data(int role = Qt::UserRole + 1) const
-    {
-        if (role == Qt::DisplayRole) {
-            if (this->info().isEmpty()) {
-                return this->name();
-            }
-            return QString("%1\t%2").arg(this->name()).arg(this->info());
-        }
-        return QStandardItem::data(role);
-    }
-    void setName(const QString &word)
-    {
-        this->setData(word,NameRole);
-    }
-    QString name() const
-    {
-        return QStandardItem::data(NameRole).toString();
-    }
-    void setKind(const QString &kind)
-    {
-        this->setData(kind,KindRole);
-    }
-    QString kind() const
-    {
-        return QStandardItem::data(KindRole).toString();
-    }
-    void setInfo(const QString &info)
-    {
-        this->setData(info,InfoRole);
-    }
-    QString info() const
-    {
-        return QStandardItem::data(InfoRole).toString();
-    }
-    void setTemp(bool temp)
-    {
-        this->setData(temp,TempRole);
-    }
-    bool isTemp() const
-    {
-        return QStandardItem::data(TempRole).toBool();
-    }
-};
-
 LiteCompleter::LiteCompleter(QObject *parent) :
     LiteApi::ICompleter(parent),
     m_completer( new TreeModelCompleter(this)),
-    m_model(new QStandardItemModel(this))
+    m_model(new CompleterModel(this))
 {
-    m_completer->setModel(m_model);
-    m_completer->setCompletionMode(QCompleter::PopupCompletion);
+    m_listModel = new CompletionListModel(m_model,this);
+    m_engine = new CompletionEngine(m_model);
+    //the engine filters and ranks, the popup shows its result as is
+    m_completer->setModel(m_listModel);
+    m_completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     m_completer->setCaseSensitivity(Qt::CaseSensitive);
-    m_completer->setSeparator(".");
+    m_completer->setModelSorting(QCompleter::UnsortedModel);
+    m_completer->setCompletionRole(CompletionListModel::PathRole);
+    m_separator = ".";
     m_stop = '(';
     QObject::connect(m_completer, SIGNAL(activated(QModelIndex)),
                      this, SLOT(insertCompletion(QModelIndex)));
+    QObject::connect(m_model, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                     this, SLOT(clearResult()));
+    QObject::connect(m_model, SIGNAL(modelAboutToBeReset()),
+                     this, SLOT(clearResult()));
 }
 
 LiteCompleter::~LiteCompleter()
 {
     delete m_completer;
+    delete m_engine;
+    delete m_listModel;
     delete m_model;
 }
 
@@ -132,76 +86,56 @@ QCompleter *LiteCompleter::completer() const
     return m_completer;
 }
 
-QStandardItem *LiteCompleter::findRoot(const QString &name)
+void LiteCompleter::setCaseSensitivity(Qt::CaseSensitivity cs)
 {
-    QStringList words = name.split(m_completer->separator(),QString::SkipEmptyParts);
-    WordItem *root = 0;
-    WordItem *item = 0;
+    m_model->setSortCaseSensitivity(cs);
+    m_completer->setCaseSensitivity(cs);
+    m_engine->setCaseSensitivity(cs);
+}
+
+void LiteCompleter::setSeparator(const QString &separator)
+{
+    m_separator = separator;
+}
+
+QString LiteCompleter::separator() const
+{
+    return m_separator;
+}
+
+void LiteCompleter::beginBatch()
+{
+    m_model->beginBatch();
+}
+
+void LiteCompleter::endBatch()
+{
+    m_model->endBatch();
+}
+
+QModelIndex LiteCompleter::findRoot(const QString &name)
+{
+    QStringList words = name.split(m_separator,QString::SkipEmptyParts);
+    int node = 0;
     foreach (QString word, words) {
-        item = 0;
-        QModelIndex parent = m_model->indexFromItem(root);
-        for (int i = 0; i < m_model->rowCount(parent); i++) {
-            QModelIndex index = m_model->index(i,0,parent);
-            if (index.data(WordItem::NameRole).toString() == word) {
-                item = static_cast<WordItem*>(m_model->itemFromIndex(index));
-                break;
-            }
-        }
-        if (item == 0) {
-            item = new WordItem(word);
-            if (root == 0) {
-                m_model->appendRow(item);
-            } else {
-                root->appendRow(item);
-            }
-        }
-        root = item;
+        node = m_model->addChild(node,word);
     }
-    return root;
+    return m_model->indexFromNode(node);
 }
 
-void LiteCompleter::clearChildItem(QStandardItem *root)
+void LiteCompleter::clearChildItem(const QModelIndex &root)
 {
-    if (root) {
-        QModelIndex index = m_model->indexFromItem(root);
-        m_model->removeRows(0,m_model->rowCount(index),index);
+    if (root.isValid()) {
+        m_model->removeChildren(m_model->nodeFromIndex(root));
     }
 }
 
-void LiteCompleter::appendChildItem(QStandardItem *root, QString name, const QString &kind, const QString &info, const QIcon &icon, bool temp)
+void LiteCompleter::appendChildItem(const QModelIndex &root, QString name, const QString &kind, const QString &info, const QIcon &icon, bool temp)
 {
-    if (root == 0) {
-        WordItem *item = 0;
-        QModelIndex parent = m_model->indexFromItem(root);
-        int count = m_model->rowCount(parent);
-        while(count--) {
-            QModelIndex index = m_model->index(count,0,parent);
-            if (index.data(WordItem::NameRole).toString() == name) {
-                item = static_cast<WordItem*>(m_model->itemFromIndex(index));
-                break;
-            }
-        }
-        if (item == 0) {
-            item = new WordItem(name);
-            if (root == 0) {
-                m_model->appendRow(item);
-            } else {
-                root->appendRow(item);
-            }
-        }
-        if (item && item->kind().isEmpty()) {
-            item->setKind(kind);
-            item->setInfo(info);
-            item->setTemp(temp);
-            item->setIcon(icon);
-        }
-   } else {
-        WordItem *item = new WordItem(name);
-        root->appendRow(item);
-        item->setKind(kind);
-        item->setInfo(info);
-        item->setTemp(temp);
-        item->setIcon(icon);
+    bool bnew = false;
+    int node = m_model->addChild(m_model->nodeFromIndex(root),name,&bnew);
+    if (bnew || m_model->kind(node).isEmpty()) {
+        m_model->setItem(node,kind,info,icon,temp);
     }
 }
 
@@ -210,21 +144,9 @@ void LiteCompleter::clear()
     m_model->clear();
 }
 
-static void clearTempIndex(QStandardItemModel *model, QModelIndex parent) {
-    int i = model->rowCount(parent);
-    while (i--) {
-        QModelIndex index = model->index(i,0,parent);
-        if (index.data(WordItem::TempRole).toBool() == true) {
-            model->removeRow(i,parent);
-        } else {
-            clearTempIndex(model,index);
-        }
-    }
-}
-
 void LiteCompleter::clearTemp()
 {
-    clearTempIndex(m_model,QModelIndex());
+    m_model->removeTemp();
 }
 
 void LiteCompleter::show()
@@ -232,20 +154,46 @@ void LiteCompleter::show()
     if (!m_editor) {
         return;
     }
-    m_completer->model()->sort(0);
-    m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+    updateCompletion(m_completer->completionPrefix());
     QRect cr = m_editor->cursorRect();
     cr.setWidth(m_completer->popup()->sizeHintForColumn(0)
                 + m_completer->popup()->verticalScrollBar()->sizeHint().width());
     m_completer->complete(cr); // popup it up!
+    m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+}
 
+void LiteCompleter::clearResult()
+{
+    m_listModel->clearResult();
+}
+
+void LiteCompleter::updateCompletion(const QString &prefix)
+{
+    int pos = prefix.lastIndexOf(m_separator);
+    QString path;
+    QString query = prefix;
+    if (pos != -1) {
+        path = prefix.left(pos+m_separator.length());
+        query = prefix.mid(pos+m_separator.length());
+    }
+    int node = 0;
+    foreach (QString word, path.split(m_separator,QString::SkipEmptyParts)) {
+        node = m_model->findChild(node,word);
+        if (node < 0) {
+            m_listModel->clearResult();
+            return;
+        }
+    }
+    m_listModel->setResult(path,m_engine->complete(node,query));
 }
 
 void LiteCompleter::appendItems(QStringList items,const QString &kind, const QString &info,const QIcon &icon, bool temp)
 {
+    m_model->beginBatch();
     foreach(QString item,items) {
         appendItemEx(item,kind,info,icon,temp);
     }
+    m_model->endBatch();
 }
 
 
@@ -264,61 +212,31 @@ bool LiteCompleter::appendItem(const QString &name, const QIcon &icon, bool temp
 
 void LiteCompleter::clearItemChilds(const QString &name)
 {
-    QStringList words = name.split(m_completer->separator(),QString::SkipEmptyParts);
-    WordItem *root = 0;
-    WordItem *item = 0;
+    QStringList words = name.split(m_separator,QString::SkipEmptyParts);
+    int node = 0;
     foreach (QString word, words) {
-        item = 0;
-        QModelIndex parent = m_model->indexFromItem(root);
-        int count = m_model->rowCount(parent);
-        while(count--) {
-            QModelIndex index = m_model->index(count,0,parent);
-            if (index.data(WordItem::NameRole).toString() == word) {
-                item = static_cast<WordItem*>(m_model->itemFromIndex(index));
-                break;
-            }
+        node = m_model->findChild(node,word);
+        if (node < 0) {
+            return;
         }
-        root = item;
     }
-    if (item) {
-        QModelIndex index = m_model->indexFromItem(item);
-        m_model->removeRows(0,m_model->rowCount(index),index);        
+    if (node > 0) {
+        m_model->removeChildren(node);
     }
 }
 
 bool LiteCompleter::appendItemEx(const QString &name,const QString &kind, const QString &info, const QIcon &icon, bool temp)
 {
-    QStringList words = name.split(m_completer->separator(),QString::SkipEmptyParts);
-
-    WordItem *root = 0;
-    WordItem *item = 0;
-    bool bnew = false;    
+    QStringList words = name.split(m_separator,QString::SkipEmptyParts);
+    int node = 0;
+    bool bnew = false;
     foreach (QString word, words) {
-        item = 0;
-        QModelIndex parent = m_model->indexFromItem(root);
-        for (int i = 0; i < m_model->rowCount(parent); i++) {
-            QModelIndex index = m_model->index(i,0,parent);
-            if (index.data(WordItem::NameRole).toString() == word) {
-                item = static_cast<WordItem*>(m_model->itemFromIndex(index));
-                break;
-            }
-        }
-        if (item == 0) {
-            item = new WordItem(word);
-            if (root == 0) {
-                m_model->appendRow(item);
-            } else {
-                root->appendRow(item);
-            }
-            bnew = true;
-        }
-        root = item;
+        bool isNew = false;
+        node = m_model->addChild(node,word,&isNew);
+        bnew |= isNew;
     }
-    if (item && item->kind().isEmpty()) {
-        item->setKind(kind);
-        item->setInfo(info);
-        item->setTemp(temp);
-        item->setIcon(icon);
+    if (node > 0 && m_model->kind(node).isEmpty()) {
+        m_model->setItem(node,kind,info,icon,temp);
     }
     return bnew;
 }
@@ -333,6 +251,7 @@ void LiteCompleter::completionPrefixChanged(QString prefix)
     }
 
     emit prefixChanged(m_editor->textCursor(),prefix);
+    updateCompletion(prefix);
 }
 
 void LiteCompleter::insertCompletion(QModelIndex index)
@@ -346,29 +265,23 @@ void LiteCompleter::insertCompletion(QModelIndex index)
         return;
     }
 
-    QString text = index.data(WordItem::NameRole).toString();
-    QString kind = index.data(WordItem::KindRole).toString();
-    QString info = index.data(WordItem::InfoRole).toString();
+    QString text = index.data(CompleterModel::NameRole).toString();
+    QString kind = index.data(CompleterModel::KindRole).toString();
+    QString info = index.data(CompleterModel::InfoRole).toString();
     QString prefix = m_completer->completionPrefix();
     //IsAbs r.URL.
-    int pos = prefix.lastIndexOf(m_completer->separator());
+    int pos = prefix.lastIndexOf(m_separator);
     int length = prefix.length();
     if (pos != -1) {
-        length = prefix.length()-pos-1;
+        length = prefix.length()-pos-m_separator.length();
     }
+    //the typed text may be a fuzzy abbreviation, replace it
     QString extra = text;
-    QString wordText = text;
+    QString wordText = prefix.left(prefix.length()-length)+text;
     QTextCursor tc = m_editor->textCursor();
     tc.beginEditBlock();
-    if (m_completer->caseSensitivity() == Qt::CaseSensitive) {
-        extra = text.right(text.length()-length);
-        wordText = prefix+extra;
-    } else {
-        while (length--) {
-            tc.deletePreviousChar();
-        }
-        extra = text;
-        wordText = text;
+    while (length--) {
+        tc.deletePreviousChar();
     }
     if (kind == "func" && tc.block().text().at(tc.positionInBlock()) != '(') {
         extra += "()";
@@ -381,5 +294,6 @@ void LiteCompleter::insertCompletion(QModelIndex index)
     }
     tc.endEditBlock();
     m_editor->setTextCursor(tc);
-    emit wordCompleted(wordText,index.data(WordItem::InfoRole).toString());
+    m_engine->addRecent(text);
+    emit wordCompleted(wordText,info);
 }
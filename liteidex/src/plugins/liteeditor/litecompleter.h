@@ -31,7 +31,9 @@
 class QCompleter;
 class QPlainTextEdit;
 class TreeModelCompleter;
-class QStandardItemModel;
+class CompleterModel;
+class CompletionListModel;
+class CompletionEngine;
 
 class LiteCompleter : public LiteApi::ICompleter
 {
@@ -41,9 +43,14 @@ public:
     virtual ~LiteCompleter();
     void setEditor(QPlainTextEdit *editor);
     virtual QCompleter *completer() const;
-    virtual QStandardItem *findRoot(const QString &name);
-    virtual void clearChildItem(QStandardItem *root);
-    virtual void appendChildItem(QStandardItem *root,QString name,const QString &kind, const QString &info,const QIcon &icon, bool temp);
+    void setCaseSensitivity(Qt::CaseSensitivity cs);
+    void setSeparator(const QString &separator);
+    QString separator() const;
+    void beginBatch();
+    void endBatch();
+    virtual QModelIndex findRoot(const QString &name);
+    virtual void clearChildItem(const QModelIndex &root);
+    virtual void appendChildItem(const QModelIndex &root,QString name,const QString &kind, const QString &info,const QIcon &icon, bool temp);
     virtual bool appendItem(const QString &name,const QIcon &icon, bool temp);
     virtual bool appendItemEx(const QString &name,const QString &kind, const QString &info,const QIcon &icon, bool temp);
     virtual void appendItems(QStringList nameList,const QString &kind, const QString &info,const QIcon &icon, bool temp);
@@ -54,9 +61,16 @@ public:
 public slots:
     virtual void completionPrefixChanged(QString);
     virtual void insertCompletion(QModelIndex);
+protected slots:
+    void clearResult();
+protected:
+    void updateCompletion(const QString &prefix);
 protected:
     TreeModelCompleter *m_completer;
-    QStandardItemModel *m_model;
+    CompleterModel *m_model;
+    CompletionListModel *m_listModel;
+    CompletionEngine *m_engine;
+    QString         m_separator;
     QPlainTextEdit *m_editor;
     QChar           m_stop;
 };
@@ -27,6 +27,7 @@
 #include "litecompleter.h"
 #include "liteeditor_global.h"
 #include "colorstyle/colorstyle.h"
+#include "textsnapshot/textsnapshot.h"
 #include "qtc_texteditor/generichighlighter/highlighter.h"
 
 #include <QFileInfo>
@@ -590,20 +591,18 @@ int LiteEditor::column() const
 int LiteEditor::utf8Position() const
 {
     QTextCursor cur = m_editorWidget->textCursor();
-    QString src = cur.document()->toPlainText().left(cur.position());
     int offset = 0;
 //    if (m_file->m_lineTerminatorMode == LiteEditorFile::CRLFLineTerminator) {
 //       offset = cur.blockNumber();
 //    }
-    return src.toUtf8().length()+offset+1;
+    return Utf8Snapshot::attach(cur.document())->byteOffset(cur.position())+offset+1;
 }
 
 QByteArray LiteEditor::utf8Data() const {
-    QString src = m_editorWidget->document()->toPlainText();
 //    if (m_file->m_lineTerminatorMode == LiteEditorFile::CRLFLineTerminator) {
 //        src = src.replace("\n","\r\n");
 //    }
-    return src.toUtf8();
+    return Utf8Snapshot::attach(m_editorWidget->document())->data();
 }
 
 void LiteEditor::gotoLine(int line, int column, bool center)
@@ -648,7 +647,7 @@ void LiteEditor::applyOption(QString id)
     m_editorWidget->setDefaultWordWrap(defaultWordWrap);
 
     if (m_completer) {
-        m_completer->completer()->setCaseSensitivity(caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+        m_completer->setCaseSensitivity(caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
     }
 
 #if defined(Q_OS_WIN)
@@ -9,7 +9,9 @@ include (../../utils/extension/extension.pri)
 include (../../utils/mimetype/mimetype.pri)
 include (../../utils/wordapi/wordapi.pri)
 include (../../utils/colorstyle/colorstyle.pri)
+include (../../utils/textsnapshot/textsnapshot.pri)
 include (../../3rdparty/qtc_texteditor/qtc_texteditor.pri)
+include (../../utils/fileutil/fileutil.pri)
 include (../../3rdparty/treemodelcompleter/treemodelcompleter.pri)
 include (../../3rdparty/elidedlabel/elidedlabel.pri)
 
@@ -26,6 +28,9 @@ SOURCES += liteeditorplugin.cpp \
     liteeditorwidget.cpp \
     litecompleter.cpp \
     litewordcompleter.cpp \
+    completermodel.cpp \
+    completionengine.cpp \
+    documentwordindex.cpp \
     wordapimanager.cpp \
     liteeditormark.cpp \
     snippet.cpp \
@@ -43,6 +48,9 @@ HEADERS += liteeditorplugin.h\
     liteeditorwidget.h \
     litecompleter.h \
     litewordcompleter.h \
+    completermodel.h \
+    completionengine.h \
+    documentwordindex.h \
     wordapimanager.h \
     liteeditormark.h \
     snippet.h \
@@ -48,11 +48,13 @@ LiteEditorFileFactory::LiteEditorFileFactory(LiteApi::IApplication *app, QObject
     : LiteApi::IEditorFactory(parent),
       m_liteApp(app)
 {
+    m_kate = new KateHighlighter(this);
     m_mimeTypes.append("text/x-gosrc");
     m_mimeTypes.append("text/x-lua");
     m_mimeTypes.append("liteide/default.editor");
     QDir dir(m_liteApp->resourcePath()+"/liteeditor/kate");
     if (dir.exists()) {
+        m_kate->setCacheFile(QFileInfo(m_liteApp->storagePath(),"kate.cache").filePath());
         m_kate->loadPath(dir.absolutePath());
         foreach (QString type, m_kate->mimeTypes()) {
             if (!m_liteApp->mimeTypeManager()->findMimeType(type)) {
@@ -140,6 +142,8 @@ LiteApi::IEditor *LiteEditorFileFactory::setupEditor(LiteEditor *editor, const Q
     TextEditor::SyntaxHighlighter *h = m_kate->create(doc,mimeType);
     if (h) {
         editor->extension()->addObject("TextEditor::SyntaxHighlighter",h);
+        h->setViewportEditor(editor->editorWidget());
+        h->setAsyncHighlight(true);
         connect(editor,SIGNAL(colorStyleChanged()),this,SLOT(colorStyleChanged()));
         connect(editor,SIGNAL(tabSettingChanged(int)),this,SLOT(tabSettingChanged(int)));
         connect(h,SIGNAL(foldIndentChanged(QTextBlock)),editor->editorWidget(),SLOT(foldIndentChanged(QTextBlock)));
@@ -153,6 +157,7 @@ LiteApi::IEditor *LiteEditorFileFactory::setupEditor(LiteEditor *editor, const Q
             QIcon icon("icon:liteeditor/images/keyword.png");
             QIcon exp("icon:liteeditor/images/findword.png");
             QIcon func("icon:liteeditor/images/func.png");
+            wordCompleter->beginBatch();
             foreach(QString item, wordApi->wordList()) {
                 int pos = item.indexOf("(");
                 if (pos != -1) {
@@ -162,7 +167,7 @@ LiteApi::IEditor *LiteEditorFileFactory::setupEditor(LiteEditor *editor, const Q
                 }
             }
             wordCompleter->appendItems(wordApi->expList(),"","",exp,false);
-            wordCompleter->completer()->model()->sort(0);
+            wordCompleter->endBatch();
         }
     }
     editor->applyOption(OPTION_LITEEDITOR);
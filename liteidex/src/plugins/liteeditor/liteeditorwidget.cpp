@@ -198,6 +198,8 @@ void LiteEditorWidget::keyPressEvent(QKeyEvent *e)
                 + m_completer->popup()->verticalScrollBar()->sizeHint().width());
 
     m_completer->complete(cr); // popup it up!
+    //keep the best ranked item current, complete() selects by prefix
+    m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
 }
 
 static void convertToPlainText(QString &txt)
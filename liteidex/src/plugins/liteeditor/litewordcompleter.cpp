@@ -22,12 +22,8 @@
 // Creator: visualfc <visualfc@gmail.com>
 
 #include "litewordcompleter.h"
-#include "treemodelcompleter/treemodelcompleter.h"
+#include "documentwordindex.h"
 #include <QPlainTextEdit>
-#include <QStandardItem>
-#include <QStandardItemModel>
-#include <QTextCursor>
-#include <QTextBlock>
 #include <QTextDocument>
 #include <QDebug>
 //lite_memory_check_begin
@@ -43,9 +39,10 @@
 
 LiteWordCompleter::LiteWordCompleter(QObject *parent) :
     LiteCompleter(parent),
+    m_wordIndex(new DocumentWordIndex(this)),
     m_icon(QIcon("icon:liteeditor/images/findword.png"))
 {
-    m_completer->setSeparator(".");
+    setSeparator(".");
     m_bSearchSeparator = true;
 }
 
@@ -59,20 +56,6 @@ bool LiteWordCompleter::searchSeparator() const
     return m_bSearchSeparator;
 }
 
-QString LiteWordCompleter::textUnderCursor(QTextCursor tc) const
-{
-    QString text = tc.block().text().left(tc.positionInBlock());
-    if (text.isEmpty()) {
-        return QString();
-    }
-    static QRegExp reg("[a-zA-Z_]+[a-zA-Z0-9_\\.@]*$");
-    int index = reg.indexIn(text);
-    if (index < 0) {
-        return QString();
-    }
-    return text.right(reg.matchedLength());
-}
-
 void LiteWordCompleter::completionPrefixChanged(QString prefix)
 {
     LiteCompleter::completionPrefixChanged(prefix);
@@ -86,24 +69,20 @@ void LiteWordCompleter::completionPrefixChanged(QString prefix)
         }
     }
 
-    QTextCursor tc = m_editor->textCursor();
-    int startPosition = tc.position() - prefix.size();
-    tc.movePosition(QTextCursor::Start, QTextCursor::MoveAnchor);
-
-    QTextDocument::FindFlags flags = QTextDocument::FindCaseSensitively;
-    while (1) {
-        tc = tc.document()->find(prefix, tc.position(), flags);
-        if (tc.isNull())
-            break;
-        QTextCursor sel = tc;
-        sel.select(QTextCursor::WordUnderCursor);
-        QString found = textUnderCursor(sel);
-        if (found.startsWith(prefix)
-                && !m_wordSet.contains(found)
-                && tc.anchor() != startPosition) {
-            m_wordSet.insert(found);
-            appendItem(found,m_icon,true);
+    //the index follows the document edits, the typed word itself is
+    //skipped unless it also appears somewhere else
+    m_wordIndex->setDocument(m_editor->document());
+    bool added = false;
+    foreach (QString word, m_wordIndex->find(prefix)) {
+        if (word == prefix && m_wordIndex->count(word) <= 1) {
+            continue;
         }
-        tc.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor);
+        if (!m_wordSet.contains(word)) {
+            m_wordSet.insert(word);
+            added |= appendItem(word,m_icon,true);
+        }
+    }
+    if (added) {
+        updateCompletion(prefix);
     }
 }
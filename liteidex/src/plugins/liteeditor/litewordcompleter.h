@@ -27,11 +27,8 @@
 #include "litecompleter.h"
 #include <QHash>
 #include <QSet>
-#include <QRegExp>
 
-class QStandardItemModel;
-class QStandardItem;
-class QTextCursor;
+class DocumentWordIndex;
 class LiteWordCompleter : public LiteCompleter
 {
     Q_OBJECT
@@ -42,7 +39,7 @@ public:
 public slots:
     virtual void completionPrefixChanged(QString);
 protected:
-    virtual QString textUnderCursor(QTextCursor tc) const;
+    DocumentWordIndex *m_wordIndex;
     QSet<QString>   m_wordSet;
     QIcon           m_icon;
     bool            m_bSearchSeparator;
@@ -22,6 +22,7 @@
 // Creator: visualfc <visualfc@gmail.com>
 
 #include "filesearch.h"
+#include "fileutil/fileutil.h"
 #include <QFile>
 #include <QTableWidget>
 #include <QTextStream>
@@ -35,13 +36,20 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QDir>
+#include <QMutexLocker>
 #include <QTextBlock>
 #include <QTextCursor>
 #include <QPlainTextEdit>
+#include <QListView>
+#include <QTemporaryFile>
+#include <QMessageBox>
 #include <QTextBrowser>
 #include <QFileDialog>
 #include <QAction>
+#include <QTimer>
 #include <QDebug>
+#include <string.h>
+#include <limits.h>
 //lite_memory_check_begin
 #if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
      #define _CRTDBG_MAP_ALLOC
@@ -52,50 +60,98 @@
 #endif
 //lite_memory_check_end
 
+//results are queued to the gui thread in chunks, one event per hit
+//would flood the event loop on common words
+static const int FlushResultCount = 512;
+static const int FlushResultInterval = 100;
 
 FindThread::FindThread(QObject *parent) :
     QThread(parent),
     useRegExp(true),
     matchWord(true),
     matchCase(true),
-    findSub(true)
+    findSub(true),
+    indexCache(0),
+    replaceMode(false),
+    dryRun(false),
+    finding(false),
+    m_engine(this)
 {
     qRegisterMetaType<FileSearchResult>("FileSearchResult");
+    qRegisterMetaType<FileSearchResultList>("FileSearchResultList");
+    //the last hits before a quiet stretch are flushed from the gui thread
+    m_flushPendingTimer = new QTimer(this);
+    m_flushPendingTimer->setInterval(FlushResultInterval);
+    connect(m_flushPendingTimer,SIGNAL(timeout()),this,SLOT(flushPending()));
+    connect(this,SIGNAL(started()),m_flushPendingTimer,SLOT(start()));
+    connect(this,SIGNAL(finished()),m_flushPendingTimer,SLOT(stop()));
 }
 
-void FindThread::findDir(const QRegExp &reg, const QString &path)
+void FindThread::processFile(int worker, const QString &fileName)
 {
-    QDir dir(path);
-    if (!dir.exists()) {
+    QList<FileSearchResult> results;
+    bool replaced = false;
+    if (replaceMode) {
+        replaced = replaceFile(m_regList.at(worker),fileName,results);
+    } else {
+        findFile(m_regList.at(worker),fileName,results);
+    }
+    if (results.isEmpty()) {
         return;
     }
+    //keep results of one file together and in line order
+    QMutexLocker locker(&m_resultMutex);
+    if (replaced) {
+        m_replacedFiles.append(fileName);
+    }
+    m_pendingResults.append(results);
+    if (m_pendingResults.size() >= FlushResultCount ||
+            m_flushTimer.hasExpired(FlushResultInterval)) {
+        flushResults();
+    }
+}
 
-    foreach(QFileInfo info, dir.entryInfoList(nameFilter,QDir::Files|QDir::NoSymLinks)) {
-        findFile(reg,info.filePath());
-        if (!finding) {
+void FindThread::flushPending()
+{
+    FileSearchResultList results;
+    {
+        QMutexLocker locker(&m_resultMutex);
+        if (!finding || !m_flushTimer.hasExpired(FlushResultInterval)) {
             return;
         }
+        results.swap(m_pendingResults);
+        m_flushTimer.start();
     }
-    if (findSub) {
-        foreach(QFileInfo info, dir.entryInfoList(QDir::Dirs|QDir::NoDotAndDotDot)) {
-            findDir(reg,info.filePath());
-            if(!finding) {
-                return;
-            }
-        }
+    if (!results.isEmpty()) {
+        emit findResult(results);
     }
-
-
 }
 
-void FindThread::findFile(const QRegExp &reg, const QString &fileName)
+void FindThread::flushResults()
 {
-    QList<FileSearchResult> results;
+    if (!m_pendingResults.isEmpty()) {
+        emit findResult(m_pendingResults);
+        m_pendingResults.clear();
+    }
+    m_flushTimer.start();
+}
 
+void FindThread::findFile(const QRegExp &reg, const QString &fileName, QList<FileSearchResult> &results)
+{
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly)) {
         return;
     }
+    qint64 size = file.size();
+    uchar *data = 0;
+    if (size > 0 && size < INT_MAX) {
+        data = file.map(0,size);
+    }
+    if (data) {
+        findData(reg,fileName,(const char*)data,int(size),results);
+        file.unmap(data);
+        return;
+    }
 
     QTextStream stream(&file);
     stream.setCodec("utf-8");
@@ -105,17 +161,8 @@ void FindThread::findFile(const QRegExp &reg, const QString &fileName)
         line = stream.readLine();
         int pos = reg.indexIn(line);
         if (pos >= 0) {
-            emit findResult(FileSearchResult(fileName, lineNr, line));
+            results.append(FileSearchResult(fileName, lineNr, line, pos));
         }
-        /*
-        int pos = 0;
-        while ((pos = reg.indexIn(line, pos)) != -1) {
-            emit findResult(FileSearchResult(fileName, lineNr, line,
-                                          pos, reg.matchedLength(),
-                                          reg.capturedTexts()));
-            pos += reg.matchedLength();
-        }
-        */
         lineNr++;
         if (!finding) {
             break;
@@ -123,13 +170,200 @@ void FindThread::findFile(const QRegExp &reg, const QString &fileName)
     }
 }
 
+static int countLines(const char *data, int size)
+{
+    int count = 0;
+    const char *end = data+size;
+    while (data < end) {
+        data = (const char*)memchr(data,'\n',end-data);
+        if (!data) {
+            break;
+        }
+        count++;
+        data++;
+    }
+    return count;
+}
+
+void FindThread::findData(const QRegExp &reg, const QString &fileName, const char *data, int size, QList<FileSearchResult> &results)
+{
+    //binary files have a nul byte near the head
+    if (memchr(data,0,qMin(size,8192))) {
+        return;
+    }
+    int lineNr = 1;
+    int counted = 0;
+    int pos = 0;
+    while (pos < size && finding) {
+        int lineStart = pos;
+        if (!m_finder.isEmpty()) {
+            //only lines with the required literal are decoded
+            int hit = m_finder.indexIn(data,size,pos);
+            if (hit < 0) {
+                break;
+            }
+            lineStart = hit;
+            while (lineStart > pos && data[lineStart-1] != '\n') {
+                lineStart--;
+            }
+        }
+        const char *nl = (const char*)memchr(data+lineStart,'\n',size-lineStart);
+        int lineEnd = nl ? int(nl-data) : size;
+        lineNr += countLines(data+counted,lineStart-counted);
+        counted = lineStart;
+        const char *p = data+lineStart;
+        int len = lineEnd-lineStart;
+        if (len > 0 && p[len-1] == '\r') {
+            len--;
+        }
+        if (lineStart == 0 && len >= 3 && memcmp(p,"\xEF\xBB\xBF",3) == 0) {
+            p += 3;
+            len -= 3;
+        }
+        QString line = QString::fromUtf8(p,len);
+        int matchStart = reg.indexIn(line);
+        if (matchStart >= 0) {
+            results.append(FileSearchResult(fileName, lineNr, line, matchStart));
+        }
+        pos = lineEnd+1;
+    }
+}
+
+
+// editor paths and walked paths may differ in separators, dots or case
+static QString skipFileKey(const QString &fileName)
+{
+    QString key = QDir::cleanPath(QDir::fromNativeSeparators(fileName));
+#ifdef Q_OS_WIN
+    key = key.toLower();
+#endif
+    return key;
+}
+
+// stream the file through the replacement, untouched bytes are copied
+// as is and the result replaces the file by rename. return true if the
+// file was written.
+bool FindThread::replaceFile(const QRegExp &reg, const QString &fileName, QList<FileSearchResult> &results)
+{
+    if (!skipFiles.isEmpty() && skipFiles.contains(skipFileKey(fileName))) {
+        return false;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    qint64 fileSize = file.size();
+    if (fileSize <= 0 || fileSize >= INT_MAX) {
+        return false;
+    }
+    QByteArray buffer;
+    uchar *map = file.map(0,fileSize);
+    const char *data = (const char*)map;
+    if (!data) {
+        buffer = file.readAll();
+        data = buffer.constData();
+    }
+    int size = int(fileSize);
+    if (memchr(data,0,qMin(size,8192)) ||
+            (!m_finder.isEmpty() && m_finder.indexIn(data,size) < 0)) {
+        if (map) {
+            file.unmap(map);
+        }
+        return false;
+    }
+
+    QTemporaryFile out(fileName+".XXXXXX");
+    bool writing = false;
+    bool failed = false;
+    int written = 0;
+    int lineNr = 1;
+    int counted = 0;
+    int pos = 0;
+    while (pos < size && finding) {
+        int lineStart = pos;
+        if (!m_finder.isEmpty()) {
+            int hit = m_finder.indexIn(data,size,pos);
+            if (hit < 0) {
+                break;
+            }
+            lineStart = hit;
+            while (lineStart > pos && data[lineStart-1] != '\n') {
+                lineStart--;
+            }
+        }
+        const char *nl = (const char*)memchr(data+lineStart,'\n',size-lineStart);
+        int lineEnd = nl ? int(nl-data) : size;
+        lineNr += countLines(data+counted,lineStart-counted);
+        counted = lineStart;
+        int start = lineStart;
+        int end = lineEnd;
+        if (end > start && data[end-1] == '\r') {
+            end--;
+        }
+        if (start == 0 && end >= 3 && memcmp(data,"\xEF\xBB\xBF",3) == 0) {
+            start += 3;
+        }
+        pos = lineEnd+1;
+        QString line = QString::fromUtf8(data+start,end-start);
+        int matchStart = reg.indexIn(line);
+        if (matchStart < 0) {
+            continue;
+        }
+        QString text = line;
+        text.replace(reg,replaceText);
+        if (text == line) {
+            continue;
+        }
+        results.append(FileSearchResult(fileName,lineNr,text,matchStart));
+        if (dryRun) {
+            continue;
+        }
+        if (!writing) {
+            if (!out.open()) {
+                failed = true;
+                break;
+            }
+            writing = true;
+        }
+        QByteArray bytes = text.toUtf8();
+        if (out.write(data+written,start-written) != start-written ||
+                out.write(bytes) != bytes.size()) {
+            failed = true;
+            break;
+        }
+        written = end;
+    }
+    if (writing && !failed && finding) {
+        failed = out.write(data+written,size-written) != size-written;
+    }
+    if (map) {
+        file.unmap(map);
+    }
+    file.close();
+    if (!writing) {
+        return false;
+    }
+    if (failed || !finding) {
+        results.clear();
+        return false;
+    }
+    out.close();
+    QFile::setPermissions(out.fileName(),QFile::permissions(fileName));
+    if (!FileUtil::renameOver(out.fileName(),fileName)) {
+        results.clear();
+        return false;
+    }
+    out.setAutoRemove(false);
+    return true;
+}
 
 void FindThread::stop()
 {
     finding = false;
+    m_engine.cancel();
     if (this->isRunning()) {
-        if (!this->wait(200))
-            this->terminate();
+        //workers check the cancel flag per line, wait them out instead of terminate
+        this->wait();
     }
 }
 
@@ -138,49 +372,168 @@ void FindThread::run()
     finding = true;
     QRegExp reg;
     if (matchWord) {
-        reg.setPattern(QString::fromLatin1("\\b%1\\b").arg(findText));
+        //word boundaries need regexp syntax, escape a fixed string instead
+        QString text = useRegExp ? findText : QRegExp::escape(findText);
+        reg.setPattern(QString::fromLatin1("\\b%1\\b").arg(text));
     } else {
         reg.setPattern(findText);
     }
     reg.setCaseSensitivity(matchCase ? Qt::CaseSensitive : Qt::CaseInsensitive);
-    if (!useRegExp) {
+    if (!useRegExp && !matchWord) {
         reg.setPatternSyntax(QRegExp::FixedString);
     }
-    findDir(reg,findPath);
+    QString literal;
+    foreach (QString text, TrigramIndex::requiredLiterals(findText,useRegExp)) {
+        if (text.size() > literal.size()) {
+            literal = text;
+        }
+    }
+    m_finder.setPattern(literal.toUtf8(),matchCase);
+    //QRegExp keeps match state, every worker gets its own copy
+    m_regList.fill(reg,m_engine.threadCount());
+    m_resultMutex.lock();
+    m_pendingResults.clear();
+    m_replacedFiles.clear();
+    m_flushTimer.start();
+    m_resultMutex.unlock();
+    if (indexCache) {
+        TrigramIndex *index = indexCache->index(QDir::cleanPath(findPath));
+        if (updateIndex(index)) {
+            QStringList literals = TrigramIndex::requiredLiterals(findText,useRegExp);
+            m_engine.run(index->candidates(literals,matchCase,nameFilter,findSub));
+            indexCache->save(index);
+        }
+    } else {
+        m_engine.setNameFilter(nameFilter);
+        m_engine.setFindSub(findSub);
+        m_engine.run(findPath);
+    }
+    m_resultMutex.lock();
+    flushResults();
+    m_resultMutex.unlock();
+    if (!m_replacedFiles.isEmpty()) {
+        emit replacedFiles(m_replacedFiles);
+    }
+    m_regList.clear();
     finding = false;
 }
 
-ResultTextEdit::ResultTextEdit(QWidget *parent) :
-    QPlainTextEdit(parent)
+bool FindThread::updateIndex(TrigramIndex *index)
 {
-    this->setWordWrapMode(QTextOption::NoWrap);
-
-    connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(slotCursorPositionChanged()));
+    if (!index->needVerify(nameFilter)) {
+        index->updateDirty();
+        return true;
+    }
+    //stat every file the search can match, reindex the ones whose mtime or size changed
+    int generation = index->beginVerify(nameFilter);
+    TrigramIndexUpdater updater(index,generation);
+    m_engine.setHandler(&updater);
+    m_engine.setNameFilter(nameFilter);
+    m_engine.setFindSub(true);
+    m_engine.run(index->root());
+    m_engine.setHandler(this);
+    if (!finding) {
+        return false;
+    }
+    index->endVerify(generation,nameFilter);
+    return true;
 }
 
-void ResultTextEdit::slotCursorPositionChanged()
+FileSearchModel::FileSearchModel(QObject *parent) :
+    QAbstractListModel(parent), m_dropped(0)
 {
-    QList<QTextEdit::ExtraSelection> extraSelections;
+}
 
-    QTextEdit::ExtraSelection selection;
+int FileSearchModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_hits.size();
+}
 
-    QColor lineColor = QColor(180,200,200,128);
+QVariant FileSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_hits.size()) {
+        return QVariant();
+    }
+    const Hit &hit = m_hits.at(index.row());
+    if (role == Qt::DisplayRole) {
+        return QString("%1:%2:%3").arg(m_files.at(hit.file)).arg(hit.line)
+                .arg(m_chunks.at(hit.chunk).mid(hit.offset,hit.length));
+    } else if (role == Qt::ToolTipRole) {
+        return m_files.at(hit.file);
+    }
+    return QVariant();
+}
 
-    selection.format.setBackground(lineColor);
-    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-    selection.cursor = textCursor();
-    selection.cursor.clearSelection();
-    extraSelections.append(selection);
+void FileSearchModel::clear()
+{
+    beginResetModel();
+    m_hits.clear();
+    m_files.clear();
+    m_fileMap.clear();
+    m_chunks.clear();
+    m_dropped = 0;
+    endResetModel();
+}
 
-    setExtraSelections(extraSelections);
+void FileSearchModel::appendResults(const FileSearchResultList &results)
+{
+    static const int ChunkSize = 60000;
+    static const int MaxPreview = 128;
+    int count = qMin(results.size(),int(MaxHits)-m_hits.size());
+    m_dropped += results.size()-qMax(count,0);
+    if (count <= 0) {
+        return;
+    }
+    beginInsertRows(QModelIndex(),m_hits.size(),m_hits.size()+count-1);
+    for (int i = 0; i < count; i++) {
+        const FileSearchResult &result = results.at(i);
+        //long lines keep a window around the match
+        const QString &line = result.matchingLine;
+        int start = qMax(0,qMin(result.matchStart-MaxPreview/2,line.length()-MaxPreview));
+        QString text = line.mid(start,MaxPreview);
+        if (start > 0) {
+            text.prepend("...");
+        }
+        if (start+MaxPreview < line.length()) {
+            text.append("...");
+        }
+        for (int j = 0; j < text.length(); j++) {
+            if (!text[j].isPrint() && !text[j].isSpace()) {
+                text[j] = '.';
+            }
+        }
+        if (m_chunks.isEmpty() || m_chunks.last().size()+text.size() > ChunkSize) {
+            m_chunks.append(QString());
+            m_chunks.last().reserve(ChunkSize);
+        }
+        Hit hit;
+        hit.file = m_fileMap.value(result.fileName,-1);
+        if (hit.file < 0) {
+            hit.file = m_files.size();
+            m_files.append(result.fileName);
+            m_fileMap.insert(result.fileName,hit.file);
+        }
+        hit.line = result.lineNumber;
+        hit.chunk = m_chunks.size()-1;
+        hit.offset = m_chunks.last().size();
+        hit.length = text.size();
+        m_chunks.last().append(text);
+        m_hits.append(hit);
+    }
+    endInsertRows();
 }
 
-void ResultTextEdit::mouseDoubleClickEvent(QMouseEvent *e)
+QString FileSearchModel::fileName(int row) const
 {
-    QTextCursor cur = cursorForPosition(e->pos());
-    cur.select(QTextCursor::LineUnderCursor);
+    return m_files.at(m_hits.at(row).file);
+}
 
-    emit dbclickEvent(cur);
+int FileSearchModel::lineNumber(int row) const
+{
+    return m_hits.at(row).line;
 }
 
 FileSearch::FileSearch(LiteApi::IApplication *app, QObject *parent) :
@@ -188,6 +541,7 @@ FileSearch::FileSearch(LiteApi::IApplication *app, QObject *parent) :
     m_liteApp(app)
 {
     m_thread = new FindThread;
+    m_indexCache = new TrigramIndexCache(m_liteApp->storagePath()+"/findindex");
 
     m_tab = new QTabWidget;
 
@@ -205,10 +559,12 @@ FileSearch::FileSearch(LiteApi::IApplication *app, QObject *parent) :
     m_matchCaseCheckBox = new QCheckBox(tr("Match case"));
     m_useRegexCheckBox = new QCheckBox(tr("Regular expression"));
     m_findSubCheckBox = new QCheckBox(tr("Scan subdirectories"));
+    m_useIndexCheckBox = new QCheckBox(tr("Use file index"));
     optLayout->addWidget(m_matchWordCheckBox);
     optLayout->addWidget(m_matchCaseCheckBox);
     optLayout->addWidget(m_useRegexCheckBox);
     optLayout->addWidget(m_findSubCheckBox);
+    optLayout->addWidget(m_useIndexCheckBox);
     optLayout->addStretch();
 
     QHBoxLayout *findLayout = new QHBoxLayout;
@@ -253,13 +609,39 @@ FileSearch::FileSearch(LiteApi::IApplication *app, QObject *parent) :
     topLayout->addWidget(new QLabel(tr("Filter:")),3,0);
     topLayout->addWidget(m_filterCombo,3,1);
 
+    QHBoxLayout *replaceLayout = new QHBoxLayout;
+    m_replaceCombo = new QComboBox;
+    m_replaceCombo->setEditable(true);
+    m_replaceCombo->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Preferred);
+    m_previewCheckBox = new QCheckBox(tr("Preview only"));
+    m_replaceButton = new QPushButton(tr("Replace"));
+    replaceLayout->addWidget(m_replaceCombo);
+    replaceLayout->addWidget(m_previewCheckBox);
+    replaceLayout->addWidget(m_replaceButton);
+
+    topLayout->addWidget(new QLabel(tr("Replace with:")),4,0);
+    topLayout->addLayout(replaceLayout,4,1);
+
     m_findWidget->setLayout(topLayout);
 
-    m_resultOutput = new ResultTextEdit;
-    m_resultOutput->setReadOnly(true);
+    m_resultModel = new FileSearchModel(this);
+    m_resultLabel = new QLabel;
+    m_resultView = new QListView;
+    m_resultView->setModel(m_resultModel);
+    m_resultView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_resultView->setUniformItemSizes(true);
+    m_resultView->setLayoutMode(QListView::Batched);
+
+    m_resultWidget = new QWidget;
+    QVBoxLayout *resultLayout = new QVBoxLayout;
+    resultLayout->setMargin(0);
+    resultLayout->setSpacing(1);
+    resultLayout->addWidget(m_resultLabel);
+    resultLayout->addWidget(m_resultView);
+    m_resultWidget->setLayout(resultLayout);
 
     m_tab->addTab(m_findWidget,tr("Search"));
-    m_tab->addTab(m_resultOutput,tr("Results"));
+    m_tab->addTab(m_resultWidget,tr("Results"));
 
     QAction *clearAct = new QAction(tr("Clear"),this);
     clearAct->setIcon(QIcon("icon:images/cleanoutput.png"));
@@ -274,18 +656,22 @@ FileSearch::FileSearch(LiteApi::IApplication *app, QObject *parent) :
     m_matchCaseCheckBox->setChecked(m_liteApp->settings()->value("matchCase",false).toBool());
     m_useRegexCheckBox->setChecked(m_liteApp->settings()->value("useRegexp",false).toBool());
     m_findSubCheckBox->setChecked(m_liteApp->settings()->value("findSub",true).toBool());
+    m_useIndexCheckBox->setChecked(m_liteApp->settings()->value("useIndex",true).toBool());
     m_liteApp->settings()->endGroup();
 
     connect(browserBtn,SIGNAL(clicked()),this,SLOT(browser()));
     connect(currentBtn,SIGNAL(clicked()),this,SLOT(currentDir()));
-    connect(clearAct,SIGNAL(triggered()),m_resultOutput,SLOT(clear()));
+    connect(clearAct,SIGNAL(triggered()),this,SLOT(clearResult()));
     connect(m_findButton,SIGNAL(clicked()),this,SLOT(findInFiles()));
+    connect(m_replaceButton,SIGNAL(clicked()),this,SLOT(replaceInFiles()));
+    connect(m_thread,SIGNAL(replacedFiles(QStringList)),this,SLOT(replacedFiles(QStringList)));
     connect(m_stopButton,SIGNAL(clicked()),m_thread,SLOT(stop()));
     connect(m_thread,SIGNAL(started()),this,SLOT(findStarted()));
     connect(m_thread,SIGNAL(finished()),this,SLOT(findFinished()));
-    connect(m_thread,SIGNAL(findResult(FileSearchResult)),this,SLOT(findResult(FileSearchResult)));
-    connect(m_resultOutput,SIGNAL(dbclickEvent(QTextCursor)),this,SLOT(dbclickOutput(QTextCursor)));
+    connect(m_thread,SIGNAL(findResult(FileSearchResultList)),this,SLOT(findResult(FileSearchResultList)));
+    connect(m_resultView,SIGNAL(activated(QModelIndex)),this,SLOT(activatedResult(QModelIndex)));
     connect(m_findCombo->lineEdit(),SIGNAL(returnPressed()),this,SLOT(findInFiles()));
+    connect(m_liteApp->editorManager(),SIGNAL(editorSaved(LiteApi::IEditor*)),this,SLOT(editorSaved(LiteApi::IEditor*)));
 }
 
 FileSearch::~FileSearch()
@@ -295,12 +681,14 @@ FileSearch::~FileSearch()
     m_liteApp->settings()->setValue("matchCase",m_matchCaseCheckBox->isChecked());
     m_liteApp->settings()->setValue("useRegexp",m_useRegexCheckBox->isChecked());
     m_liteApp->settings()->setValue("findSub",m_findSubCheckBox->isChecked());
+    m_liteApp->settings()->setValue("useIndex",m_useIndexCheckBox->isChecked());
     m_liteApp->settings()->endGroup();
 
     if (m_thread) {
         m_thread->stop();
         delete m_thread;
     }
+    delete m_indexCache;
     if (m_tab) {
         delete m_tab;
     }
@@ -345,15 +733,35 @@ void FileSearch::setVisible(bool b)
 }
 
 void FileSearch::findInFiles()
+{
+    startSearch(false);
+}
+
+void FileSearch::replaceInFiles()
+{
+    startSearch(true);
+}
+
+void FileSearch::startSearch(bool replace)
 {
     if (m_thread->isRunning()) {
         m_thread->stop();
     }
     QString text = m_findCombo->currentText();
     QString path = m_findPathCombo->currentText();
+    QString replaceText = m_replaceCombo->currentText();
     if (text.isEmpty() || path.isEmpty()) {
         return;
     }
+    bool dryRun = m_previewCheckBox->isChecked();
+    if (replace && !dryRun) {
+        int ret = QMessageBox::question(m_liteApp->mainWindow(),tr("Replace in Files"),
+                                        QString(tr("Replace all occurrences of '%1' with '%2' in %3?")).arg(text).arg(replaceText).arg(path),
+                                        QMessageBox::Yes|QMessageBox::No);
+        if (ret != QMessageBox::Yes) {
+            return;
+        }
+    }
     m_thread->findPath = path;
     m_thread->findText = text;
     m_thread->useRegExp = m_useRegexCheckBox->isChecked();
@@ -361,9 +769,27 @@ void FileSearch::findInFiles()
     m_thread->matchWord = m_matchWordCheckBox->isChecked();
     m_thread->findSub = m_findSubCheckBox->isChecked();
     m_thread->nameFilter = m_filterCombo->currentText().split(";");
-    m_resultOutput->clear();
-    m_resultOutput->appendPlainText(QString(tr("Searching for '%1'...").arg(m_findCombo->currentText())));
-    m_resultList.clear();
+    m_thread->indexCache = m_useIndexCheckBox->isChecked() ? m_indexCache : 0;
+    m_thread->replaceMode = replace;
+    m_thread->replaceText = replaceText;
+    m_thread->dryRun = dryRun;
+    m_thread->skipFiles.clear();
+    m_skipCount = 0;
+    if (replace && !dryRun) {
+        //never overwrite unsaved editor contents
+        foreach (LiteApi::IEditor *editor, m_liteApp->editorManager()->editorList()) {
+            if (editor->isModified() && !editor->filePath().isEmpty()) {
+                m_thread->skipFiles.insert(skipFileKey(editor->filePath()));
+            }
+        }
+        m_skipCount = m_thread->skipFiles.size();
+    }
+    m_resultModel->clear();
+    if (replace) {
+        m_resultLabel->setText(QString(tr("Replacing '%1' with '%2'...").arg(text).arg(replaceText)));
+    } else {
+        m_resultLabel->setText(QString(tr("Searching for '%1'...").arg(text)));
+    }
     m_thread->start(QThread::LowPriority);
     if (m_findCombo->findText(text) < 0) {
         m_findCombo->addItem(text);
@@ -371,13 +797,17 @@ void FileSearch::findInFiles()
     if (m_findPathCombo->findText(path) < 0) {
         m_findPathCombo->addItem(path);
     }
+    if (replace && m_replaceCombo->findText(replaceText) < 0) {
+        m_replaceCombo->addItem(replaceText);
+    }
 }
 
 void FileSearch::findStarted()
 {
     m_findButton->setEnabled(false);
+    m_replaceButton->setEnabled(false);
     m_stopButton->setEnabled(true);
-    m_tab->setCurrentWidget(m_resultOutput);
+    m_tab->setCurrentWidget(m_resultWidget);
 }
 
 void FileSearch::currentDir()
@@ -400,6 +830,24 @@ void FileSearch::currentDir()
 
 }
 
+void FileSearch::editorSaved(LiteApi::IEditor *editor)
+{
+    if (!editor->filePath().isEmpty()) {
+        m_indexCache->fileChanged(editor->filePath());
+    }
+}
+
+void FileSearch::replacedFiles(const QStringList &files)
+{
+    foreach (QString fileName, files) {
+        m_indexCache->fileChanged(fileName);
+        LiteApi::IEditor *editor = m_liteApp->editorManager()->findEditor(fileName,true);
+        if (editor && !editor->isModified()) {
+            editor->reload();
+        }
+    }
+}
+
 void FileSearch::browser()
 {
     QString dir = QFileDialog::getExistingDirectory(m_liteApp->mainWindow(), tr("Open Directory"),
@@ -413,54 +861,43 @@ void FileSearch::browser()
 void FileSearch::findFinished()
 {
     m_findButton->setEnabled(true);
+    m_replaceButton->setEnabled(true);
     m_stopButton->setEnabled(false);
-    m_resultOutput->appendPlainText(QString(tr("%1 occurrence(s) have been found.").arg(m_resultList.count())));
-}
-
-void FileSearch::findResult(const FileSearchResult &result)
-{
-    QString text = result.matchingLine;
-    int max = text.length();
-    if (max > 128) {
-        max = 128;
-    }
-    for (int i = 0; i < 128; i++) {
-        if (!text[i].isPrint() && !text[i].isSpace()) {
-            text[i] = '.';
+    QString info;
+    if (!m_thread->replaceMode) {
+        info = QString(tr("%1 occurrence(s) have been found.").arg(m_resultModel->totalCount()));
+    } else if (m_thread->dryRun) {
+        info = QString(tr("%1 line(s) would be replaced.").arg(m_resultModel->totalCount()));
+    } else {
+        info = QString(tr("%1 line(s) have been replaced.").arg(m_resultModel->totalCount()));
+        if (m_skipCount > 0) {
+            info += " "+QString(tr("%1 file(s) with unsaved changes were skipped.").arg(m_skipCount));
         }
     }
-    m_resultOutput->appendPlainText(QString("%1:%2:%3").arg(result.fileName).arg(result.lineNumber).arg(text.left(max)));
-    m_resultList.append(result);
+    if (m_resultModel->isTruncated()) {
+        info += " "+QString(tr("Results truncated, only the first %1 are listed.").arg(m_resultModel->rowCount()));
+    }
+    m_resultLabel->setText(info);
 }
 
-void FileSearch::dbclickOutput(const QTextCursor &cur)
+void FileSearch::findResult(const FileSearchResultList &results)
 {
-    int index = cur.blockNumber()-1;
-    if (index < 0 || index >= m_resultList.count()) {
-        return;
-    }
-    QString fileName = m_resultList.at(index).fileName;
-    int line = m_resultList.at(index).lineNumber;
-    /*
-    QRegExp rep("([:-\\w\\d_\\\\/\\.]+):(\\d+):");
-
-    int index = rep.indexIn(cur.block().text());
-    if (index < 0)
-        return;
-    QStringList capList = rep.capturedTexts();
-
-    qDebug() << cur.block().text() << capList;
+    m_resultModel->appendResults(results);
+}
 
-    if (capList.count() < 3)
-        return;
-    QString fileName = capList[1];
-    QString fileLine = capList[2];
+void FileSearch::clearResult()
+{
+    m_resultModel->clear();
+    m_resultLabel->clear();
+}
 
-    bool ok = false;
-    int line = fileLine.toInt(&ok);
-    if (!ok)
+void FileSearch::activatedResult(const QModelIndex &index)
+{
+    if (!index.isValid()) {
         return;
-    */
+    }
+    QString fileName = m_resultModel->fileName(index.row());
+    int line = m_resultModel->lineNumber(index.row());
     LiteApi::IEditor *editor = m_liteApp->fileManager()->openEditor(fileName);
     if (editor) {
         editor->widget()->setFocus();
@@ -27,39 +27,62 @@
 #include "liteapi/liteapi.h"
 #include "textoutput/terminaledit.h"
 #include "textoutput/textoutput.h"
+#include "searchengine.h"
+#include "trigramindex.h"
+#include "literalfinder.h"
 #include <QStringList>
 #include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+
+class QTimer;
 
 class FileSearchResult
 {
 public:
     FileSearchResult() {}
-    FileSearchResult(QString fileName, int lineNumber, QString matchingLine)
+    FileSearchResult(QString fileName, int lineNumber, QString matchingLine, int matchStart = 0)
             : fileName(fileName),
             lineNumber(lineNumber),
-            matchingLine(matchingLine)
+            matchingLine(matchingLine),
+            matchStart(matchStart)
     {
     }
     QString fileName;
     int lineNumber;
     QString matchingLine;
+    int matchStart;
 };
 
+typedef QList<FileSearchResult> FileSearchResultList;
+
 Q_DECLARE_METATYPE(FileSearchResult)
+Q_DECLARE_METATYPE(FileSearchResultList)
 
-class FindThread : public QThread
+class FindThread : public QThread, public SearchHandler
 {
 Q_OBJECT
 public:
     FindThread(QObject *parent = 0);
     virtual void run();
+    virtual void processFile(int worker, const QString &fileName);
 public slots:
     void stop();
+protected slots:
+    void flushPending();
 protected:
-    void findDir(const QRegExp &reg, const QString &path);
-    void findFile(const QRegExp &reg, const QString &fileName);
+    void findFile(const QRegExp &reg, const QString &fileName, QList<FileSearchResult> &results);
+    void findData(const QRegExp &reg, const QString &fileName, const char *data, int size, QList<FileSearchResult> &results);
+    bool replaceFile(const QRegExp &reg, const QString &fileName, QList<FileSearchResult> &results);
+    bool updateIndex(TrigramIndex *index);
+    void flushResults();
 signals:
-    void findResult(const FileSearchResult &result);
+    void findResult(const FileSearchResultList &results);
+    void replacedFiles(const QStringList &files);
 public:
     bool useRegExp;
     bool matchWord;
@@ -68,7 +91,21 @@ public:
     QString findText;
     QString findPath;
     QStringList nameFilter;
+    TrigramIndexCache *indexCache;
+    bool replaceMode;
+    bool dryRun;
+    QString replaceText;
+    QSet<QString> skipFiles;
     volatile bool finding;
+protected:
+    SearchEngine     m_engine;
+    QVector<QRegExp> m_regList;
+    LiteralFinder    m_finder;
+    QMutex           m_resultMutex;
+    FileSearchResultList m_pendingResults;
+    QElapsedTimer    m_flushTimer;
+    QTimer          *m_flushPendingTimer;
+    QStringList      m_replacedFiles;
 };
 
 class QTabWidget;
@@ -76,22 +113,44 @@ class QLineEdit;
 class QComboBox;
 class QCheckBox;
 class QPushButton;
-class QPlainTextEdit;
+class QLabel;
+class QListView;
 
-class ResultTextEdit : public QPlainTextEdit
+// FileSearchModel keeps hits in flat arrays, file names are shared and
+// the preview text is packed into large chunks, the view asks only for
+// the visible rows. hits past MaxHits are counted but not kept.
+class FileSearchModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
-    ResultTextEdit(QWidget *parent = 0);
-signals:
-    void dbclickEvent(const QTextCursor &cur);
-public slots:
-    void slotCursorPositionChanged();
+    FileSearchModel(QObject *parent = 0);
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    void clear();
+    void appendResults(const FileSearchResultList &results);
+    QString fileName(int row) const;
+    int lineNumber(int row) const;
+    int totalCount() const { return m_hits.size()+m_dropped; }
+    bool isTruncated() const { return m_dropped > 0; }
+    enum {
+        MaxHits = 100000
+    };
 protected:
-    virtual void mouseDoubleClickEvent(QMouseEvent *e);
+    struct Hit
+    {
+        int     file;
+        int     line;
+        int     chunk;
+        ushort  offset;
+        ushort  length;
+    };
+    QVector<Hit>        m_hits;
+    QStringList         m_files;
+    QHash<QString,int>  m_fileMap;
+    QVector<QString>    m_chunks;
+    int                 m_dropped;
 };
 
-
 class FileSearch : QObject
 {
     Q_OBJECT
@@ -101,13 +160,18 @@ public:
     void setVisible(bool b);
 public slots:
     void findInFiles();
-    void findResult(const FileSearchResult &result);
+    void replaceInFiles();
+    void findResult(const FileSearchResultList &results);
     void findStarted();
     void findFinished();
-    void dbclickOutput(const QTextCursor &cur);
+    void clearResult();
+    void activatedResult(const QModelIndex &index);
     void browser();
     void currentDir();
+    void editorSaved(LiteApi::IEditor *editor);
+    void replacedFiles(const QStringList &files);
 protected:
+    void startSearch(bool replace);
     LiteApi::IApplication *m_liteApp;
     FindThread *m_thread;
     QAction     *m_outputAct;
@@ -116,14 +180,22 @@ protected:
     QComboBox   *m_findCombo;
     QComboBox   *m_findPathCombo;
     QComboBox   *m_filterCombo;
+    QComboBox   *m_replaceCombo;
     QCheckBox   *m_findSubCheckBox;
     QCheckBox   *m_matchWordCheckBox;
     QCheckBox   *m_matchCaseCheckBox;
     QCheckBox   *m_useRegexCheckBox;
+    QCheckBox   *m_useIndexCheckBox;
+    QCheckBox   *m_previewCheckBox;
     QPushButton *m_findButton;
+    QPushButton *m_replaceButton;
     QPushButton *m_stopButton;
-    ResultTextEdit *m_resultOutput;
-    QList<FileSearchResult> m_resultList;
+    QWidget     *m_resultWidget;
+    QLabel      *m_resultLabel;
+    QListView   *m_resultView;
+    FileSearchModel *m_resultModel;
+    int          m_skipCount;
+    TrigramIndexCache *m_indexCache;
 };
 
 //static QList<FileSearchResult> findInFile(const QString &text, bool useRegExp, bool matchWord, bool matchCase, const QString &fileName);
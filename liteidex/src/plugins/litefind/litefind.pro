@@ -3,14 +3,21 @@ TEMPLATE = lib
 
 include(../../liteideplugin.pri)
 include (../../utils/textoutput/textoutput.pri)
+include (../../utils/fileutil/fileutil.pri)
 
 DEFINES += LITEFIND_LIBRARY
 
 SOURCES += litefindplugin.cpp \
     filesearch.cpp \
+    searchengine.cpp \
+    trigramindex.cpp \
+    literalfinder.cpp \
     findeditor.cpp
 
 HEADERS += litefindplugin.h\
         litefind_global.h \
     filesearch.h \
+    searchengine.h \
+    trigramindex.h \
+    literalfinder.h \
     findeditor.h
@@ -0,0 +1,169 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: literalfinder.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "literalfinder.h"
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LITEFIND_SSE2
+#endif
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+static inline uchar foldByte(uchar c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c+('a'-'A');
+    }
+    return c;
+}
+
+static inline bool isAsciiLetter(uchar c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+#ifdef LITEFIND_SSE2
+static inline int lowestBit(uint v)
+{
+#if defined(Q_CC_GNU)
+    return __builtin_ctz(v);
+#else
+    int n = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// ascii letters compare with the case bit set, other bytes compare exact
+static inline __m128i matchByte(__m128i block, uchar c, bool matchCase)
+{
+    if (!matchCase && isAsciiLetter(c)) {
+        return _mm_cmpeq_epi8(_mm_or_si128(block,_mm_set1_epi8(0x20)),_mm_set1_epi8(char(c|0x20)));
+    }
+    return _mm_cmpeq_epi8(block,_mm_set1_epi8(char(c)));
+}
+#endif
+
+LiteralFinder::LiteralFinder() :
+    m_matchCase(true)
+{
+}
+
+void LiteralFinder::setPattern(const QByteArray &pattern, bool matchCase)
+{
+    m_matchCase = matchCase;
+    m_pattern.clear();
+    if (matchCase) {
+        m_pattern = pattern;
+        return;
+    }
+    for (int i = 0; i < pattern.size(); i++) {
+        if (uchar(pattern.at(i)) >= 0x80) {
+            //unicode case folding changes bytes, no byte level prefilter
+            m_pattern.clear();
+            return;
+        }
+        m_pattern.append(char(foldByte(pattern.at(i))));
+    }
+}
+
+bool LiteralFinder::isEmpty() const
+{
+    return m_pattern.isEmpty();
+}
+
+bool LiteralFinder::verify(const char *p) const
+{
+    if (m_matchCase) {
+        return memcmp(p,m_pattern.constData(),m_pattern.size()) == 0;
+    }
+    const char *s = m_pattern.constData();
+    for (int i = 0; i < m_pattern.size(); i++) {
+        if (foldByte(p[i]) != uchar(s[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int LiteralFinder::scalarIndexIn(const char *data, int size, int from) const
+{
+    int n = m_pattern.size();
+    uchar first = m_pattern.at(0);
+    if (m_matchCase || !isAsciiLetter(first)) {
+        while (from+n <= size) {
+            const char *p = (const char*)memchr(data+from,first,size-n+1-from);
+            if (!p) {
+                return -1;
+            }
+            if (verify(p)) {
+                return p-data;
+            }
+            from = p-data+1;
+        }
+        return -1;
+    }
+    for (; from+n <= size; from++) {
+        if (foldByte(data[from]) == first && verify(data+from)) {
+            return from;
+        }
+    }
+    return -1;
+}
+
+int LiteralFinder::indexIn(const char *data, int size, int from) const
+{
+    int n = m_pattern.size();
+    if (n == 0 || from < 0 || from+n > size) {
+        return -1;
+    }
+#ifdef LITEFIND_SSE2
+    uchar first = m_pattern.at(0);
+    uchar last = m_pattern.at(n-1);
+    for (; from+n-1+16 <= size; from += 16) {
+        __m128i blockFirst = _mm_loadu_si128((const __m128i*)(data+from));
+        __m128i blockLast = _mm_loadu_si128((const __m128i*)(data+from+n-1));
+        uint mask = _mm_movemask_epi8(_mm_and_si128(matchByte(blockFirst,first,m_matchCase),
+                                                    matchByte(blockLast,last,m_matchCase)));
+        while (mask) {
+            int bit = lowestBit(mask);
+            if (verify(data+from+bit)) {
+                return from+bit;
+            }
+            mask &= mask-1;
+        }
+    }
+#endif
+    return scalarIndexIn(data,size,from);
+}
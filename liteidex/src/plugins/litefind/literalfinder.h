@@ -0,0 +1,50 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: literalfinder.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef LITERALFINDER_H
+#define LITERALFINDER_H
+
+#include <QByteArray>
+
+// LiteralFinder searches a byte literal in raw file data. The SSE2 path
+// compares the first and last literal bytes for 16 positions at once and
+// only verifies the candidates, the other targets fall back to memchr.
+// Case insensitive search folds ascii only, literals with other bytes are
+// rejected and the caller must scan without prefilter.
+class LiteralFinder
+{
+public:
+    LiteralFinder();
+    void setPattern(const QByteArray &pattern, bool matchCase);
+    bool isEmpty() const;
+    // offset of the first match at or after from, -1 if none
+    int indexIn(const char *data, int size, int from = 0) const;
+protected:
+    bool verify(const char *p) const;
+    int scalarIndexIn(const char *data, int size, int from) const;
+protected:
+    QByteArray m_pattern;
+    bool       m_matchCase;
+};
+
+#endif // LITERALFINDER_H
@@ -0,0 +1,250 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: searchengine.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "searchengine.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+void SearchQueue::push(const SearchTask &task)
+{
+    QMutexLocker locker(&m_mutex);
+    m_tasks.append(task);
+}
+
+bool SearchQueue::pop(SearchTask &task)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_tasks.isEmpty()) {
+        return false;
+    }
+    task = m_tasks.takeLast();
+    return true;
+}
+
+bool SearchQueue::steal(SearchTask &task)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_tasks.isEmpty()) {
+        return false;
+    }
+    task = m_tasks.takeFirst();
+    return true;
+}
+
+SearchWorker::SearchWorker(SearchEngine *engine, int id) :
+    m_engine(engine),
+    m_id(id)
+{
+}
+
+void SearchWorker::run()
+{
+    m_engine->work(m_id);
+}
+
+SearchEngine::SearchEngine(SearchHandler *handler) :
+    m_handler(handler),
+    m_findSub(true),
+    m_threadCount(QThread::idealThreadCount()),
+    m_pending(0),
+    m_canceled(false)
+{
+    if (m_threadCount < 1) {
+        m_threadCount = 1;
+    }
+}
+
+SearchEngine::~SearchEngine()
+{
+    qDeleteAll(m_queues);
+}
+
+void SearchEngine::setHandler(SearchHandler *handler)
+{
+    m_handler = handler;
+}
+
+void SearchEngine::setNameFilter(const QStringList &filter)
+{
+    m_nameFilter = filter;
+}
+
+void SearchEngine::setFindSub(bool b)
+{
+    m_findSub = b;
+}
+
+void SearchEngine::setThreadCount(int count)
+{
+    m_threadCount = qMax(1,count);
+}
+
+int SearchEngine::threadCount() const
+{
+    return m_threadCount;
+}
+
+void SearchEngine::run(const QString &root)
+{
+    QList<SearchTask> tasks;
+    tasks.append(SearchTask(SearchTask::Dir,root));
+    start(tasks);
+}
+
+void SearchEngine::run(const QStringList &files)
+{
+    QList<SearchTask> tasks;
+    foreach (QString fileName, files) {
+        tasks.append(SearchTask(SearchTask::File,fileName));
+    }
+    start(tasks);
+}
+
+void SearchEngine::cancel()
+{
+    m_canceled = true;
+    m_wait.wakeAll();
+}
+
+bool SearchEngine::isCanceled() const
+{
+    return m_canceled;
+}
+
+void SearchEngine::start(const QList<SearchTask> &tasks)
+{
+    m_canceled = false;
+    m_pending = tasks.size();
+    if (m_pending == 0) {
+        return;
+    }
+
+    qDeleteAll(m_queues);
+    m_queues.clear();
+    for (int i = 0; i < m_threadCount; i++) {
+        m_queues.append(new SearchQueue);
+    }
+    //seed the queues round robin, workers steal the rest
+    for (int i = tasks.size()-1; i >= 0; i--) {
+        m_queues[i%m_threadCount]->push(tasks.at(i));
+    }
+
+    QList<SearchWorker*> workers;
+    for (int i = 0; i < m_threadCount; i++) {
+        SearchWorker *worker = new SearchWorker(this,i);
+        workers.append(worker);
+        worker->start(QThread::LowPriority);
+    }
+    foreach (SearchWorker *worker, workers) {
+        worker->wait();
+    }
+    qDeleteAll(workers);
+    qDeleteAll(m_queues);
+    m_queues.clear();
+}
+
+void SearchEngine::work(int id)
+{
+    SearchTask task;
+    while (!m_canceled) {
+        if (takeTask(id,task)) {
+            if (task.kind == SearchTask::Dir) {
+                processDir(id,task.path);
+            } else {
+                m_handler->processFile(id,task.path);
+            }
+            taskDone();
+            continue;
+        }
+        QMutexLocker locker(&m_mutex);
+        if (m_pending == 0) {
+            break;
+        }
+        //a busy worker may still push new tasks, wake up on push or timeout
+        m_wait.wait(&m_mutex,10);
+    }
+}
+
+bool SearchEngine::takeTask(int id, SearchTask &task)
+{
+    if (m_queues.at(id)->pop(task)) {
+        return true;
+    }
+    int count = m_queues.size();
+    for (int i = 1; i < count; i++) {
+        if (m_queues.at((id+i)%count)->steal(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SearchEngine::pushTask(int id, const SearchTask &task)
+{
+    m_mutex.lock();
+    m_pending++;
+    m_mutex.unlock();
+    m_queues.at(id)->push(task);
+    m_wait.wakeOne();
+}
+
+void SearchEngine::taskDone()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending--;
+    if (m_pending == 0) {
+        m_wait.wakeAll();
+    }
+}
+
+void SearchEngine::processDir(int id, const QString &path)
+{
+    QDir dir(path);
+    if (!dir.exists()) {
+        return;
+    }
+    //push in reverse order, the owner pops from back and sees sorted names
+    if (m_findSub) {
+        QFileInfoList dirs = dir.entryInfoList(QDir::Dirs|QDir::NoDotAndDotDot);
+        for (int i = dirs.size()-1; i >= 0; i--) {
+            pushTask(id,SearchTask(SearchTask::Dir,dirs.at(i).filePath()));
+        }
+    }
+    QFileInfoList files = dir.entryInfoList(m_nameFilter,QDir::Files|QDir::NoSymLinks);
+    for (int i = files.size()-1; i >= 0; i--) {
+        if (m_canceled) {
+            return;
+        }
+        pushTask(id,SearchTask(SearchTask::File,files.at(i).filePath()));
+    }
+}
@@ -0,0 +1,115 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: searchengine.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef SEARCHENGINE_H
+#define SEARCHENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+
+class SearchHandler
+{
+public:
+    virtual ~SearchHandler() {}
+    // called from worker thread, worker is in [0,threadCount)
+    virtual void processFile(int worker, const QString &fileName) = 0;
+};
+
+struct SearchTask
+{
+    enum Kind {
+        Dir,
+        File
+    };
+    SearchTask() : kind(File) {}
+    SearchTask(Kind kind, const QString &path) : kind(kind), path(path) {}
+    Kind    kind;
+    QString path;
+};
+
+class SearchQueue
+{
+public:
+    void push(const SearchTask &task);
+    bool pop(SearchTask &task);
+    bool steal(SearchTask &task);
+protected:
+    QMutex            m_mutex;
+    QList<SearchTask> m_tasks;
+};
+
+class SearchEngine;
+class SearchWorker : public QThread
+{
+public:
+    SearchWorker(SearchEngine *engine, int id);
+    virtual void run();
+protected:
+    SearchEngine *m_engine;
+    int           m_id;
+};
+
+// SearchEngine walks directories and dispatches files to a work-stealing
+// pool. Each worker owns a deque, pops its own tasks from the back and
+// steals from the front of the other workers' deques when it runs dry.
+class SearchEngine
+{
+public:
+    SearchEngine(SearchHandler *handler);
+    ~SearchEngine();
+    void setHandler(SearchHandler *handler);
+    void setNameFilter(const QStringList &filter);
+    void setFindSub(bool b);
+    void setThreadCount(int count);
+    int threadCount() const;
+    // process files list or walk root directory, block until finished or canceled
+    void run(const QString &root);
+    void run(const QStringList &files);
+    void cancel();
+    bool isCanceled() const;
+protected:
+    friend class SearchWorker;
+    void start(const QList<SearchTask> &tasks);
+    void work(int id);
+    bool takeTask(int id, SearchTask &task);
+    void pushTask(int id, const SearchTask &task);
+    void taskDone();
+    void processDir(int id, const QString &path);
+protected:
+    SearchHandler          *m_handler;
+    QStringList             m_nameFilter;
+    bool                    m_findSub;
+    int                     m_threadCount;
+    QVector<SearchQueue*>   m_queues;
+    QMutex                  m_mutex;
+    QWaitCondition          m_wait;
+    int                     m_pending;
+    volatile bool           m_canceled;
+};
+
+#endif // SEARCHENGINE_H
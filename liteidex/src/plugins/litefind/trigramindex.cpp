@@ -0,0 +1,636 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: trigramindex.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "trigramindex.h"
+#include "fileutil/fileutil.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <algorithm>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+static quint32 IndexMarker = 0x4c545249; //LTRI
+static qint32 IndexVersion = 1;
+//files larger than this are not indexed and always scanned
+static qint64 MaxIndexFileSize = 16*1024*1024;
+//walk the tree and check mtime at most once per interval
+static qint64 VerifyInterval = 30*1000;
+
+static inline uchar foldByte(uchar c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c+('a'-'A');
+    }
+    return c;
+}
+
+static inline quint32 makeTrigram(uchar a, uchar b, uchar c)
+{
+    return (quint32(foldByte(a)) << 16) | (quint32(foldByte(b)) << 8) | quint32(foldByte(c));
+}
+
+static void writeVarint(QByteArray &data, quint32 v)
+{
+    while (v >= 0x80) {
+        data.append(char((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    data.append(char(v));
+}
+
+static QByteArray encodePosting(const QVector<int> &ids)
+{
+    QByteArray data;
+    int last = 0;
+    foreach (int id, ids) {
+        writeVarint(data,quint32(id-last));
+        last = id;
+    }
+    return data;
+}
+
+static QVector<int> decodePosting(const QByteArray &data)
+{
+    QVector<int> ids;
+    const uchar *p = (const uchar*)data.constData();
+    const uchar *end = p+data.size();
+    int last = 0;
+    while (p < end) {
+        quint32 v = 0;
+        int shift = 0;
+        while (p < end) {
+            uchar c = *p++;
+            v |= quint32(c & 0x7f) << shift;
+            if (!(c & 0x80)) {
+                break;
+            }
+            shift += 7;
+        }
+        last += int(v);
+        ids.append(last);
+    }
+    return ids;
+}
+
+TrigramIndex::TrigramIndex(const QString &root) :
+    m_root(root),
+    m_generation(0),
+    m_deadCount(0),
+    m_modified(false)
+{
+    m_verifyTimer.invalidate();
+}
+
+QString TrigramIndex::root() const
+{
+    return m_root;
+}
+
+bool TrigramIndex::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 marker;
+    qint32 version;
+    QString root;
+    stream >> marker >> version >> root;
+    if (stream.status() != QDataStream::Ok || marker != IndexMarker ||
+            version != IndexVersion || root != m_root) {
+        return false;
+    }
+    QVector<TrigramFileEntry> files;
+    QHash<quint32,QVector<int> > postings;
+    qint32 count;
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        TrigramFileEntry entry;
+        stream >> entry.path >> entry.mtime >> entry.size >> entry.indexed;
+        files.append(entry);
+    }
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        quint32 trigram;
+        QByteArray data;
+        stream >> trigram >> data;
+        postings.insert(trigram,decodePosting(data));
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_files = files;
+    m_postings = postings;
+    m_pathMap.clear();
+    for (int i = 0; i < m_files.size(); i++) {
+        m_pathMap.insert(m_files.at(i).path,i);
+    }
+    m_deadCount = 0;
+    m_modified = false;
+    //files may have changed while we were not running
+    m_verifyTimer.invalidate();
+    return true;
+}
+
+bool TrigramIndex::save(const QString &fileName)
+{
+    //serialize under the lock, write aside and rename outside it
+    QByteArray data;
+    m_mutex.lock();
+    compact();
+    QDataStream stream(&data,QIODevice::WriteOnly);
+    stream << IndexMarker << IndexVersion << m_root;
+    stream << qint32(m_files.size());
+    foreach (const TrigramFileEntry &entry, m_files) {
+        stream << entry.path << entry.mtime << entry.size << entry.indexed;
+    }
+    stream << qint32(m_postings.size());
+    QHash<quint32,QVector<int> >::const_iterator it = m_postings.constBegin();
+    for (; it != m_postings.constEnd(); ++it) {
+        stream << it.key() << encodePosting(it.value());
+    }
+    //changes made while writing set it again
+    m_modified = false;
+    m_mutex.unlock();
+    if (stream.status() != QDataStream::Ok || !FileUtil::replaceFile(fileName,data)) {
+        QMutexLocker locker(&m_mutex);
+        m_modified = true;
+        return false;
+    }
+    return true;
+}
+
+bool TrigramIndex::isModified() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_modified;
+}
+
+// root with one trailing separator, "/" and "C:/" already keep theirs
+static QString rootPrefix(const QString &root)
+{
+    return root.endsWith('/') ? root : root+"/";
+}
+
+static bool matchNameFilter(const QStringList &nameFilter, const QString &path)
+{
+    return nameFilter.isEmpty() || QDir::match(nameFilter,QFileInfo(path).fileName());
+}
+
+bool TrigramIndex::needVerify(const QStringList &nameFilter) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_verifyTimer.isValid() || m_verifyTimer.hasExpired(VerifyInterval)) {
+        return true;
+    }
+    //an unfiltered walk covers every filter
+    return !m_verifyFilter.isEmpty() && m_verifyFilter != nameFilter;
+}
+
+int TrigramIndex::beginVerify(const QStringList &nameFilter)
+{
+    QMutexLocker locker(&m_mutex);
+    //the walk sees every matching file on disk, their notifications are covered
+    QSet<QString>::iterator it = m_dirty.begin();
+    while (it != m_dirty.end()) {
+        if (matchNameFilter(nameFilter,*it)) {
+            it = m_dirty.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return ++m_generation;
+}
+
+void TrigramIndex::endVerify(int generation, const QStringList &nameFilter)
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_files.size(); i++) {
+        TrigramFileEntry &entry = m_files[i];
+        if (!entry.dead && entry.generation != generation &&
+                matchNameFilter(nameFilter,entry.path)) {
+            entry.dead = true;
+            m_pathMap.remove(entry.path);
+            m_deadCount++;
+            m_modified = true;
+        }
+    }
+    if (m_deadCount*2 > m_files.size()) {
+        compact();
+    }
+    m_verifyFilter = nameFilter;
+    m_verifyTimer.start();
+}
+
+QVector<quint32> TrigramIndex::fileTrigrams(const QString &fileName)
+{
+    QVector<quint32> trigrams;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return trigrams;
+    }
+    QByteArray data = file.readAll();
+    const uchar *p = (const uchar*)data.constData();
+    int size = data.size();
+    trigrams.reserve(qMax(0,size-2));
+    for (int i = 0; i+2 < size; i++) {
+        trigrams.append(makeTrigram(p[i],p[i+1],p[i+2]));
+    }
+    qSort(trigrams);
+    trigrams.erase(std::unique(trigrams.begin(),trigrams.end()),trigrams.end());
+    return trigrams;
+}
+
+void TrigramIndex::updateFile(const QFileInfo &info, int generation)
+{
+    QString path = info.filePath();
+    uint mtime = info.lastModified().toTime_t();
+    qint64 size = info.size();
+    m_mutex.lock();
+    int id = m_pathMap.value(path,-1);
+    if (id >= 0) {
+        TrigramFileEntry &entry = m_files[id];
+        if (entry.mtime == mtime && entry.size == size) {
+            entry.generation = generation;
+            m_mutex.unlock();
+            return;
+        }
+    }
+    m_mutex.unlock();
+
+    //read and split outside the lock, workers index in parallel
+    bool indexed = size <= MaxIndexFileSize;
+    QVector<quint32> trigrams;
+    if (indexed) {
+        trigrams = fileTrigrams(path);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    id = m_pathMap.value(path,-1);
+    if (id >= 0) {
+        m_files[id].dead = true;
+        m_deadCount++;
+    }
+    TrigramFileEntry entry;
+    entry.path = path;
+    entry.mtime = mtime;
+    entry.size = size;
+    entry.generation = generation;
+    entry.indexed = indexed;
+    id = m_files.size();
+    m_files.append(entry);
+    m_pathMap.insert(path,id);
+    foreach (quint32 trigram, trigrams) {
+        m_postings[trigram].append(id);
+    }
+    m_modified = true;
+}
+
+void TrigramIndex::removeFile(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+    int id = m_pathMap.value(fileName,-1);
+    if (id < 0) {
+        return;
+    }
+    m_files[id].dead = true;
+    m_pathMap.remove(fileName);
+    m_deadCount++;
+    m_modified = true;
+}
+
+void TrigramIndex::markDirty(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+    m_dirty.insert(fileName);
+}
+
+void TrigramIndex::updateDirty()
+{
+    m_mutex.lock();
+    QStringList files = m_dirty.toList();
+    m_dirty.clear();
+    int generation = m_generation;
+    m_mutex.unlock();
+    foreach (QString fileName, files) {
+        QFileInfo info(fileName);
+        if (info.isFile()) {
+            updateFile(info,generation);
+        } else {
+            removeFile(fileName);
+        }
+    }
+}
+
+void TrigramIndex::compact()
+{
+    if (m_deadCount == 0) {
+        return;
+    }
+    QVector<int> remap(m_files.size(),-1);
+    QVector<TrigramFileEntry> files;
+    for (int i = 0; i < m_files.size(); i++) {
+        if (!m_files.at(i).dead) {
+            remap[i] = files.size();
+            files.append(m_files.at(i));
+        }
+    }
+    QHash<quint32,QVector<int> >::iterator it = m_postings.begin();
+    while (it != m_postings.end()) {
+        QVector<int> ids;
+        foreach (int id, it.value()) {
+            if (remap.at(id) >= 0) {
+                ids.append(remap.at(id));
+            }
+        }
+        if (ids.isEmpty()) {
+            it = m_postings.erase(it);
+        } else {
+            it.value() = ids;
+            ++it;
+        }
+    }
+    m_files = files;
+    m_pathMap.clear();
+    for (int i = 0; i < m_files.size(); i++) {
+        m_pathMap.insert(m_files.at(i).path,i);
+    }
+    m_deadCount = 0;
+    m_modified = true;
+}
+
+QStringList TrigramIndex::candidates(const QStringList &literals, bool matchCase,
+                                     const QStringList &nameFilter, bool findSub) const
+{
+    QMutexLocker locker(&m_mutex);
+    QVector<int> ids;
+    bool all = true;
+    foreach (QString literal, literals) {
+        QByteArray data = literal.toUtf8();
+        const uchar *p = (const uchar*)data.constData();
+        for (int i = 0; i+2 < data.size(); i++) {
+            //index folds ascii only, skip non-ascii trigrams for insensitive search
+            if (!matchCase && (p[i] >= 0x80 || p[i+1] >= 0x80 || p[i+2] >= 0x80)) {
+                continue;
+            }
+            QHash<quint32,QVector<int> >::const_iterator it = m_postings.find(makeTrigram(p[i],p[i+1],p[i+2]));
+            if (it == m_postings.end()) {
+                ids.clear();
+                all = false;
+                break;
+            }
+            if (all) {
+                ids = it.value();
+                all = false;
+            } else {
+                QVector<int> result(qMin(ids.size(),it.value().size()));
+                QVector<int>::iterator end = std::set_intersection(ids.begin(),ids.end(),
+                                                                   it.value().begin(),it.value().end(),
+                                                                   result.begin());
+                result.resize(end-result.begin());
+                ids = result;
+            }
+            if (ids.isEmpty()) {
+                break;
+            }
+        }
+        if (!all && ids.isEmpty()) {
+            break;
+        }
+    }
+
+    QVector<bool> match(m_files.size(),all);
+    foreach (int id, ids) {
+        match[id] = true;
+    }
+    int rootSep = rootPrefix(m_root).length()-1;
+    QStringList files;
+    for (int i = 0; i < m_files.size(); i++) {
+        const TrigramFileEntry &entry = m_files.at(i);
+        if (entry.dead || (!match.at(i) && entry.indexed)) {
+            continue;
+        }
+        if (!findSub && entry.path.lastIndexOf('/') != rootSep) {
+            continue;
+        }
+        if (!matchNameFilter(nameFilter,entry.path)) {
+            continue;
+        }
+        files.append(entry.path);
+    }
+    files.sort();
+    return files;
+}
+
+static bool isHexDigit(QChar c)
+{
+    return c.isDigit() || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// literals every match of pattern must contain, empty if none known
+QStringList TrigramIndex::requiredLiterals(const QString &pattern, bool useRegExp)
+{
+    QStringList literals;
+    if (!useRegExp) {
+        literals.append(pattern);
+        return literals;
+    }
+    QString cur;
+    int depth = 0;
+    int i = 0;
+    int size = pattern.size();
+    while (i < size) {
+        QChar c = pattern.at(i);
+        QChar lit;
+        if (c == '\\') {
+            if (i+1 >= size) {
+                break;
+            }
+            QChar n = pattern.at(i+1);
+            i += 2;
+            if (n.isLetterOrNumber()) {
+                //class, anchor, back reference or numeric escape, skip its
+                //digits or {...} too, they are not literal text
+                if (i < size && pattern.at(i) == '{') {
+                    while (i < size && pattern.at(i) != '}') {
+                        i++;
+                    }
+                    i++;
+                } else if (n == 'x' || n == 'u') {
+                    for (int j = 0; j < 4 && i < size && isHexDigit(pattern.at(i)); j++) {
+                        i++;
+                    }
+                } else if (n.isDigit()) {
+                    while (i < size && pattern.at(i).isDigit()) {
+                        i++;
+                    }
+                }
+                if (depth == 0 && !cur.isEmpty()) {
+                    literals.append(cur);
+                }
+                cur.clear();
+                continue;
+            }
+            lit = n;
+        } else if (c == '|') {
+            if (depth == 0) {
+                return QStringList();
+            }
+            i++;
+            continue;
+        } else if (c == '(' || c == ')') {
+            depth += (c == '(') ? 1 : -1;
+            if (!cur.isEmpty()) {
+                literals.append(cur);
+            }
+            cur.clear();
+            i++;
+            continue;
+        } else if (c == '[') {
+            i++;
+            if (i < size && pattern.at(i) == '^') {
+                i++;
+            }
+            if (i < size && pattern.at(i) == ']') {
+                i++;
+            }
+            while (i < size && pattern.at(i) != ']') {
+                i += (pattern.at(i) == '\\') ? 2 : 1;
+            }
+            i++;
+            if (depth == 0 && !cur.isEmpty()) {
+                literals.append(cur);
+            }
+            cur.clear();
+            continue;
+        } else if (c == '.' || c == '^' || c == '$') {
+            if (depth == 0 && !cur.isEmpty()) {
+                literals.append(cur);
+            }
+            cur.clear();
+            i++;
+            continue;
+        } else if (c == '*' || c == '?' || c == '{' || c == '+') {
+            //quantifier applies to the last literal char
+            if (c != '+' && !cur.isEmpty()) {
+                cur.chop(1);
+            }
+            if (depth == 0 && !cur.isEmpty()) {
+                literals.append(cur);
+            }
+            cur.clear();
+            if (c == '{') {
+                while (i < size && pattern.at(i) != '}') {
+                    i++;
+                }
+            }
+            i++;
+            continue;
+        } else {
+            lit = c;
+            i++;
+        }
+        if (depth == 0) {
+            cur.append(lit);
+        }
+    }
+    if (!cur.isEmpty()) {
+        literals.append(cur);
+    }
+    return literals;
+}
+
+TrigramIndexUpdater::TrigramIndexUpdater(TrigramIndex *index, int generation) :
+    m_index(index),
+    m_generation(generation)
+{
+}
+
+void TrigramIndexUpdater::processFile(int /*worker*/, const QString &fileName)
+{
+    m_index->updateFile(QFileInfo(fileName),m_generation);
+}
+
+TrigramIndexCache::TrigramIndexCache(const QString &cachePath) :
+    m_cachePath(cachePath)
+{
+}
+
+TrigramIndexCache::~TrigramIndexCache()
+{
+    qDeleteAll(m_indexMap);
+}
+
+QString TrigramIndexCache::indexFileName(const QString &root) const
+{
+    QByteArray hash = QCryptographicHash::hash(root.toUtf8(),QCryptographicHash::Md5);
+    return QFileInfo(m_cachePath,QString::fromLatin1(hash.toHex())+".idx").filePath();
+}
+
+TrigramIndex *TrigramIndexCache::index(const QString &root)
+{
+    QMutexLocker locker(&m_mutex);
+    TrigramIndex *index = m_indexMap.value(root);
+    if (!index) {
+        index = new TrigramIndex(root);
+        index->load(indexFileName(root));
+        m_indexMap.insert(root,index);
+    }
+    return index;
+}
+
+void TrigramIndexCache::save(TrigramIndex *index)
+{
+    if (!index->isModified()) {
+        return;
+    }
+    QDir dir;
+    dir.mkpath(m_cachePath);
+    index->save(indexFileName(index->root()));
+}
+
+void TrigramIndexCache::fileChanged(const QString &fileName)
+{
+    QString path = QDir::cleanPath(fileName);
+    QMutexLocker locker(&m_mutex);
+    foreach (TrigramIndex *index, m_indexMap) {
+        if (path.startsWith(rootPrefix(index->root()))) {
+            index->markDirty(path);
+        }
+    }
+}
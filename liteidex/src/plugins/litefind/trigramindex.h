@@ -0,0 +1,119 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: trigramindex.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include "searchengine.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QMutex>
+#include <QElapsedTimer>
+
+class QFileInfo;
+
+struct TrigramFileEntry
+{
+    TrigramFileEntry() : mtime(0), size(0), generation(0), indexed(false), dead(false) {}
+    QString path;
+    uint    mtime;
+    qint64  size;
+    int     generation;
+    bool    indexed;
+    bool    dead;
+};
+
+// TrigramIndex maps every trigram of the files under one search root to
+// the files containing it. Bytes are ascii lower case folded, so one index
+// serves case sensitive and insensitive queries. File ids only grow, so
+// posting lists stay sorted; replaced files leave dead ids that are
+// dropped on compact.
+class TrigramIndex
+{
+public:
+    TrigramIndex(const QString &root);
+    QString root() const;
+    bool load(const QString &fileName);
+    bool save(const QString &fileName);
+    bool isModified() const;
+    // verify walk: beginVerify, updateFile for every file matching the
+    // name filter, endVerify with the same filter
+    bool needVerify(const QStringList &nameFilter) const;
+    int beginVerify(const QStringList &nameFilter);
+    void endVerify(int generation, const QStringList &nameFilter);
+    void updateFile(const QFileInfo &info, int generation);
+    void removeFile(const QString &fileName);
+    // file change notify from editor or watcher
+    void markDirty(const QString &fileName);
+    void updateDirty();
+    QStringList candidates(const QStringList &literals, bool matchCase,
+                           const QStringList &nameFilter, bool findSub) const;
+    static QStringList requiredLiterals(const QString &pattern, bool useRegExp);
+protected:
+    void compact();
+    static QVector<quint32> fileTrigrams(const QString &fileName);
+protected:
+    mutable QMutex                    m_mutex;
+    QString                           m_root;
+    QVector<TrigramFileEntry>         m_files;
+    QHash<QString,int>                m_pathMap;
+    QHash<quint32,QVector<int> >      m_postings;
+    QSet<QString>                     m_dirty;
+    QElapsedTimer                     m_verifyTimer;
+    QStringList                       m_verifyFilter;
+    int                               m_generation;
+    int                               m_deadCount;
+    bool                              m_modified;
+};
+
+class TrigramIndexUpdater : public SearchHandler
+{
+public:
+    TrigramIndexUpdater(TrigramIndex *index, int generation);
+    virtual void processFile(int worker, const QString &fileName);
+protected:
+    TrigramIndex *m_index;
+    int           m_generation;
+};
+
+class TrigramIndexCache
+{
+public:
+    TrigramIndexCache(const QString &cachePath);
+    ~TrigramIndexCache();
+    TrigramIndex *index(const QString &root);
+    void save(TrigramIndex *index);
+    void fileChanged(const QString &fileName);
+protected:
+    QString indexFileName(const QString &root) const;
+protected:
+    QMutex                      m_mutex;
+    QString                     m_cachePath;
+    QMap<QString,TrigramIndex*> m_indexMap;
+};
+
+#endif // TRIGRAMINDEX_H
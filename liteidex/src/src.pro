@@ -3,4 +3,4 @@ include (../liteidex.pri)
 TEMPLATE  = subdirs
 CONFIG   += ordered
 
-SUBDIRS = api 3rdparty utils liteapp plugins liteide
+SUBDIRS = api 3rdparty utils liteapp plugins liteide #tests
@@ -0,0 +1,9 @@
+TARGET = tst_golangapi
+
+include (../tests.pri)
+include (../../utils/golangapi/golangapi.pri)
+include (../../api/golangdocapi/golangdocapi.pri)
+include (../../utils/fileutil/fileutil.pri)
+include (../../api/liteapi/liteapi.pri)
+
+SOURCES += tst_golangapi.cpp
@@ -0,0 +1,128 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: tst_golangapi.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include <QtTest/QtTest>
+#include <QDir>
+#include <QFile>
+#include "golangapi/golangapi.h"
+#include "golangapi/golangapiparser.h"
+
+class tst_GolangApi : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void parseLine();
+    void parseAll();
+    void benchParse();
+    void benchParseAll();
+    void benchLoad();
+private:
+    QList<QByteArray> m_dataList;
+};
+
+//$GOROOT/api/go1*.txt, the same files golangdoc loads
+void tst_GolangApi::initTestCase()
+{
+    QString goroot = QString::fromLocal8Bit(qgetenv("GOROOT"));
+    QDir dir(goroot+"/api");
+    if (!goroot.isEmpty() && dir.exists()) {
+        foreach (QFileInfo info, dir.entryInfoList(QStringList() << "go1*.txt",QDir::Files,QDir::Name)) {
+            QFile file(info.filePath());
+            if (file.open(QFile::ReadOnly)) {
+                m_dataList.append(file.readAll());
+            }
+        }
+    }
+    if (m_dataList.isEmpty()) {
+#if QT_VERSION >= 0x050000
+        QSKIP("set GOROOT to a Go tree with api/go1*.txt");
+#else
+        QSKIP("set GOROOT to a Go tree with api/go1*.txt", SkipAll);
+#endif
+    }
+}
+
+void tst_GolangApi::parseLine()
+{
+    QByteArray line("pkg archive/tar, method (*Reader) Next() (*Header, error)");
+    ApiRecord rec;
+    QVERIFY(GolangApiParser::parseLine(line.constData(),line.constData()+line.size(),rec));
+    QCOMPARE(int(rec.kind),int(ApiRecord::Method));
+    QCOMPARE(QByteArray(rec.pkg.data,rec.pkg.size),QByteArray("archive/tar"));
+    QCOMPARE(QByteArray(rec.name.data,rec.name.size),QByteArray("Next"));
+}
+
+//the thread pool split must not lose or reorder records
+void tst_GolangApi::parseAll()
+{
+    ApiRecordList sequential;
+    foreach (const QByteArray &data, m_dataList) {
+        GolangApiParser::parse(data.constData(),data.size(),sequential);
+    }
+    QList<ApiRecordList> recordsList;
+    GolangApiParser::parseAll(m_dataList,recordsList);
+    int index = 0;
+    foreach (const ApiRecordList &records, recordsList) {
+        foreach (const ApiRecord &rec, records) {
+            QVERIFY(index < sequential.size());
+            QVERIFY(rec.name == sequential[index].name);
+            QVERIFY(rec.exp == sequential[index].exp);
+            index++;
+        }
+    }
+    QCOMPARE(index,sequential.size());
+    QVERIFY(index > 0);
+}
+
+void tst_GolangApi::benchParse()
+{
+    ApiRecordList records;
+    QBENCHMARK {
+        records.clear();
+        foreach (const QByteArray &data, m_dataList) {
+            GolangApiParser::parse(data.constData(),data.size(),records);
+        }
+    }
+}
+
+void tst_GolangApi::benchParseAll()
+{
+    QList<ApiRecordList> recordsList;
+    QBENCHMARK {
+        GolangApiParser::parseAll(m_dataList,recordsList);
+    }
+}
+
+//parse and build the package tree, no cache file
+void tst_GolangApi::benchLoad()
+{
+    QBENCHMARK {
+        GolangApi api;
+        QVERIFY(api.loadDataList(m_dataList,QByteArray()));
+    }
+}
+
+QTEST_MAIN(tst_GolangApi)
+
+#include "tst_golangapi.moc"
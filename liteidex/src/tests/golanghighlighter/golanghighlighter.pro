@@ -0,0 +1,14 @@
+TARGET = tst_golanghighlighter
+QT += xml
+
+include (../tests.pri)
+include (../../3rdparty/qtc_texteditor/qtc_texteditor.pri)
+include (../../utils/colorstyle/colorstyle.pri)
+include (../../utils/fileutil/fileutil.pri)
+include (../../api/liteapi/liteapi.pri)
+
+INCLUDEPATH += $$IDE_SOURCE_TREE/src/plugins/liteeditor
+
+HEADERS += $$IDE_SOURCE_TREE/src/plugins/liteeditor/golanghighlighter.h
+SOURCES += $$IDE_SOURCE_TREE/src/plugins/liteeditor/golanghighlighter.cpp \
+    tst_golanghighlighter.cpp
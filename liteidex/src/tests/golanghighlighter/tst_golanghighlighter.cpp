@@ -0,0 +1,111 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: tst_golanghighlighter.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include <QtTest/QtTest>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QElapsedTimer>
+#include <QFile>
+#include "golanghighlighter.h"
+#include "qtc_texteditor/katehighlighter.h"
+
+class tst_GolangHighlighter : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void multiLineState();
+    void benchGolang();
+    void benchKate();
+private:
+    QString m_source;
+};
+
+void tst_GolangHighlighter::initTestCase()
+{
+    QFile file(QString::fromLocal8Bit(qgetenv("GOROOT"))+"/src/net/http/server.go");
+    if (!file.open(QFile::ReadOnly)) {
+#if QT_VERSION >= 0x050000
+        QSKIP("set GOROOT to a Go tree with src/net/http/server.go");
+#else
+        QSKIP("set GOROOT to a Go tree with src/net/http/server.go", SkipAll);
+#endif
+    }
+    m_source = QString::fromUtf8(file.readAll());
+}
+
+//raw strings and block comments carry their state to the next line
+void tst_GolangHighlighter::multiLineState()
+{
+    QTextDocument doc("var s = `a\nb`\n/* c\nd */\nfunc f() {}");
+    GolangHighlighter h(&doc);
+    h.rehighlight();
+    QTextBlock block = doc.firstBlock();
+    QVERIFY(block.userState() > 0);
+    block = block.next();
+    QVERIFY(block.userState() <= 0);
+    block = block.next();
+    QVERIFY(block.userState() > 0);
+    block = block.next();
+    QVERIFY(block.userState() <= 0);
+    block = block.next();
+    QVERIFY(!block.layout()->additionalFormats().isEmpty());
+}
+
+void tst_GolangHighlighter::benchGolang()
+{
+    QTextDocument doc(m_source);
+    GolangHighlighter h(&doc);
+    QElapsedTimer timer;
+    timer.start();
+    int passes = 0;
+    QBENCHMARK {
+        h.rehighlight();
+        passes++;
+    }
+    qint64 msecs = qMax(timer.elapsed(),qint64(1));
+    qDebug("%d chars, %.0f chars/sec",m_source.size(),double(m_source.size())*passes*1000/msecs);
+}
+
+//the regexp based go.xml definition on the same source, for comparison
+void tst_GolangHighlighter::benchKate()
+{
+    KateHighlighter kate;
+    kate.loadPath(LITEIDE_DEPLOY_PATH"/liteeditor/kate");
+    QTextDocument doc(m_source);
+    TextEditor::SyntaxHighlighter *h = kate.create(&doc,"text/x-gosrc");
+    QElapsedTimer timer;
+    timer.start();
+    int passes = 0;
+    QBENCHMARK {
+        h->rehighlight();
+        passes++;
+    }
+    qint64 msecs = qMax(timer.elapsed(),qint64(1));
+    qDebug("%d chars, %.0f chars/sec",m_source.size(),double(m_source.size())*passes*1000/msecs);
+}
+
+QTEST_MAIN(tst_GolangHighlighter)
+
+#include "tst_golanghighlighter.moc"
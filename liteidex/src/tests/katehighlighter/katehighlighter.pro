@@ -0,0 +1,10 @@
+TARGET = tst_katehighlighter
+QT += xml
+
+include (../tests.pri)
+include (../../3rdparty/qtc_texteditor/qtc_texteditor.pri)
+include (../../utils/colorstyle/colorstyle.pri)
+include (../../utils/fileutil/fileutil.pri)
+include (../../api/liteapi/liteapi.pri)
+
+SOURCES += tst_katehighlighter.cpp
@@ -0,0 +1,92 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: tst_katehighlighter.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include <QtTest/QtTest>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QElapsedTimer>
+#include <QFile>
+#include "qtc_texteditor/katehighlighter.h"
+
+class tst_KateHighlighter : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void highlight();
+    void benchHighlight();
+private:
+    QString          m_source;
+    KateHighlighter *m_kate;
+};
+
+void tst_KateHighlighter::initTestCase()
+{
+    QFile file(QString::fromLocal8Bit(qgetenv("GOROOT"))+"/src/net/http/server.go");
+    if (!file.open(QFile::ReadOnly)) {
+#if QT_VERSION >= 0x050000
+        QSKIP("set GOROOT to a Go tree with src/net/http/server.go");
+#else
+        QSKIP("set GOROOT to a Go tree with src/net/http/server.go", SkipAll);
+#endif
+    }
+    m_source = QString::fromUtf8(file.readAll());
+    m_kate = new KateHighlighter(this);
+    m_kate->loadPath(LITEIDE_DEPLOY_PATH"/liteeditor/kate");
+    QVERIFY(m_kate->mimeTypes().contains("text/x-gosrc"));
+}
+
+//the copyright comment and the package keyword get formats
+void tst_KateHighlighter::highlight()
+{
+    QTextDocument doc(m_source);
+    TextEditor::SyntaxHighlighter *h = m_kate->create(&doc,"text/x-gosrc");
+    h->rehighlight();
+    QVERIFY(!doc.firstBlock().layout()->additionalFormats().isEmpty());
+    QTextBlock block = doc.firstBlock();
+    while (block.isValid() && !block.text().startsWith("package ")) {
+        block = block.next();
+    }
+    QVERIFY(block.isValid());
+    QVERIFY(!block.layout()->additionalFormats().isEmpty());
+}
+
+void tst_KateHighlighter::benchHighlight()
+{
+    QTextDocument doc(m_source);
+    TextEditor::SyntaxHighlighter *h = m_kate->create(&doc,"text/x-gosrc");
+    QElapsedTimer timer;
+    timer.start();
+    int passes = 0;
+    QBENCHMARK {
+        h->rehighlight();
+        passes++;
+    }
+    qint64 msecs = qMax(timer.elapsed(),qint64(1));
+    qDebug("%d chars, %.0f chars/sec",m_source.size(),double(m_source.size())*passes*1000/msecs);
+}
+
+QTEST_MAIN(tst_KateHighlighter)
+
+#include "tst_katehighlighter.moc"
@@ -0,0 +1,23 @@
+# benchmarks and tests, not part of the default build:
+# qmake tests.pro && make && ./golangapi/tst_golangapi
+# the highlighter benchmarks read $GOROOT/src/net/http/server.go
+include (../../liteidex.pri)
+
+TEMPLATE = app
+CONFIG  += console
+CONFIG  -= app_bundle
+
+greaterThan(QT_MAJOR_VERSION, 4) {
+    QT += testlib
+} else {
+    CONFIG += qtestlib
+}
+
+LIBS += -L$$IDE_LIBRARY_PATH
+
+INCLUDEPATH += $$IDE_SOURCE_TREE/src/api
+INCLUDEPATH += $$IDE_SOURCE_TREE/src/api/liteapi
+INCLUDEPATH += $$IDE_SOURCE_TREE/src/utils
+INCLUDEPATH += $$IDE_SOURCE_TREE/src/3rdparty
+
+DEFINES += LITEIDE_DEPLOY_PATH=\\\"$$IDE_SOURCE_TREE/deploy\\\"
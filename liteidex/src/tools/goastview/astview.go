@@ -15,10 +15,20 @@ var (
 	flagInputSrc   = flag.String("src", "", "input go source file")
 	flagStdin      = flag.Bool("stdin", false, "input by stdin")
 	flagInputFiles = flag.String("files", "", "input go files")
+	flagServer     = flag.Bool("server", false, "serve requests from stdin")
+	flagBinary     = flag.Bool("binary", false, "print the binary outline")
 )
 
 func main() {
 	flag.Parse()
+	if *flagServer {
+		err := RunServer(os.Stdin, os.Stdout)
+		if err != nil {
+			fmt.Fprint(os.Stderr, err)
+			os.Exit(1)
+		}
+		os.Exit(0)
+	}
 	if len(*flagInputSrc) == 0 && len(*flagInputFiles) == 0 {
 		flag.Usage()
 		os.Exit(1)
@@ -26,7 +36,9 @@ func main() {
 
 	if len(*flagInputFiles) > 0 {
 		var files []string = strings.Split(*flagInputFiles, " ")
-		err := PrintFilesTree(files, os.Stdout)
+		err := printOutline(func(w outlineWriter) error {
+			return PrintFilesTree(files, w)
+		})
 		if err != nil {
 			fmt.Fprint(os.Stderr, err)
 			os.Exit(1)
@@ -52,7 +64,22 @@ func main() {
 			fmt.Fprintf(os.Stderr, "Error:%s", err)
 			os.Exit(1)
 		}
-		view.PrintTree(os.Stdout)
+		printOutline(func(w outlineWriter) error {
+			view.PrintTree(w)
+			return nil
+		})
 	}
 	os.Exit(0)
 }
+
+func printOutline(print func(w outlineWriter) error) error {
+	if !*flagBinary {
+		return print(&textOutline{os.Stdout})
+	}
+	b := newBinaryOutline()
+	if err := print(b); err != nil {
+		return err
+	}
+	_, err := b.WriteTo(os.Stdout)
+	return err
+}
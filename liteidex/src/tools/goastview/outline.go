@@ -0,0 +1,174 @@
+// Copyright 2011-2012 visualfc <visualfc@gmail.com>. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package main
+
+import (
+	"encoding/binary"
+	"fmt"
+	"go/token"
+	"hash/fnv"
+	"io"
+)
+
+type outlineWriter interface {
+	WriteFile(name string)
+	WriteNode(level int, tag string, name string, pos *token.Position)
+}
+
+// text outline, one line per node
+//
+//	@,<file>
+//	<level>,<tag>,<name>[,<file index>,<line>,<column>]
+type textOutline struct {
+	w io.Writer
+}
+
+func (t *textOutline) WriteFile(name string) {
+	fmt.Fprintf(t.w, "@,%s\n", name)
+}
+
+func (t *textOutline) WriteNode(level int, tag string, name string, pos *token.Position) {
+	if pos == nil {
+		fmt.Fprintf(t.w, "%d,%s,%s\n", level, tag, name)
+	} else {
+		fmt.Fprintf(t.w, "%d,%s,%s,%s\n", level, tag, name, posText(*pos))
+	}
+}
+
+// binary outline, integers are unsigned varints
+//
+//	"\x00LAO" <version byte>
+//	<file count> { <size> <file> }
+//	{ <node> }
+//
+//	node: <tag byte> <size> <name> <file index+1> <line> <column>
+//	      <hash uint32 le> <children size> { <node> }
+//
+// the hash covers the node and its children, a reader skips the
+// children of a node whose hash it already has.
+const (
+	binaryOutlineMagic   = "\x00LAO"
+	binaryOutlineVersion = 1
+)
+
+var binaryOutlineTags = []string{"",
+	tag_package, tag_type, tag_struct, tag_interface, tag_value, tag_const, tag_func,
+	tag_value_folder, tag_const_folder, tag_func_folder,
+	tag_type_method, tag_type_factor, tag_type_value}
+
+type outlineNode struct {
+	tag      byte
+	name     string
+	file     int
+	line     int
+	col      int
+	hash     uint32
+	data     []byte
+	children []*outlineNode
+}
+
+// binaryOutline collects the nodes into a tree first, the level 1 nodes
+// with the same name are merged like the text reader does.
+type binaryOutline struct {
+	files  []string
+	root   outlineNode
+	levels map[int]*outlineNode
+	level1 map[string]*outlineNode
+}
+
+func newBinaryOutline() *binaryOutline {
+	return &binaryOutline{levels: make(map[int]*outlineNode), level1: make(map[string]*outlineNode)}
+}
+
+func (b *binaryOutline) WriteFile(name string) {
+	b.files = append(b.files, name)
+}
+
+func (b *binaryOutline) WriteNode(level int, tag string, name string, pos *token.Position) {
+	if len(name) == 0 {
+		return
+	}
+	if level == 0 {
+		b.level1 = make(map[string]*outlineNode)
+	}
+	if tag == tag_package && name == "documentation" {
+		return
+	}
+	if level == 1 {
+		if node, ok := b.level1[name]; ok {
+			b.levels[level] = node
+			return
+		}
+	}
+	node := &outlineNode{name: name}
+	for i, t := range binaryOutlineTags {
+		if t == tag {
+			node.tag = byte(i)
+			break
+		}
+	}
+	if pos != nil {
+		node.file = posFileIndex(*pos) + 1
+		node.line = pos.Line
+		node.col = pos.Column
+	}
+	if level == 1 {
+		b.level1[name] = node
+	}
+	parent, ok := b.levels[level-1]
+	if !ok {
+		parent = &b.root
+	}
+	parent.children = append(parent.children, node)
+	b.levels[level] = node
+}
+
+func appendUvarint(buf []byte, v int) []byte {
+	var tmp [binary.MaxVarintLen64]byte
+	n := binary.PutUvarint(tmp[:], uint64(v))
+	return append(buf, tmp[:n]...)
+}
+
+func (n *outlineNode) encode() {
+	var children []byte
+	h := fnv.New32a()
+	for _, c := range n.children {
+		c.encode()
+		children = append(children, c.data...)
+	}
+	buf := []byte{n.tag}
+	buf = appendUvarint(buf, len(n.name))
+	buf = append(buf, n.name...)
+	buf = appendUvarint(buf, n.file)
+	buf = appendUvarint(buf, n.line)
+	buf = appendUvarint(buf, n.col)
+	h.Write(buf)
+	h.Write(children)
+	n.hash = h.Sum32()
+	if n.hash == 0 {
+		n.hash = 1
+	}
+	var tmp [4]byte
+	binary.LittleEndian.PutUint32(tmp[:], n.hash)
+	buf = append(buf, tmp[:]...)
+	buf = appendUvarint(buf, len(children))
+	n.data = append(buf, children...)
+}
+
+func (b *binaryOutline) WriteTo(w io.Writer) (int64, error) {
+	buf := []byte(binaryOutlineMagic)
+	buf = append(buf, binaryOutlineVersion)
+	buf = appendUvarint(buf, len(b.files))
+	for _, name := range b.files {
+		buf = appendUvarint(buf, len(name))
+		buf = append(buf, name...)
+	}
+	for _, c := range b.root.children {
+		c.encode()
+		buf = append(buf, c.data...)
+	}
+	n, err := w.Write(buf)
+	return int64(n), err
+}
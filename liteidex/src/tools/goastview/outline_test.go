@@ -0,0 +1,203 @@
+// Copyright 2011-2012 visualfc <visualfc@gmail.com>. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package main
+
+import (
+	"bytes"
+	"encoding/binary"
+	"go/token"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"runtime"
+	"strconv"
+	"strings"
+	"testing"
+)
+
+type recordedNode struct {
+	level int
+	tag   string
+	name  string
+	pos   *token.Position
+}
+
+// outlineRecorder keeps the nodes of one outline to replay them into the
+// writers without parsing again.
+type outlineRecorder struct {
+	files []string
+	nodes []recordedNode
+}
+
+func (r *outlineRecorder) WriteFile(name string) {
+	r.files = append(r.files, name)
+}
+
+func (r *outlineRecorder) WriteNode(level int, tag string, name string, pos *token.Position) {
+	var p *token.Position
+	if pos != nil {
+		c := *pos
+		p = &c
+	}
+	r.nodes = append(r.nodes, recordedNode{level, tag, name, p})
+}
+
+func (r *outlineRecorder) replay(w outlineWriter) {
+	for _, name := range r.files {
+		w.WriteFile(name)
+	}
+	for _, n := range r.nodes {
+		w.WriteNode(n.level, n.tag, n.name, n.pos)
+	}
+}
+
+// outline of a large GOROOT source file
+func recordOutline(tb testing.TB) *outlineRecorder {
+	fileName := filepath.Join(runtime.GOROOT(), "src", "net", "http", "server.go")
+	if _, err := os.Stat(fileName); err != nil {
+		tb.Skip("GOROOT source not found:", fileName)
+	}
+	r := &outlineRecorder{}
+	if err := PrintFilesTree([]string{fileName}, r); err != nil {
+		tb.Fatal(err)
+	}
+	return r
+}
+
+func textOutlineData(r *outlineRecorder) []byte {
+	var buf bytes.Buffer
+	r.replay(&textOutline{&buf})
+	return buf.Bytes()
+}
+
+func binaryOutlineData(r *outlineRecorder) []byte {
+	var buf bytes.Buffer
+	b := newBinaryOutline()
+	r.replay(b)
+	b.WriteTo(&buf)
+	return buf.Bytes()
+}
+
+// readTextOutline splits lines and fields like the old Qt reader did
+func readTextOutline(data []byte) (nodes int) {
+	for _, line := range strings.Split(string(data), "\n") {
+		fields := strings.Split(line, ",")
+		if len(fields) < 3 || fields[0] == "@" {
+			continue
+		}
+		strconv.Atoi(fields[0])
+		if len(fields) >= 6 {
+			strconv.Atoi(fields[3])
+			strconv.Atoi(fields[4])
+			strconv.Atoi(fields[5])
+		}
+		nodes++
+	}
+	return
+}
+
+// readBinaryOutline walks the nodes in place, nothing is copied
+func readBinaryOutline(data []byte) (nodes int, ok bool) {
+	if !bytes.HasPrefix(data, []byte(binaryOutlineMagic)) || len(data) < len(binaryOutlineMagic)+1 {
+		return 0, false
+	}
+	data = data[len(binaryOutlineMagic)+1:]
+	files, n := binary.Uvarint(data)
+	if n <= 0 {
+		return 0, false
+	}
+	data = data[n:]
+	for i := uint64(0); i < files; i++ {
+		size, n := binary.Uvarint(data)
+		if n <= 0 || uint64(len(data)-n) < size {
+			return 0, false
+		}
+		data = data[n+int(size):]
+	}
+	return readBinaryNodes(data)
+}
+
+func readBinaryNodes(data []byte) (nodes int, ok bool) {
+	for len(data) > 0 {
+		data = data[1:]
+		size, n := binary.Uvarint(data)
+		if n <= 0 || uint64(len(data)-n) < size {
+			return nodes, false
+		}
+		data = data[n+int(size):]
+		for i := 0; i < 3; i++ {
+			if _, n = binary.Uvarint(data); n <= 0 {
+				return nodes, false
+			}
+			data = data[n:]
+		}
+		if len(data) < 4 {
+			return nodes, false
+		}
+		data = data[4:]
+		size, n = binary.Uvarint(data)
+		if n <= 0 || uint64(len(data)-n) < size {
+			return nodes, false
+		}
+		children, ok := readBinaryNodes(data[n : n+int(size)])
+		if !ok {
+			return nodes, false
+		}
+		nodes += 1 + children
+		data = data[n+int(size):]
+	}
+	return nodes, true
+}
+
+func TestBinaryOutline(t *testing.T) {
+	r := recordOutline(t)
+	nodes, ok := readBinaryOutline(binaryOutlineData(r))
+	if !ok {
+		t.Fatal("binary outline is truncated or malformed")
+	}
+	if nodes == 0 || nodes > readTextOutline(textOutlineData(r)) {
+		t.Fatalf("binary outline has %d nodes, text outline %d", nodes, readTextOutline(textOutlineData(r)))
+	}
+}
+
+func BenchmarkTextOutlineWrite(b *testing.B) {
+	r := recordOutline(b)
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		r.replay(&textOutline{ioutil.Discard})
+	}
+}
+
+func BenchmarkBinaryOutlineWrite(b *testing.B) {
+	r := recordOutline(b)
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		out := newBinaryOutline()
+		r.replay(out)
+		out.WriteTo(ioutil.Discard)
+	}
+}
+
+func BenchmarkTextOutlineRead(b *testing.B) {
+	data := textOutlineData(recordOutline(b))
+	b.SetBytes(int64(len(data)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		readTextOutline(data)
+	}
+}
+
+func BenchmarkBinaryOutlineRead(b *testing.B) {
+	data := binaryOutlineData(recordOutline(b))
+	b.SetBytes(int64(len(data)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		readBinaryOutline(data)
+	}
+}
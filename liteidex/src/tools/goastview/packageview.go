@@ -9,7 +9,6 @@ import (
 	"go/ast"
 	"go/parser"
 	"go/token"
-	"io"
 	"io/ioutil"
 	"os"
 	"tools/goastview/doc"
@@ -31,14 +30,20 @@ const (
 	tag_type_value   = "tv"
 )
 
+// positioner resolves the positions of the parsed files, a *token.FileSet
+// or the files of one server request.
+type positioner interface {
+	Position(p token.Pos) token.Position
+}
+
 type PackageView struct {
-	fset *token.FileSet
+	fset positioner
 	pdoc *doc.PackageDoc
 }
 
 var AllFiles []string
 
-func (p *PackageView) posFileIndex(pos token.Position) int {
+func posFileIndex(pos token.Position) int {
 	var index = -1
 	for i := 0; i < len(AllFiles); i++ {
 		if AllFiles[i] == pos.Filename {
@@ -53,15 +58,16 @@ func (p *PackageView) posFileIndex(pos token.Position) int {
 	return index
 }
 
-func (p *PackageView) posText(pos token.Position) (s string) {
-	index := p.posFileIndex(pos)
+func posText(pos token.Position) (s string) {
+	index := posFileIndex(pos)
 	return fmt.Sprintf("%d,%d,%d", index, pos.Line, pos.Column)
 }
 
 func NewFilePackage(filename string) (*PackageView, error) {
 	p := new(PackageView)
-	p.fset = token.NewFileSet()
-	file, err := parser.ParseFile(p.fset, filename, nil, 0)
+	fset := token.NewFileSet()
+	p.fset = fset
+	file, err := parser.ParseFile(fset, filename, nil, 0)
 	if err != nil {
 		return nil, err
 	}
@@ -69,7 +75,7 @@ func NewFilePackage(filename string) (*PackageView, error) {
 	return p, nil
 }
 
-func NewPackage(pkg *ast.Package, fset *token.FileSet) (*PackageView, error) {
+func NewPackage(pkg *ast.Package, fset positioner) (*PackageView, error) {
 	p := new(PackageView)
 	p.fset = fset
 	var importpath string = ""
@@ -98,7 +104,7 @@ func ParseFiles(fset *token.FileSet, filenames []string, mode parser.Mode) (pkgs
 	return
 }
 
-func PrintFilesTree(filenames []string, w io.Writer) error {
+func PrintFilesTree(filenames []string, w outlineWriter) error {
 	fset := token.NewFileSet()
 	pkgs, pkgsfiles, err := ParseFiles(fset, filenames, 0)
 	if err != nil {
@@ -106,7 +112,7 @@ func PrintFilesTree(filenames []string, w io.Writer) error {
 	}
 	AllFiles = pkgsfiles
 	for i := 0; i < len(AllFiles); i++ {
-		fmt.Fprintf(w, "@,%s\n", AllFiles[i])
+		w.WriteFile(AllFiles[i])
 	}
 	for _, pkg := range pkgs {
 		view, err := NewPackage(pkg, fset)
@@ -124,8 +130,9 @@ func NewFilePackageSource(filename string, f *os.File) (*PackageView, error) {
 		return nil, err
 	}
 	p := new(PackageView)
-	p.fset = token.NewFileSet()
-	file, err := parser.ParseFile(p.fset, filename, src, 0)
+	fset := token.NewFileSet()
+	p.fset = fset
+	file, err := parser.ParseFile(fset, filename, src, 0)
 	if err != nil {
 		return nil, err
 	}
@@ -133,23 +140,23 @@ func NewFilePackageSource(filename string, f *os.File) (*PackageView, error) {
 	return p, nil
 }
 
-func (p *PackageView) PrintFuncs(w io.Writer, funcs []*doc.FuncDoc, level int, tag string, tag_folder string) {
+func (p *PackageView) PrintFuncs(w outlineWriter, funcs []*doc.FuncDoc, level int, tag string, tag_folder string) {
 	if len(tag_folder) > 0 && len(funcs) > 0 {
-		fmt.Fprintf(w, "%d,%s,Functions\n", level, tag_folder)
+		w.WriteNode(level, tag_folder, "Functions", nil)
 		level++
 	}
 	for _, f := range funcs {
 		pos := p.fset.Position(f.Decl.Pos())
-		fmt.Fprintf(w, "%d,%s,%s,%s\n", level, tag, f.Name, p.posText(pos))
+		w.WriteNode(level, tag, f.Name, &pos)
 	}
 }
 
-func (p *PackageView) PrintVars(w io.Writer, vars []*doc.ValueDoc, level int, tag string, tag_folder string) {
+func (p *PackageView) PrintVars(w outlineWriter, vars []*doc.ValueDoc, level int, tag string, tag_folder string) {
 	if len(tag_folder) > 0 && len(vars) > 0 {
 		if tag_folder == tag_value_folder {
-			fmt.Fprintf(w, "%d,%s,Variables\n", level, tag_folder)
+			w.WriteNode(level, tag_folder, "Variables", nil)
 		} else if tag_folder == tag_const_folder {
-			fmt.Fprintf(w, "%d,%s,Constants\n", level, tag_folder)
+			w.WriteNode(level, tag_folder, "Constants", nil)
 		}
 		level++
 	}
@@ -161,13 +168,13 @@ func (p *PackageView) PrintVars(w io.Writer, vars []*doc.ValueDoc, level int, ta
 			if m, ok := s.(*ast.ValueSpec); ok {
 				pos := p.fset.Position(m.Pos())
 				for i := 0; i < len(m.Names); i++ {
-					fmt.Fprintf(w, "%d,%s,%s,%s\n", level, tag, m.Names[i], p.posText(pos))
+					w.WriteNode(level, tag, m.Names[i].Name, &pos)
 				}
 			}
 		}
 	}
 }
-func (p *PackageView) PrintTypes(w io.Writer, types []*doc.TypeDoc, level int) {
+func (p *PackageView) PrintTypes(w outlineWriter, types []*doc.TypeDoc, level int) {
 	for _, d := range types {
 		if d.Type == nil {
 			continue
@@ -179,7 +186,7 @@ func (p *PackageView) PrintTypes(w io.Writer, types []*doc.TypeDoc, level int) {
 			tag = tag_struct
 		}
 		pos := p.fset.Position(d.Type.Pos())
-		fmt.Fprintf(w, "%d,%s,%s,%s\n", level, tag, d.Type.Name, p.posText(pos))
+		w.WriteNode(level, tag, d.Type.Name.Name, &pos)
 		p.PrintTypeFields(w, d.Decl, level+1)
 		p.PrintFuncs(w, d.Factories, level+1, tag_type_factor, "")
 		p.PrintFuncs(w, d.Methods, level+1, tag_type_method, "")
@@ -187,7 +194,7 @@ func (p *PackageView) PrintTypes(w io.Writer, types []*doc.TypeDoc, level int) {
 	}
 }
 
-func (p *PackageView) PrintTypeFields(w io.Writer, decl *ast.GenDecl, level int) {
+func (p *PackageView) PrintTypeFields(w outlineWriter, decl *ast.GenDecl, level int) {
 	spec, ok := decl.Specs[0].(*ast.TypeSpec)
 	if ok == false {
 		return
@@ -200,7 +207,7 @@ func (p *PackageView) PrintTypeFields(w io.Writer, decl *ast.GenDecl, level int)
 			}
 			for _, m := range list.Names {
 				pos := p.fset.Position(m.Pos())
-				fmt.Fprintf(w, "%d,%s,%s,%s\n", level, tag_type_value, m.Name, p.posText(pos))
+				w.WriteNode(level, tag_type_value, m.Name, &pos)
 			}
 		}
 	case *ast.InterfaceType:
@@ -210,17 +217,17 @@ func (p *PackageView) PrintTypeFields(w io.Writer, decl *ast.GenDecl, level int)
 			}
 			for _, m := range list.Names {
 				pos := p.fset.Position(m.Pos())
-				fmt.Fprintf(w, "%d,%s,%s,%s\n", level, tag_type_method, m.Name, p.posText(pos))
+				w.WriteNode(level, tag_type_method, m.Name, &pos)
 			}
 		}
 	}
 }
 
-func (p *PackageView) PrintHeader(w io.Writer, level int) {
-	fmt.Fprintf(w, "%d,%s,%s\n", level, tag_package, p.pdoc.PackageName)
+func (p *PackageView) PrintHeader(w outlineWriter, level int) {
+	w.WriteNode(level, tag_package, p.pdoc.PackageName, nil)
 }
 
-func (p *PackageView) PrintPackage(w io.Writer, level int) {
+func (p *PackageView) PrintPackage(w outlineWriter, level int) {
 	p.PrintHeader(w, level)
 	level++
 	p.PrintVars(w, p.pdoc.Vars, level, tag_value, tag_value_folder)
@@ -230,6 +237,6 @@ func (p *PackageView) PrintPackage(w io.Writer, level int) {
 }
 
 // level:tag:name:x:y
-func (p *PackageView) PrintTree(w io.Writer) {
+func (p *PackageView) PrintTree(w outlineWriter) {
 	p.PrintPackage(w, 0)
 }
@@ -0,0 +1,271 @@
+// Copyright 2011-2012 visualfc <visualfc@gmail.com>. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"errors"
+	"fmt"
+	"go/ast"
+	"go/parser"
+	"go/token"
+	"io"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+	"time"
+)
+
+// server mode reads requests from stdin and keeps the parsed files
+// until their contents change.
+//
+//	update <size>\n<name>\n<data>       set the unsaved contents of name
+//	remove\n<name>\n                     drop the contents, read name from disk
+//	files <id> <count> [binary]\n<dir>\n<name>... print the tree of the files in dir
+//
+// a files request is answered with
+//
+//	<id> ok <size>\n<tree>
+//	<id> error <size>\n<message>
+
+// each file is parsed into a file set of its own, so the positions of a
+// replaced or removed file are released with it. the file sets start at
+// distinct bases and the trees of one request can still be printed together.
+type cacheFile struct {
+	src     []byte
+	modTime time.Time
+	size    int64
+	fset    *token.FileSet
+	file    *ast.File
+	err     error
+	used    int
+}
+
+type astServer struct {
+	base    int
+	request int
+	files   map[string]*cacheFile
+}
+
+const (
+	// the trees are parsed again from base 1 once the bases reach maxBase
+	maxBase = 1 << 30
+	// trees read from disk are dropped when no request used them for this long
+	keepRequests = 16
+)
+
+func newAstServer() *astServer {
+	return &astServer{base: 1, files: make(map[string]*cacheFile)}
+}
+
+func (s *astServer) update(name string, src []byte) {
+	s.files[filepath.Clean(name)] = &cacheFile{src: src}
+}
+
+func (s *astServer) remove(name string) {
+	delete(s.files, filepath.Clean(name))
+}
+
+func (s *astServer) parseFile(c *cacheFile, name string, src interface{}) {
+	fset := token.NewFileSet()
+	if s.base > fset.Base() {
+		//reserve the positions used by the other cached files
+		fset.AddFile("", -1, s.base-fset.Base()-1)
+	}
+	c.fset = fset
+	c.file, c.err = parser.ParseFile(fset, name, src, 0)
+	s.base = fset.Base()
+}
+
+// beginRequest drops the trees not used for a while, and all parsed trees
+// when the positions run out.
+func (s *astServer) beginRequest() {
+	s.request++
+	reset := s.base >= maxBase
+	if reset {
+		s.base = 1
+	}
+	for name, c := range s.files {
+		if c.src == nil && (reset || s.request-c.used > keepRequests) {
+			delete(s.files, name)
+		} else if reset {
+			c.fset, c.file, c.err = nil, nil, nil
+		}
+	}
+}
+
+func (s *astServer) parse(name string) (*cacheFile, error) {
+	c, ok := s.files[name]
+	if ok && c.src != nil {
+		if c.fset == nil {
+			s.parseFile(c, name, c.src)
+		}
+		c.used = s.request
+		return c, c.err
+	}
+	info, err := os.Stat(name)
+	if err != nil {
+		return nil, err
+	}
+	if !ok || !c.modTime.Equal(info.ModTime()) || c.size != info.Size() {
+		c = &cacheFile{modTime: info.ModTime(), size: info.Size()}
+		s.parseFile(c, name, nil)
+		s.files[name] = c
+	}
+	c.used = s.request
+	return c, c.err
+}
+
+// filePositions resolves the positions of files parsed into separate file sets.
+type filePositions []*token.File
+
+func (files filePositions) Position(p token.Pos) token.Position {
+	for _, f := range files {
+		if int(p) >= f.Base() && int(p) <= f.Base()+f.Size() {
+			return f.Position(p)
+		}
+	}
+	return token.Position{}
+}
+
+func (s *astServer) printFiles(dir string, names []string, w io.Writer, binary bool) error {
+	s.beginRequest()
+	pkgs := make(map[string]*ast.Package)
+	var order []string
+	var positions filePositions
+	for _, name := range names {
+		c, err := s.parse(filepath.Join(dir, name))
+		if err != nil {
+			return err
+		}
+		file := c.file
+		positions = append(positions, c.fset.File(file.Package))
+		pkg, found := pkgs[file.Name.Name]
+		if !found {
+			pkg = &ast.Package{Name: file.Name.Name, Files: make(map[string]*ast.File)}
+			pkgs[file.Name.Name] = pkg
+			order = append(order, file.Name.Name)
+		}
+		pkg.Files[name] = file
+	}
+	//positions are printed relative to dir like the -files mode
+	AllFiles = nil
+	for _, name := range names {
+		AllFiles = append(AllFiles, filepath.Join(dir, name))
+	}
+	var out outlineWriter
+	var buf bytes.Buffer
+	var bin *binaryOutline
+	if binary {
+		bin = newBinaryOutline()
+		out = bin
+	} else {
+		out = &textOutline{&buf}
+	}
+	for _, name := range names {
+		out.WriteFile(name)
+	}
+	for _, name := range order {
+		view, err := NewPackage(pkgs[name], positions)
+		if err != nil {
+			return err
+		}
+		view.PrintTree(out)
+	}
+	if bin != nil {
+		bin.WriteTo(&buf)
+	}
+	_, err := w.Write(buf.Bytes())
+	return err
+}
+
+func readLine(r *bufio.Reader) (string, error) {
+	line, err := r.ReadString('\n')
+	if err != nil {
+		return "", err
+	}
+	return strings.TrimRight(line, "\r\n"), nil
+}
+
+func writeReply(w *bufio.Writer, id string, data []byte, err error) {
+	if err != nil {
+		msg := err.Error()
+		fmt.Fprintf(w, "%s error %d\n%s", id, len(msg), msg)
+	} else {
+		fmt.Fprintf(w, "%s ok %d\n", id, len(data))
+		w.Write(data)
+	}
+	w.Flush()
+}
+
+func RunServer(in io.Reader, out io.Writer) error {
+	s := newAstServer()
+	r := bufio.NewReaderSize(in, 64*1024)
+	w := bufio.NewWriter(out)
+	for {
+		line, err := readLine(r)
+		if err == io.EOF {
+			return nil
+		} else if err != nil {
+			return err
+		}
+		args := strings.Fields(line)
+		if len(args) == 0 {
+			continue
+		}
+		switch args[0] {
+		case "update":
+			if len(args) != 2 {
+				return errors.New("invalid update request")
+			}
+			size, err := strconv.Atoi(args[1])
+			if err != nil {
+				return err
+			}
+			name, err := readLine(r)
+			if err != nil {
+				return err
+			}
+			src := make([]byte, size)
+			if _, err := io.ReadFull(r, src); err != nil {
+				return err
+			}
+			s.update(name, src)
+		case "remove":
+			name, err := readLine(r)
+			if err != nil {
+				return err
+			}
+			s.remove(name)
+		case "files":
+			if len(args) != 3 && (len(args) != 4 || args[3] != "binary") {
+				return errors.New("invalid files request")
+			}
+			count, err := strconv.Atoi(args[2])
+			if err != nil {
+				return err
+			}
+			dir, err := readLine(r)
+			if err != nil {
+				return err
+			}
+			var names []string
+			for i := 0; i < count; i++ {
+				name, err := readLine(r)
+				if err != nil {
+					return err
+				}
+				names = append(names, name)
+			}
+			var buf bytes.Buffer
+			err = s.printFiles(dir, names, &buf, len(args) == 4)
+			writeReply(w, args[1], buf.Bytes(), err)
+		default:
+			return fmt.Errorf("unknown request %q", args[0])
+		}
+	}
+}
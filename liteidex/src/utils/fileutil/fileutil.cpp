@@ -26,7 +26,17 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QProcess>
+#if QT_VERSION >= 0x050000
+#include <QSaveFile>
+#else
+#include <QTemporaryFile>
+#endif
 #include <QDebug>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
 
 //lite_memory_check_begin
 #if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
@@ -39,6 +49,46 @@
 //lite_memory_check_end
 
 
+bool FileUtil::replaceFile(const QString &fileName, const QByteArray &data)
+{
+#if QT_VERSION >= 0x050000
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    if (file.write(data) != data.size()) {
+        return false;
+    }
+    return file.commit();
+#else
+    QTemporaryFile file(fileName+".XXXXXX");
+    if (!file.open()) {
+        return false;
+    }
+    if (file.write(data) != data.size() || !file.flush()) {
+        return false;
+    }
+    file.close();
+    if (!renameOver(file.fileName(),fileName)) {
+        return false;
+    }
+    file.setAutoRemove(false);
+    return true;
+#endif
+}
+
+//replace target in one step, readers see the old or the new file
+bool FileUtil::renameOver(const QString &source, const QString &target)
+{
+#ifdef Q_OS_WIN
+    return MoveFileExW((LPCWSTR)QDir::toNativeSeparators(source).utf16(),
+                       (LPCWSTR)QDir::toNativeSeparators(target).utf16(),
+                       MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return ::rename(QFile::encodeName(source).constData(),QFile::encodeName(target).constData()) == 0;
+#endif
+}
+
 bool FileUtil::compareFile(const QString &fileName1, const QString &fileName2, bool canonical)
 {
     if (fileName1.isEmpty() || fileName2.isEmpty()) {
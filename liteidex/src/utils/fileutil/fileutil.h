@@ -34,6 +34,10 @@
 struct FileUtil
 {
     static bool compareFile(const QString &fileName1, const QString &fileName2, bool canonical = true);
+    // write data to a temporary file beside fileName and rename it over fileName,
+    // readers never see a partially written file
+    static bool replaceFile(const QString &fileName, const QByteArray &data);
+    static bool renameOver(const QString &source, const QString &target);
     static QStringList removeFiles(const QStringList &files);
     static QStringList removeWorkDir(const QString &workDir, const QStringList &filters);
     static QMap<QString,QStringList> readFileContext(QIODevice *dev);
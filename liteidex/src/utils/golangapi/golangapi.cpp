@@ -22,11 +22,15 @@
 // Creator: visualfc <visualfc@gmail.com>
 
 #include "golangapi.h"
+#include "golangapiparser.h"
+#include "golangapiindex.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
 #include <QSet>
-#include <QRegExp>
+#include <QElapsedTimer>
 #include <QTextStream>
-#include <QFile>
 #include <QDebug>
 //lite_memory_check_begin
 #if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
@@ -38,9 +42,126 @@
 #endif
 //lite_memory_check_end
 
+// ApiBuilder turns parsed records into nodes, tokens are decoded from
+// utf-8 once and the first definition of a name wins.
+class ApiBuilder
+{
+public:
+    ApiBuilder(Packages *pkgs) : m_pkgs(pkgs), m_lastPkg(0), m_lastType(0)
+    {}
+    void append(const ApiRecordList &records) {
+        foreach (const ApiRecord &rec, records) {
+            append(rec);
+        }
+    }
+protected:
+    QString string(const ApiToken &tok) {
+        QByteArray key = QByteArray::fromRawData(tok.data,tok.size);
+        QHash<QByteArray,QString>::const_iterator it = m_strings.constFind(key);
+        if (it != m_strings.constEnd()) {
+            return it.value();
+        }
+        QString text = QString::fromUtf8(tok.data,tok.size);
+        m_strings.insert(key,text);
+        return text;
+    }
+    Type *findType(const ApiToken &typeName, PkgApiEnum typ, const QString &exp) {
+        QString name = string(typeName);
+        Type *t = m_lastPkg->findType(name);
+        if (!t) {
+            t = m_pkgs->newType(typ,name,exp);
+            m_lastPkg->appendType(t);
+        }
+        return t;
+    }
+    // methods and fields follow their type, reuse the last one if it matches
+    Type *lastType(const ApiToken &typeName, PkgApiEnum typ) {
+        if (m_lastType == 0 || m_lastTypeName != typeName || m_lastType->typ == StructApi) {
+            m_lastType = findType(typeName,typ,"struct");
+            m_lastTypeName = typeName;
+        }
+        return m_lastType;
+    }
+    void setLastType(Type *t, const ApiToken &typeName) {
+        m_lastType = t;
+        m_lastTypeName = typeName;
+    }
+    void append(const ApiRecord &rec) {
+        if (!m_lastPkg || m_lastPkgName != rec.pkg) {
+            QString pkgName = string(rec.pkg);
+            m_lastPkg = m_pkgs->findPackage(pkgName);
+            if (!m_lastPkg) {
+                m_lastPkg = m_pkgs->newPackage(pkgName);
+                m_pkgs->appendPackage(m_lastPkg);
+            }
+            m_lastPkgName = rec.pkg;
+            m_lastType = 0;
+        }
+        switch (rec.kind) {
+        case ApiRecord::Var:
+        case ApiRecord::Const:
+        case ApiRecord::Func: {
+            QString name = string(rec.name);
+            if (m_lastPkg->findValue(name) == 0) {
+                PkgApiEnum typ = rec.kind == ApiRecord::Var ? VarApi :
+                                 rec.kind == ApiRecord::Const ? ConstApi : FuncApi;
+                m_lastPkg->appendValue(m_pkgs->newValue(typ,name,string(rec.exp)));
+            }
+            break;
+        }
+        case ApiRecord::Method:
+        case ApiRecord::StructField:
+        case ApiRecord::InterfaceMethod: {
+            Type *t = lastType(rec.typeName,rec.kind == ApiRecord::InterfaceMethod ? InterfaceApi : StructApi);
+            QString name = string(rec.name);
+            if (t->findValue(name) == 0) {
+                PkgApiEnum typ = rec.kind == ApiRecord::StructField ? TypeVarApi : TypeMethodApi;
+                t->appendValue(m_pkgs->newValue(typ,name,string(rec.exp)));
+            }
+            break;
+        }
+        case ApiRecord::StructEmbedded: {
+            Type *t = lastType(rec.typeName,StructApi);
+            QString emName = string(rec.exp);
+            if (!t->embeddedList.contains(emName)) {
+                t->embeddedList.append(m_pkgs->intern(emName));
+            }
+            break;
+        }
+        case ApiRecord::StructType:
+            setLastType(findType(rec.typeName,StructApi,string(rec.exp)),rec.typeName);
+            break;
+        case ApiRecord::InterfaceType:
+            setLastType(findType(rec.typeName,InterfaceApi,string(rec.exp)),rec.typeName);
+            break;
+        case ApiRecord::Type:
+            setLastType(findType(rec.typeName,TypeApi,string(rec.exp)),rec.typeName);
+            break;
+        }
+    }
+protected:
+    Packages *m_pkgs;
+    Package  *m_lastPkg;
+    Type     *m_lastType;
+    ApiToken  m_lastPkgName;
+    ApiToken  m_lastTypeName;
+    QHash<QByteArray,QString> m_strings;
+};
+
 GolangApi::GolangApi(QObject *parent) :
-    LiteApi::IGolangApi(parent)
+    LiteApi::IGolangApi(parent), m_parseTime(0), m_buildTime(0), m_fromCache(false)
+{
+    m_index = new GolangApiIndex;
+}
+
+GolangApi::~GolangApi()
+{
+    delete m_index;
+}
+
+void GolangApi::setCacheFile(const QString &fileName)
 {
+    m_cacheFile = fileName;
 }
 
 bool GolangApi::load(const QString &fileName)
@@ -49,240 +170,97 @@ bool GolangApi::load(const QString &fileName)
     if (!file.open(QFile::ReadOnly)) {
         return false;
     }
-    QTextStream stream(&file);
-    stream.setCodec("utf-8");
-    return loadStream(&stream);
+    QFileInfo info(fileName);
+    uint mtime = info.lastModified().toTime_t();
+    //unchanged source file, skip reading it at all
+    if (!m_cacheFile.isEmpty() && loadCache(m_cacheFile,QByteArray(),mtime,info.size())) {
+        return true;
+    }
+    return loadData(file.readAll(),mtime,info.size());
 }
 
-bool GolangApi::loadStream(QTextStream *stream)
+bool GolangApi::loadFiles(const QStringList &files)
 {
-    m_pkgs.clear();
-
-    //pkg syscall (darwin-386), const TIOCSBRK ideal-int
-
-    //var
-    //pkg archive/tar, var ErrFieldTooLong error
-
-    //const
-    //pkg archive/tar, const TypeBlock ideal-char
-    //pkg crypto/sha512, const BlockSize ideal-int
-    //pkg archive/zip, const Deflate uint16
-
-    //type-const
-    //pkg go/ast, type ObjKind int
-    //pkg syscall, type Errno uintptr
-    //pkg syscall (windows-amd64), const ECOMM Errno
-
-    // func
-    //pkg archive/tar, func NewReader(io.Reader) *Reader
-    //pkg bytes, func FieldsFunc([]byte, func(rune) bool) [][]byte
-
-    //type-var,method
-    //pkg archive/tar, type Header struct
-    //pkg archive/tar, type Header struct, AccessTime time.Time
-    //pkg archive/tar, method (*Reader) Next() (*Header, error)
-    //pkg archive/zip, method (*File) Open() (io.ReadCloser, error)
-    //pkg bufio, method (ReadWriter) Available() int
-
-    //type-interface
-    //pkg container/heap, type Interface interface { Len, Less, Pop, Push, Swap }
-    //pkg container/heap, type Interface interface, Len() int
-
-    QRegExp reg("^pkg\\s([\\w\\-\\.\\/]+)(\\s\\(([\\w\\-]+)\\))?,\\s(\\w+)");
-    QRegExp regm("\\(\\*?([\\w\\-]+)\\)\\s*(\\w+)");
-    Package *lastPkg = 0;
-    Type *lastType = 0;
-    while (!stream->atEnd()) {
-        QString line = stream->readLine();
-        int pos = reg.indexIn(line);
-        if (pos < 0) {
+    QList<QByteArray> dataList;
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    foreach (const QString &fileName, files) {
+        QFile file(fileName);
+        if (!file.open(QFile::ReadOnly)) {
             continue;
         }
-        // 1 pkgname
-        // 2 ? (system)
-        // 3 ? system
-        // 4 const|func|method|var|type
-        QString pkgName = reg.cap(1);
-//        if (!reg.cap(3).isEmpty()) {
-//            pkg = reg.cap(2)+"."+pkg;
-//        }
-        if (!lastPkg || lastPkg->name != pkgName) {
-            lastPkg = m_pkgs.findPackage(pkgName);
-            if (!lastPkg) {
-                lastPkg = new Package(pkgName);
-                m_pkgs.pkgList.append(lastPkg);
-                lastType = 0;
-            }
-        }
-        QString right = line.mid(reg.cap().length()).trimmed();
-        QString flag = reg.cap(4);
-        if (flag == "var") {
-            ///pkg archive/tar, var ErrFieldTooLong error
-            int pos = right.indexOf(" ");
-            QString name = right.left(pos);
-            if (pos != -1 && lastPkg->findValue(name) == 0) {
-                lastPkg->valueList.append(new Value(VarApi,name,right.mid(pos+1)));
-            }
-        } else if (flag == "const") {
-            //pkg syscall (windows-amd64), const ECOMM Errno
-            int pos = right.indexOf(" ");
-            QString name = right.left(pos);
-            if (pos != -1 && lastPkg->findValue(name) == 0) {
-                lastPkg->valueList.append(new Value(ConstApi,name,right.mid(pos+1)));
-            }
-        } else if (flag == "func") {
-            //pkg bytes, func FieldsFunc([]byte, func(rune) bool) [][]byte
-            int pos = right.indexOf("(");
-            QString name = right.left(pos);
-            if (pos != -1 && lastPkg->findValue(name) == 0) {
-                lastPkg->valueList.append(new Value(FuncApi,name,right.mid(pos)));
-            }
-        } else if (flag == "method") {
-            //pkg archive/tar, method (*Reader) Next() (*Header, error)
-            //pkg archive/zip, method (*File) Open() (io.ReadCloser, error)
-            //pkg bufio, method (ReadWriter) Available() int
-            int pos = regm.indexIn(right);
-            if (pos != -1) {
-                QString typeName = regm.cap(1);
-                QString name = regm.cap(2);
-                QString exp = right.mid(regm.cap().length()).trimmed();
-                if (lastType == 0 || lastType->name != typeName || lastType->typ == StructApi) {
-                    lastType = lastPkg->findType(typeName);
-                    if (!lastType) {
-                        lastType = new Type(StructApi,typeName,"struct");
-                        lastPkg->typeList.append(lastType);
-                    }
-                }
-                if (lastType->findValue(name) == 0) {
-                    lastType->valueList.append(new Value(TypeMethodApi,name,exp));
-                }
-            }
-        } else if (flag == "type") {
-            //pkg go/ast, type ObjKind int
-            //pkg archive/tar, type Header struct
-            //pkg archive/tar, type Header struct, AccessTime time.Time
-            //pkg container/heap, type Interface interface { Len, Less, Pop, Push, Swap }
-            //pkg container/heap, type Interface interface, Len() int
-            int pos = right.indexOf(" ");
-            if (pos != -1) {
-                QString typeName = right.left(pos);
-                QString exp = right.mid(pos+1);
-                if (exp == "struct") {
-                    lastType = lastPkg->findType(typeName);
-                    if (!lastType) {
-                        lastType = new Type(StructApi,typeName,exp);
-                        lastPkg->typeList.append(lastType);
-                    }
-                } else if (exp.startsWith("struct,")) {
-                    QString last = exp.mid(7).trimmed();
-                    int pos2 = last.indexOf(" ");
-                    if (pos2 != -1) {
-                        if (lastType == 0 || lastType->name != typeName || lastType->typ == StructApi) {
-                            lastType = lastPkg->findType(typeName);
-                            if (!lastType) {
-                                lastType = new Type(StructApi,typeName,"struct");
-                                lastPkg->typeList.append(lastType);
-                            }
-                        }
-                        QString name = last.left(pos2);
-                        if (name == "embedded") {
-                            QString emName = last.mid(pos2+1);
-                            if (!lastType->embeddedList.contains(emName)) {
-                                lastType->embeddedList.append(emName);
-                            }
-                        } else if (lastType->findValue(name) == 0){
-                            lastType->valueList.append(new Value(TypeVarApi,name,last.mid(pos2+1)));
-                        }
-                    }
-                } else if (exp.startsWith("interface {")) {
-                    lastType = lastPkg->findType(typeName);
-                    if (!lastType) {
-                        lastType = new Type(InterfaceApi,typeName,exp);
-                        lastPkg->typeList.append(lastType);
-                    }
-                } else if (exp.startsWith("interface,")) {
-                    QString last = exp.mid(10).trimmed();
-                    int pos2 = last.indexOf("(");
-                    if (pos2 != -1) {
-                        if (lastType == 0 || lastType->name != typeName || lastType->typ == StructApi) {
-                            lastType = lastPkg->findType(typeName);
-                            if (!lastType) {
-                                lastType = new Type(InterfaceApi,typeName,"struct");
-                                lastPkg->typeList.append(lastType);
-                            }
-                        }
-                        QString name = last.left(pos2);
-                        if (lastType->findValue(name) == 0) {
-                            lastType->valueList.append(new Value(TypeMethodApi,name,last.mid(pos2)));
-                        }
-                    }
-                } else {
-                    lastType = lastPkg->findType(typeName);
-                    if (!lastType) {
-                        lastType = new Type(TypeApi,typeName,exp);
-                        lastPkg->typeList.append(lastType);
-                    }
-                }
-            }
-        }
+        QByteArray data = file.readAll();
+        hash.addData(data);
+        dataList.append(data);
+    }
+    if (dataList.isEmpty()) {
+        return false;
+    }
+    return loadDataList(dataList,hash.result());
+}
+
+bool GolangApi::loadData(const QByteArray &data, uint mtime, qint64 size)
+{
+    QByteArray hash;
+    if (!m_cacheFile.isEmpty()) {
+        hash = QCryptographicHash::hash(data,QCryptographicHash::Md5);
+    }
+    return loadDataList(QList<QByteArray>() << data,hash,mtime,size);
+}
+
+bool GolangApi::loadDataList(const QList<QByteArray> &dataList, const QByteArray &hash, uint mtime, qint64 size)
+{
+    if (!m_cacheFile.isEmpty() && loadCache(m_cacheFile,hash,mtime,size)) {
+        return true;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    QList<ApiRecordList> recordsList;
+    GolangApiParser::parseAll(dataList,recordsList);
+    m_parseTime = timer.elapsed();
+    m_pkgs.clear();
+    ApiBuilder builder(&m_pkgs);
+    foreach (const ApiRecordList &records, recordsList) {
+        builder.append(records);
+    }
+    m_buildTime = timer.elapsed()-m_parseTime;
+    m_fromCache = false;
+    if (!m_cacheFile.isEmpty()) {
+        saveCache(m_cacheFile,hash,mtime,size);
     }
+    return true;
+}
 
-//    QRegExp reg("^pkg\\s([\\w\\/]+)(\\s\\(([\\w-]+)\\))?,\\s(\\w+)(\\s\\(\\*?([\\w\\-]+)\\))?\\s(\\w+)");
-//    QRegExp reg2("^(\\w+),\\s+(\\w+)");
-//    while (!stream->atEnd()) {
-//        QString line = stream->readLine().trimmed();
-//        // 1 pkgname
-//        // 2 ? (system)
-//        // 3 ? system
-//        // 4 const|func|method|var|type
-//        // 5 ? (method-type)
-//        // 6 ? method-type
-//        // 7 value
-//        int pos = reg.indexIn(line);
-//        if (pos != -1) {
-//            QString typeVar;
-//            int next = reg2.indexIn(line.right(line.length()-reg.cap().length()).trimmed());
-//            if (next != -1) {
-//                typeVar = reg2.cap(2);
-//            }
-
-//            //qDebug() << reg.cap() << reg.captureCount();
-//            QString pkg = reg.cap(1);
-//            //QString sys = reg.cap(3);
-//            QString flag = reg.cap(4);
-//            QString method_type = reg.cap(6);
-//            QString value = reg.cap(7);
-
-//            QMap<QString,Package>::iterator it = pkgMap.find(pkg);
-//            if (it == pkgMap.end()) {
-//                it = pkgMap.insert(pkg,Package());
-//            }
-
-//            if (flag == "const") {
-//                it->appendConst(value);
-//                //constList.append(tag);
-//            } else if (flag == "func") {
-//                //funcList.append(tag);
-//                it->appendFunc(value);
-//            } else if (flag == "method") {
-//                //methodList.append(tag);
-//                it->appendTypeMethod(method_type,value);
-//            } else if (flag == "type") {
-//                //typeList.append(tag);
-//                if (!typeVar.isEmpty()) {
-//                    it->appendTypeVar(value,typeVar);
-//                } else {
-//                    it->insertType(value);
-//                }
-//            } else if (flag == "var") {
-//                //varList.append(tag);
-//                it->appendVar(value);
-//            }
-//        }
-//    }
+bool GolangApi::loadStream(QTextStream *stream)
+{
+    QByteArray data = stream->readAll().toUtf8();
+    QList<ApiRecordList> recordsList;
+    GolangApiParser::parseAll(QList<QByteArray>() << data,recordsList);
+    m_parseTime = 0;
+    m_buildTime = 0;
+    m_fromCache = false;
+    m_pkgs.clear();
+    ApiBuilder builder(&m_pkgs);
+    foreach (const ApiRecordList &records, recordsList) {
+        builder.append(records);
+    }
     return true;
 }
 
+void GolangApi::buildIndex()
+{
+    m_index->build(m_pkgs);
+}
+
+void GolangApi::clearIndex()
+{
+    m_index->clear();
+}
+
+const GolangApiIndex *GolangApi::index() const
+{
+    return m_index;
+}
+
 QStringList GolangApi::all(int flag) const
 {
     QStringList finds;
@@ -494,6 +472,43 @@ PkgApiEnum GolangApi::findExp(const QString &tag, QString &exp) const
     return NullApi;
 }
 
+QString Packages::memoryReport() const
+{
+    qint64 stringBytes = 0;
+    foreach (const QString &text, m_strings) {
+        stringBytes += text.size()*sizeof(QChar);
+    }
+    //pointer arrays of the package and type member lists
+    qint64 listBytes = 0;
+    foreach (Package *pkg, pkgList) {
+        listBytes += (pkg->valueList.size()+pkg->typeList.size())*sizeof(void*);
+        foreach (Type *typ, pkg->typeList) {
+            listBytes += typ->valueList.size()*sizeof(void*);
+        }
+    }
+    return QString("packages %1, types %2, values %3, node arena %4 KB, member lists %5 KB, "
+                   "strings %6 unique of %7 (%8 KB, %9 KB before interning)")
+            .arg(m_pkgArena.count()).arg(m_typeArena.count()).arg(m_valueArena.count())
+            .arg((m_pkgArena.memory()+m_typeArena.memory()+m_valueArena.memory())/1024)
+            .arg(listBytes/1024)
+            .arg(m_strings.size()).arg(m_stringRefs)
+            .arg(stringBytes/1024).arg(m_stringRefBytes/1024);
+}
+
+QString GolangApi::memoryReport() const
+{
+    QString report = QString("%1, name index %2 KB").arg(m_pkgs.memoryReport())
+            .arg(m_index->memory()/1024);
+    if (m_fromCache) {
+        return report+", loaded from cache";
+    }
+    if (m_parseTime == 0 && m_buildTime == 0) {
+        return report;
+    }
+    return QString("%1, parse %2 ms, build %3 ms").arg(report)
+            .arg(m_parseTime).arg(m_buildTime);
+}
+
 GolangApiThread::GolangApiThread(QObject *parent)
     :QThread(parent)
 {
@@ -507,16 +522,30 @@ GolangApiThread::~GolangApiThread()
     }
 }
 
+void GolangApiThread::setCacheFile(const QString &fileName)
+{
+    m_api->setCacheFile(fileName);
+}
+
 void GolangApiThread::loadData(const QByteArray &data)
 {
     m_data = data;
     m_file.clear();
+    m_files.clear();
     QThread::start();
 }
 
 void GolangApiThread::loadFile(const QString &fileName)
 {
     m_file = fileName;
+    m_files.clear();
+    QThread::start();
+}
+
+void GolangApiThread::loadFiles(const QStringList &files)
+{
+    m_files = files;
+    m_file.clear();
     QThread::start();
 }
 
@@ -527,7 +556,12 @@ LiteApi::IGolangApi* GolangApiThread::api() const
 
 QStringList GolangApiThread::all() const
 {
-    return m_all;
+    return m_api->all(LiteApi::AllGolangApi);
+}
+
+const GolangApiIndex *GolangApiThread::index() const
+{
+    return m_api->index();
 }
 
 QByteArray GolangApiThread::data() const
@@ -537,19 +571,17 @@ QByteArray GolangApiThread::data() const
 
 void GolangApiThread::run()
 {
+    //the index points into the nodes, drop it before they are replaced
+    m_api->clearIndex();
+    bool ok = false;
     if (!m_file.isEmpty()) {
-        QFile f(m_file);
-        if (!f.open(QFile::ReadOnly)) {
-            return;
-        }
-        QTextStream s(&f);
-        if (m_api->loadStream(&s)) {
-            m_all = m_api->all(LiteApi::AllGolangApi);
-        }
+        ok = m_api->load(m_file);
+    } else if (!m_files.isEmpty()) {
+        ok = m_api->loadFiles(m_files);
     } else {
-        QTextStream s(&m_data);
-        if (m_api->loadStream(&s)) {
-            m_all = m_api->all(LiteApi::AllGolangApi);
-        }
+        ok = m_api->loadData(m_data);
+    }
+    if (ok) {
+        m_api->buildIndex();
     }
 }
@@ -29,9 +29,53 @@
 #include <QTextStream>
 #include <QSharedData>
 #include <QThread>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <new>
+#include <stdlib.h>
 
 using namespace LiteApi;
 
+// NodeArena allocates api nodes in large blocks and destroys them all at
+// once, the full Go api has several hundred thousand small nodes.
+template <typename T>
+class NodeArena
+{
+public:
+    NodeArena() : m_used(BlockSize), m_count(0) {}
+    ~NodeArena() { clear(); }
+    T *alloc() {
+        if (m_used == BlockSize) {
+            m_blocks.append((T*)::malloc(sizeof(T)*BlockSize));
+            m_used = 0;
+        }
+        T *node = new (m_blocks.last()+m_used) T;
+        m_used++;
+        m_count++;
+        return node;
+    }
+    void clear() {
+        for (int i = 0; i < m_blocks.size(); i++) {
+            int used = (i == m_blocks.size()-1) ? m_used : int(BlockSize);
+            for (int j = 0; j < used; j++) {
+                m_blocks[i][j].~T();
+            }
+            ::free(m_blocks[i]);
+        }
+        m_blocks.clear();
+        m_used = BlockSize;
+        m_count = 0;
+    }
+    int count() const { return m_count; }
+    qint64 memory() const { return qint64(m_blocks.size())*BlockSize*sizeof(T); }
+private:
+    enum { BlockSize = 1024 };
+    QVector<T*> m_blocks;
+    int         m_used;
+    int         m_count;
+};
+
 class Value
 {
 public:
@@ -51,19 +95,19 @@ public:
     Type() : typ(NullApi), pos(-1) {}
     Type(PkgApiEnum _typ, const QString &_name, const QString &_exp) :
         typ(_typ), name(_name), exp(_exp) {}
-    ~Type() { clear(); }
     void clear() {
-        qDeleteAll(valueList);
         valueList.clear();
+        valueMap.clear();
     }
     bool IsNull() const { return typ == NullApi; }
-    Value *findValue(const QString &valueName) {
-        foreach(Value *val, valueList) {
-            if (val->name == valueName) {
-                return val;
-            }
+    Value *findValue(const QString &valueName) const {
+        return valueMap.value(valueName);
+    }
+    void appendValue(Value *val) {
+        valueList.append(val);
+        if (!valueMap.contains(val->name)) {
+            valueMap.insert(val->name,val);
         }
-        return 0;
     }
 public:
     PkgApiEnum    typ;
@@ -72,6 +116,7 @@ public:
     QString     exp;
     QStringList     embeddedList;
     QList<Value*> valueList;
+    QHash<QString,Value*> valueMap;
 };
 
 class Package
@@ -80,28 +125,29 @@ public:
     Package() : typ(PkgApi),pos(-1) {}
     Package(const QString &_name) :
         typ(PkgApi),name(_name) {}
-    ~Package()  { clear(); }
     void clear() {
-        qDeleteAll(valueList);
-        qDeleteAll(typeList);
         valueList.clear();
         typeList.clear();
+        valueMap.clear();
+        typeMap.clear();
     }
-    Type *findType(const QString &typeName) {
-        foreach(Type *typ, typeList) {
-            if (typ->name == typeName) {
-                return typ;
-            }
+    Type *findType(const QString &typeName) const {
+        return typeMap.value(typeName);
+    }
+    Value *findValue(const QString &valueName) const {
+        return valueMap.value(valueName);
+    }
+    void appendType(Type *typ) {
+        typeList.append(typ);
+        if (!typeMap.contains(typ->name)) {
+            typeMap.insert(typ->name,typ);
         }
-        return 0;
     }
-    Value *findValue(const QString &valueName) {
-        foreach(Value *val, valueList) {
-            if (val->name == valueName) {
-                return val;
-            }
+    void appendValue(Value *val) {
+        valueList.append(val);
+        if (!valueMap.contains(val->name)) {
+            valueMap.insert(val->name,val);
         }
-        return 0;
     }
 public:
     PkgApiEnum    typ;
@@ -109,27 +155,76 @@ public:
     QString       name;
     QList<Value*> valueList;
     QList<Type*>  typeList;
+    QHash<QString,Value*> valueMap;
+    QHash<QString,Type*>  typeMap;
 };
 
+// Packages owns every node through its arenas, names and expressions
+// are interned so equal strings share one buffer.
 class Packages
 {
 public:
-    Packages() {}
+    Packages() : m_stringRefs(0), m_stringRefBytes(0) {}
     ~Packages() { clear(); }
     void clear() {
-        qDeleteAll(pkgList);
         pkgList.clear();
+        pkgMap.clear();
+        m_valueArena.clear();
+        m_typeArena.clear();
+        m_pkgArena.clear();
+        m_strings.clear();
+        m_stringRefs = 0;
+        m_stringRefBytes = 0;
+    }
+    QString intern(const QString &text) {
+        m_stringRefs++;
+        m_stringRefBytes += text.size()*sizeof(QChar);
+        QSet<QString>::const_iterator it = m_strings.constFind(text);
+        if (it != m_strings.constEnd()) {
+            return *it;
+        }
+        m_strings.insert(text);
+        return text;
+    }
+    Package *newPackage(const QString &name) {
+        Package *pkg = m_pkgArena.alloc();
+        pkg->name = intern(name);
+        return pkg;
     }
+    Type *newType(PkgApiEnum typ, const QString &name, const QString &exp) {
+        Type *t = m_typeArena.alloc();
+        t->typ = typ;
+        t->name = intern(name);
+        t->exp = intern(exp);
+        return t;
+    }
+    Value *newValue(PkgApiEnum typ, const QString &name, const QString &exp) {
+        Value *v = m_valueArena.alloc();
+        v->typ = typ;
+        v->name = intern(name);
+        v->exp = intern(exp);
+        return v;
+    }
+    QString memoryReport() const;
     Package *findPackage(const QString &pkgName) const {
-        foreach(Package *pkg, pkgList) {
-            if (pkg->name == pkgName) {
-                return pkg;
-            }
+        return pkgMap.value(pkgName);
+    }
+    void appendPackage(Package *pkg) {
+        pkgList.append(pkg);
+        if (!pkgMap.contains(pkg->name)) {
+            pkgMap.insert(pkg->name,pkg);
         }
-        return 0;
     }
 public:
     QList<Package*> pkgList;
+    QHash<QString,Package*> pkgMap;
+protected:
+    NodeArena<Package> m_pkgArena;
+    NodeArena<Type>    m_typeArena;
+    NodeArena<Value>   m_valueArena;
+    QSet<QString>      m_strings;
+    int                m_stringRefs;
+    qint64             m_stringRefBytes;
 };
 
 /*
@@ -255,19 +350,39 @@ protected:
 };
 */
 
+class GolangApiIndex;
+
 class GolangApi : public LiteApi::IGolangApi
 {
     Q_OBJECT
 public:
     GolangApi(QObject *parent = 0);
+    ~GolangApi();
+    void setCacheFile(const QString &fileName);
     bool load(const QString &fileName);
+    bool loadFiles(const QStringList &files);
+    bool loadData(const QByteArray &data, uint mtime = 0, qint64 size = 0);
+    bool loadDataList(const QList<QByteArray> &dataList, const QByteArray &hash, uint mtime = 0, qint64 size = 0);
     bool loadStream(QTextStream *stream);
+    // the index is not kept up to date by the load functions
+    void buildIndex();
+    void clearIndex();
+    const GolangApiIndex *index() const;
     virtual QStringList all(int flag) const;
     virtual PkgApiEnum findExp(const QString &tag, QString &exp) const;
     virtual QStringList findDocUrl(const QString &tag) const;
     virtual QString findDocInfo(const QString &tag) const;
+    virtual QString memoryReport() const;
+protected:
+    bool loadCache(const QString &fileName, const QByteArray &hash, uint mtime, qint64 size);
+    bool saveCache(const QString &fileName, const QByteArray &hash, uint mtime, qint64 size) const;
 protected:
     Packages m_pkgs;
+    QString  m_cacheFile;
+    qint64   m_parseTime;
+    qint64   m_buildTime;
+    bool     m_fromCache;
+    GolangApiIndex *m_index;
 };
 
 class GolangApiThread : public QThread
@@ -275,16 +390,19 @@ class GolangApiThread : public QThread
 public:
     GolangApiThread(QObject *parent);
     ~GolangApiThread();
+    void setCacheFile(const QString &fileName);
     void loadData(const QByteArray &data);
     void loadFile(const QString &fileName);
+    void loadFiles(const QStringList &files);
     LiteApi::IGolangApi* api() const;
     QStringList all() const;
+    const GolangApiIndex *index() const;
     QByteArray data() const;
 protected:
     virtual void run();
     QByteArray m_data;
     QString    m_file;
-    QStringList m_all;
+    QStringList m_files;
     GolangApi  *m_api;
 };
 
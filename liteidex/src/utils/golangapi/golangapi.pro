@@ -4,7 +4,14 @@ CONFIG += staticlib
 
 include (../../liteideutils.pri)
 include(../../api/golangdocapi/golangdocapi.pri)
+include(../fileutil/fileutil.pri)
 
-SOURCES += golangapi.cpp
+SOURCES += golangapi.cpp \
+    golangapicache.cpp \
+    golangapiparser.cpp \
+    golangapiindex.cpp
 
-HEADERS += golangapi.h
+HEADERS += golangapi.h \
+    golangapicache.h \
+    golangapiparser.h \
+    golangapiindex.h
@@ -0,0 +1,274 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapicache.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "golangapi.h"
+#include "golangapicache.h"
+#include "fileutil/fileutil.h"
+#include <QFile>
+#include <QVector>
+#include <string.h>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+class CacheStringWriter
+{
+public:
+    quint32 add(const QString &text)
+    {
+        QHash<QString,quint32>::const_iterator it = m_offsetMap.find(text);
+        if (it != m_offsetMap.end()) {
+            return it.value();
+        }
+        quint32 offset = m_data.size();
+        quint32 size = text.size();
+        m_data.append((const char*)&size,sizeof(size));
+        m_data.append((const char*)text.constData(),size*sizeof(QChar));
+        while (m_data.size() % 4) {
+            m_data.append(char(0));
+        }
+        m_offsetMap.insert(text,offset);
+        return offset;
+    }
+    QByteArray data() const
+    {
+        return m_data;
+    }
+protected:
+    QHash<QString,quint32> m_offsetMap;
+    QByteArray m_data;
+};
+
+class CacheStringReader
+{
+public:
+    CacheStringReader(const uchar *data, quint32 size) : m_data(data), m_size(size), m_valid(true)
+    {
+    }
+    // same offset gives the same shared string
+    QString string(quint32 offset)
+    {
+        QHash<quint32,QString>::const_iterator it = m_stringMap.find(offset);
+        if (it != m_stringMap.end()) {
+            return it.value();
+        }
+        quint32 size = 0;
+        if (offset+sizeof(size) > m_size || (offset % 4)) {
+            m_valid = false;
+            return QString();
+        }
+        memcpy(&size,m_data+offset,sizeof(size));
+        if (size > (m_size-offset-sizeof(size))/sizeof(QChar)) {
+            m_valid = false;
+            return QString();
+        }
+        QString text((const QChar*)(m_data+offset+sizeof(size)),size);
+        m_stringMap.insert(offset,text);
+        return text;
+    }
+    bool isValid() const
+    {
+        return m_valid;
+    }
+protected:
+    const uchar *m_data;
+    quint32      m_size;
+    bool         m_valid;
+    QHash<quint32,QString> m_stringMap;
+};
+
+static bool checkTable(qint64 fileSize, quint32 offset, quint32 count, quint32 size)
+{
+    return (offset % 4) == 0 && qint64(offset)+qint64(count)*size <= fileSize;
+}
+
+bool GolangApi::saveCache(const QString &fileName, const QByteArray &hash, uint mtime, qint64 size) const
+{
+    CacheStringWriter strings;
+    QVector<GolangApiCachePackage> pkgs;
+    QVector<GolangApiCacheType> types;
+    QVector<GolangApiCacheValue> values;
+    QVector<quint32> embedded;
+    foreach (Package *pkg, m_pkgs.pkgList) {
+        GolangApiCachePackage p;
+        p.name = strings.add(pkg->name);
+        p.firstType = types.size();
+        p.typeCount = pkg->typeList.size();
+        foreach (Type *typ, pkg->typeList) {
+            GolangApiCacheType t;
+            t.name = strings.add(typ->name);
+            t.exp = strings.add(typ->exp);
+            t.typ = typ->typ;
+            t.firstValue = values.size();
+            t.valueCount = typ->valueList.size();
+            t.firstEmbedded = embedded.size();
+            t.embeddedCount = typ->embeddedList.size();
+            foreach (Value *value, typ->valueList) {
+                GolangApiCacheValue v;
+                v.name = strings.add(value->name);
+                v.exp = strings.add(value->exp);
+                v.typ = value->typ;
+                values.append(v);
+            }
+            foreach (QString name, typ->embeddedList) {
+                embedded.append(strings.add(name));
+            }
+            types.append(t);
+        }
+        p.firstValue = values.size();
+        p.valueCount = pkg->valueList.size();
+        foreach (Value *value, pkg->valueList) {
+            GolangApiCacheValue v;
+            v.name = strings.add(value->name);
+            v.exp = strings.add(value->exp);
+            v.typ = value->typ;
+            values.append(v);
+        }
+        pkgs.append(p);
+    }
+
+    QByteArray stringData = strings.data();
+    GolangApiCacheHeader head;
+    memset(&head,0,sizeof(head));
+    memcpy(head.magic,GOLANGAPI_CACHE_MAGIC,sizeof(GOLANGAPI_CACHE_MAGIC));
+    head.version = GOLANGAPI_CACHE_VERSION;
+    head.byteOrder = GOLANGAPI_CACHE_BYTEORDER;
+    memcpy(head.hash,hash.constData(),qMin(hash.size(),int(sizeof(head.hash))));
+    head.mtime = mtime;
+    head.size = size;
+    head.pkgCount = pkgs.size();
+    head.typeCount = types.size();
+    head.valueCount = values.size();
+    head.embeddedCount = embedded.size();
+    head.pkgOffset = sizeof(head);
+    head.typeOffset = head.pkgOffset+pkgs.size()*sizeof(GolangApiCachePackage);
+    head.valueOffset = head.typeOffset+types.size()*sizeof(GolangApiCacheType);
+    head.embeddedOffset = head.valueOffset+values.size()*sizeof(GolangApiCacheValue);
+    head.stringOffset = head.embeddedOffset+embedded.size()*sizeof(quint32);
+    head.stringSize = stringData.size();
+
+    QByteArray data;
+    data.reserve(head.stringOffset+head.stringSize);
+    data.append((const char*)&head,sizeof(head));
+    data.append((const char*)pkgs.constData(),pkgs.size()*sizeof(GolangApiCachePackage));
+    data.append((const char*)types.constData(),types.size()*sizeof(GolangApiCacheType));
+    data.append((const char*)values.constData(),values.size()*sizeof(GolangApiCacheValue));
+    data.append((const char*)embedded.constData(),embedded.size()*sizeof(quint32));
+    data.append(stringData);
+    // other instances may have the old snapshot mapped, never rewrite it in place
+    return FileUtil::replaceFile(fileName,data);
+}
+
+// map the snapshot and build Packages from its tables, the source is hit
+// by md5 hash, or by mtime and size when hash is empty.
+bool GolangApi::loadCache(const QString &fileName, const QByteArray &hash, uint mtime, qint64 size)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(GolangApiCacheHeader))) {
+        return false;
+    }
+    const uchar *data = file.map(0,fileSize);
+    if (!data) {
+        return false;
+    }
+    const GolangApiCacheHeader *head = (const GolangApiCacheHeader*)data;
+    bool hit = memcmp(head->magic,GOLANGAPI_CACHE_MAGIC,sizeof(GOLANGAPI_CACHE_MAGIC)) == 0 &&
+            head->version == GOLANGAPI_CACHE_VERSION &&
+            head->byteOrder == GOLANGAPI_CACHE_BYTEORDER &&
+            checkTable(fileSize,head->pkgOffset,head->pkgCount,sizeof(GolangApiCachePackage)) &&
+            checkTable(fileSize,head->typeOffset,head->typeCount,sizeof(GolangApiCacheType)) &&
+            checkTable(fileSize,head->valueOffset,head->valueCount,sizeof(GolangApiCacheValue)) &&
+            checkTable(fileSize,head->embeddedOffset,head->embeddedCount,sizeof(quint32)) &&
+            checkTable(fileSize,head->stringOffset,head->stringSize,1) &&
+            qint64(head->stringOffset)+head->stringSize == fileSize;
+    if (hit) {
+        if (hash.isEmpty()) {
+            hit = mtime != 0 && head->mtime == mtime && head->size == size;
+        } else {
+            hit = hash.size() == int(sizeof(head->hash)) && memcmp(head->hash,hash.constData(),hash.size()) == 0;
+        }
+    }
+    if (!hit) {
+        file.unmap((uchar*)data);
+        return false;
+    }
+
+    const GolangApiCachePackage *pkgs = (const GolangApiCachePackage*)(data+head->pkgOffset);
+    const GolangApiCacheType *types = (const GolangApiCacheType*)(data+head->typeOffset);
+    const GolangApiCacheValue *values = (const GolangApiCacheValue*)(data+head->valueOffset);
+    const quint32 *embedded = (const quint32*)(data+head->embeddedOffset);
+    CacheStringReader strings(data+head->stringOffset,head->stringSize);
+
+    m_pkgs.clear();
+    bool valid = true;
+    for (quint32 i = 0; i < head->pkgCount && valid; i++) {
+        const GolangApiCachePackage &p = pkgs[i];
+        if (quint64(p.firstType)+p.typeCount > head->typeCount ||
+                quint64(p.firstValue)+p.valueCount > head->valueCount) {
+            valid = false;
+            break;
+        }
+        Package *pkg = m_pkgs.newPackage(strings.string(p.name));
+        m_pkgs.appendPackage(pkg);
+        for (quint32 j = p.firstType; j < p.firstType+p.typeCount; j++) {
+            const GolangApiCacheType &t = types[j];
+            if (quint64(t.firstValue)+t.valueCount > head->valueCount ||
+                    quint64(t.firstEmbedded)+t.embeddedCount > head->embeddedCount) {
+                valid = false;
+                break;
+            }
+            Type *typ = m_pkgs.newType(PkgApiEnum(t.typ),strings.string(t.name),strings.string(t.exp));
+            pkg->appendType(typ);
+            for (quint32 k = t.firstValue; k < t.firstValue+t.valueCount; k++) {
+                const GolangApiCacheValue &v = values[k];
+                typ->appendValue(m_pkgs.newValue(PkgApiEnum(v.typ),strings.string(v.name),strings.string(v.exp)));
+            }
+            for (quint32 k = t.firstEmbedded; k < t.firstEmbedded+t.embeddedCount; k++) {
+                typ->embeddedList.append(m_pkgs.intern(strings.string(embedded[k])));
+            }
+        }
+        for (quint32 j = p.firstValue; j < p.firstValue+p.valueCount; j++) {
+            const GolangApiCacheValue &v = values[j];
+            pkg->appendValue(m_pkgs.newValue(PkgApiEnum(v.typ),strings.string(v.name),strings.string(v.exp)));
+        }
+    }
+    file.unmap((uchar*)data);
+    if (!valid || !strings.isValid()) {
+        m_pkgs.clear();
+        return false;
+    }
+    m_fromCache = true;
+    m_parseTime = 0;
+    m_buildTime = 0;
+    return true;
+}
@@ -0,0 +1,85 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapicache.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef GOLANGAPICACHE_H
+#define GOLANGAPICACHE_H
+
+#include <QtGlobal>
+
+// binary snapshot of Packages, native byte order, all records 4 bytes
+// aligned so the mapped file is read in place. strings are stored once
+// as [quint32 length][ushort data] and referenced by byte offset.
+
+#define GOLANGAPI_CACHE_MAGIC "LITEAPI"
+#define GOLANGAPI_CACHE_VERSION 1
+#define GOLANGAPI_CACHE_BYTEORDER 0x01020304
+
+struct GolangApiCacheHeader
+{
+    char    magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    char    hash[16];
+    quint32 mtime;
+    quint32 reserved;
+    qint64  size;
+    quint32 pkgCount;
+    quint32 typeCount;
+    quint32 valueCount;
+    quint32 embeddedCount;
+    quint32 pkgOffset;
+    quint32 typeOffset;
+    quint32 valueOffset;
+    quint32 embeddedOffset;
+    quint32 stringOffset;
+    quint32 stringSize;
+};
+
+struct GolangApiCachePackage
+{
+    quint32 name;
+    quint32 firstType;
+    quint32 typeCount;
+    quint32 firstValue;
+    quint32 valueCount;
+};
+
+struct GolangApiCacheType
+{
+    quint32 name;
+    quint32 exp;
+    quint32 typ;
+    quint32 firstValue;
+    quint32 valueCount;
+    quint32 firstEmbedded;
+    quint32 embeddedCount;
+};
+
+struct GolangApiCacheValue
+{
+    quint32 name;
+    quint32 exp;
+    quint32 typ;
+};
+
+#endif // GOLANGAPICACHE_H
@@ -0,0 +1,336 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapiindex.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "golangapiindex.h"
+#include <QtAlgorithms>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+// walks pkg.Type.Value as one string without building it
+class EntryCursor
+{
+public:
+    EntryCursor(const GolangApiEntry &entry) : m_count(0), m_seg(0), m_pos(0) {
+        m_segs[m_count++] = &entry.pkg->name;
+        if (entry.type) {
+            m_segs[m_count++] = &entry.type->name;
+        }
+        if (entry.value) {
+            m_segs[m_count++] = &entry.value->name;
+        }
+    }
+    bool next(QChar &c) {
+        while (m_seg < m_count) {
+            const QString *s = m_segs[m_seg];
+            if (m_pos < s->size()) {
+                c = s->at(m_pos++);
+                return true;
+            }
+            m_seg++;
+            m_pos = 0;
+            if (m_seg < m_count) {
+                c = QLatin1Char('.');
+                return true;
+            }
+        }
+        return false;
+    }
+protected:
+    const QString *m_segs[3];
+    int m_count;
+    int m_seg;
+    int m_pos;
+};
+
+static inline ushort fold(QChar c)
+{
+    return c.toLower().unicode();
+}
+
+static QString foldString(const QString &text)
+{
+    QString key = text;
+    for (int i = 0; i < key.size(); i++) {
+        key[i] = QChar(fold(key.at(i)));
+    }
+    return key;
+}
+
+// case-insensitive order, ties broken by case so the order is total
+static int compareEntry(const GolangApiEntry &a, const GolangApiEntry &b)
+{
+    EntryCursor ca(a);
+    EntryCursor cb(b);
+    QChar x, y;
+    int tie = 0;
+    while (true) {
+        bool hx = ca.next(x);
+        bool hy = cb.next(y);
+        if (!hx || !hy) {
+            if (hx != hy) {
+                return hx ? 1 : -1;
+            }
+            return tie;
+        }
+        if (x != y) {
+            ushort fx = fold(x);
+            ushort fy = fold(y);
+            if (fx != fy) {
+                return fx < fy ? -1 : 1;
+            }
+            if (tie == 0) {
+                tie = x.unicode() < y.unicode() ? -1 : 1;
+            }
+        }
+    }
+}
+
+static int compareName(const QString &a, const QString &b)
+{
+    int n = qMin(a.size(),b.size());
+    for (int i = 0; i < n; i++) {
+        ushort fx = fold(a.at(i));
+        ushort fy = fold(b.at(i));
+        if (fx != fy) {
+            return fx < fy ? -1 : 1;
+        }
+    }
+    return a.size()-b.size();
+}
+
+// <0 sorts before every name starting with key, 0 starts with key
+static int comparePrefix(const GolangApiEntry &entry, const QString &key)
+{
+    EntryCursor cursor(entry);
+    QChar x;
+    for (int i = 0; i < key.size(); i++) {
+        if (!cursor.next(x)) {
+            return -1;
+        }
+        ushort fx = fold(x);
+        if (fx != key.at(i).unicode()) {
+            return fx < key.at(i).unicode() ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static int compareNamePrefix(const QString &name, const QString &key)
+{
+    for (int i = 0; i < key.size(); i++) {
+        if (i >= name.size()) {
+            return -1;
+        }
+        ushort fx = fold(name.at(i));
+        if (fx != key.at(i).unicode()) {
+            return fx < key.at(i).unicode() ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// full name contains key, the name is walked in place from every start
+static bool containsKey(const GolangApiEntry &entry, const QString &key)
+{
+    EntryCursor start(entry);
+    QChar x;
+    while (true) {
+        EntryCursor cursor = start;
+        int i = 0;
+        while (i < key.size() && cursor.next(x) && fold(x) == key.at(i).unicode()) {
+            i++;
+        }
+        if (i == key.size()) {
+            return true;
+        }
+        if (!start.next(x)) {
+            return false;
+        }
+    }
+}
+
+struct EntryLessThan
+{
+    bool operator()(const GolangApiEntry &a, const GolangApiEntry &b) const {
+        return compareEntry(a,b) < 0;
+    }
+};
+
+struct NameLessThan
+{
+    NameLessThan(const QVector<GolangApiEntry> *entries) : m_entries(entries) {}
+    bool operator()(int a, int b) const {
+        int r = compareName(m_entries->at(a).name(),m_entries->at(b).name());
+        return r < 0 || (r == 0 && a < b);
+    }
+    const QVector<GolangApiEntry> *m_entries;
+};
+
+QString GolangApiEntry::fullName() const
+{
+    QString text = pkg->name;
+    if (type) {
+        text += QLatin1Char('.');
+        text += type->name;
+    }
+    if (value) {
+        text += QLatin1Char('.');
+        text += value->name;
+    }
+    return text;
+}
+
+void GolangApiIndex::build(const Packages &pkgs)
+{
+    clear();
+    foreach (Package *pkg, pkgs.pkgList) {
+        m_entries.append(GolangApiEntry(pkg,0,0));
+        foreach (Value *value, pkg->valueList) {
+            m_entries.append(GolangApiEntry(pkg,0,value));
+        }
+        foreach (Type *type, pkg->typeList) {
+            m_entries.append(GolangApiEntry(pkg,type,0));
+            foreach (Value *value, type->valueList) {
+                m_entries.append(GolangApiEntry(pkg,type,value));
+            }
+        }
+    }
+    qStableSort(m_entries.begin(),m_entries.end(),EntryLessThan());
+    m_names.resize(m_entries.size());
+    for (int i = 0; i < m_names.size(); i++) {
+        m_names[i] = i;
+    }
+    qSort(m_names.begin(),m_names.end(),NameLessThan(&m_entries));
+}
+
+void GolangApiIndex::clear()
+{
+    m_entries.clear();
+    m_names.clear();
+}
+
+void GolangApiIndex::prefixRange(const QString &prefix, int &first, int &last) const
+{
+    QString key = foldString(prefix);
+    int lo = 0;
+    int hi = m_entries.size();
+    while (lo < hi) {
+        int mid = (lo+hi)/2;
+        if (comparePrefix(m_entries.at(mid),key) < 0) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    first = lo;
+    hi = m_entries.size();
+    while (lo < hi) {
+        int mid = (lo+hi)/2;
+        if (comparePrefix(m_entries.at(mid),key) <= 0) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    last = lo;
+}
+
+QVector<int> GolangApiIndex::find(const QString &prefix, int flag, int limit) const
+{
+    QVector<int> result;
+    int first = 0;
+    int last = 0;
+    prefixRange(prefix,first,last);
+    for (int i = first; i < last; i++) {
+        if (limit >= 0 && result.size() >= limit) {
+            return result;
+        }
+        if (flag & m_entries.at(i).kind()) {
+            result.append(i);
+        }
+    }
+    if (prefix.isEmpty()) {
+        return result;
+    }
+    QString key = foldString(prefix);
+    int lo = 0;
+    int hi = m_names.size();
+    while (lo < hi) {
+        int mid = (lo+hi)/2;
+        if (compareNamePrefix(m_entries.at(m_names.at(mid)).name(),key) < 0) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (int i = lo; i < m_names.size(); i++) {
+        int index = m_names.at(i);
+        const GolangApiEntry &entry = m_entries.at(index);
+        if (compareNamePrefix(entry.name(),key) != 0) {
+            break;
+        }
+        if (index >= first && index < last) {
+            continue;
+        }
+        if (limit >= 0 && result.size() >= limit) {
+            break;
+        }
+        if (flag & entry.kind()) {
+            result.append(index);
+        }
+    }
+    return result;
+}
+
+QVector<int> GolangApiIndex::match(const QString &text, int flag) const
+{
+    QVector<int> result = find(text,flag);
+    if (text.isEmpty()) {
+        return result;
+    }
+    QString key = foldString(text);
+    QVector<bool> found(m_entries.size(),false);
+    foreach (int index, result) {
+        found[index] = true;
+    }
+    for (int i = 0; i < m_entries.size(); i++) {
+        if (found.at(i)) {
+            continue;
+        }
+        const GolangApiEntry &entry = m_entries.at(i);
+        if (!(flag & entry.kind())) {
+            continue;
+        }
+        if (containsKey(entry,key)) {
+            result.append(i);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,74 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapiindex.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef GOLANGAPIINDEX_H
+#define GOLANGAPIINDEX_H
+
+#include "golangapi.h"
+
+// GolangApiEntry is a handle to one api symbol, it points into the nodes
+// of Packages and is valid until the api is reloaded.
+struct GolangApiEntry
+{
+    GolangApiEntry() : pkg(0), type(0), value(0) {}
+    GolangApiEntry(Package *_pkg, Type *_type, Value *_value) :
+        pkg(_pkg), type(_type), value(_value) {}
+    PkgApiEnum kind() const {
+        return value ? value->typ : (type ? type->typ : PkgApi);
+    }
+    const QString &name() const {
+        return value ? value->name : (type ? type->name : pkg->name);
+    }
+    QString fullName() const;
+    Package *pkg;
+    Type    *type;
+    Value   *value;
+};
+
+// GolangApiIndex keeps every symbol sorted case-insensitive by full name
+// (pkg.Type.Method) and by its own name, prefix queries are two binary
+// searches. names are never materialized, entries compare through the
+// interned node strings.
+class GolangApiIndex
+{
+public:
+    void build(const Packages &pkgs);
+    void clear();
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int size() const { return m_entries.size(); }
+    const GolangApiEntry &at(int i) const { return m_entries.at(i); }
+    qint64 memory() const {
+        return qint64(m_entries.capacity())*sizeof(GolangApiEntry)+qint64(m_names.capacity())*sizeof(int);
+    }
+    // entries in [first,last) have a full name starting with prefix
+    void prefixRange(const QString &prefix, int &first, int &last) const;
+    // full name prefix matches in order, then own name prefix matches
+    QVector<int> find(const QString &prefix, int flag = AllGolangApi, int limit = -1) const;
+    // find() matches first, then every other full name containing text
+    QVector<int> match(const QString &text, int flag = AllGolangApi) const;
+protected:
+    QVector<GolangApiEntry> m_entries;
+    QVector<int>            m_names;
+};
+
+#endif // GOLANGAPIINDEX_H
@@ -0,0 +1,307 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapiparser.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "golangapiparser.h"
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QPair>
+#include <string.h>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+// buffers are split into chunks of about this size for the thread pool
+static const int ParseChunkSize = 512*1024;
+
+bool ApiToken::operator==(const ApiToken &other) const
+{
+    return size == other.size && (data == other.data || memcmp(data,other.data,size) == 0);
+}
+
+// \w of the old regexp, utf-8 lead and trail bytes count as letters
+static inline bool isWordChar(uchar c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+}
+
+static inline bool isSpaceChar(uchar c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static inline const char *skipWord(const char *p, const char *end, bool dash)
+{
+    while (p < end && (isWordChar(*p) || (dash && *p == '-'))) {
+        p++;
+    }
+    return p;
+}
+
+static inline ApiToken trimmed(const char *begin, const char *end)
+{
+    while (begin < end && isSpaceChar(*begin)) {
+        begin++;
+    }
+    while (end > begin && isSpaceChar(*(end-1))) {
+        end--;
+    }
+    return ApiToken(begin,int(end-begin));
+}
+
+static inline int indexOf(const ApiToken &tok, char c)
+{
+    const char *p = (const char*)memchr(tok.data,c,tok.size);
+    return p ? int(p-tok.data) : -1;
+}
+
+static inline bool startsWith(const ApiToken &tok, const char *s, int n)
+{
+    return tok.size >= n && memcmp(tok.data,s,n) == 0;
+}
+
+static inline bool equals(const char *p, const char *end, const char *s, int n)
+{
+    return end-p == n && memcmp(p,s,n) == 0;
+}
+
+// (*Type) Name or (Type) Name
+static bool parseReceiver(const ApiToken &right, ApiRecord &rec)
+{
+    const char *end = right.data+right.size;
+    const char *p = right.data;
+    while ((p = (const char*)memchr(p,'(',end-p)) != 0) {
+        const char *q = p+1;
+        if (q < end && *q == '*') {
+            q++;
+        }
+        const char *typeBegin = q;
+        q = skipWord(q,end,true);
+        if (q > typeBegin && q < end && *q == ')') {
+            rec.typeName = ApiToken(typeBegin,int(q-typeBegin));
+            q++;
+            while (q < end && isSpaceChar(*q)) {
+                q++;
+            }
+            const char *nameBegin = q;
+            q = skipWord(q,end,false);
+            if (q > nameBegin) {
+                rec.name = ApiToken(nameBegin,int(q-nameBegin));
+                rec.exp = trimmed(q,end);
+                return true;
+            }
+        }
+        p++;
+    }
+    return false;
+}
+
+static bool parseType(const ApiToken &right, ApiRecord &rec)
+{
+    int pos = indexOf(right,' ');
+    if (pos == -1) {
+        return false;
+    }
+    rec.typeName = ApiToken(right.data,pos);
+    ApiToken exp(right.data+pos+1,right.size-pos-1);
+    const char *end = exp.data+exp.size;
+    if (equals(exp.data,end,"struct",6)) {
+        rec.kind = ApiRecord::StructType;
+        rec.exp = exp;
+    } else if (startsWith(exp,"struct,",7)) {
+        ApiToken last = trimmed(exp.data+7,end);
+        int pos2 = indexOf(last,' ');
+        if (pos2 == -1) {
+            return false;
+        }
+        rec.name = ApiToken(last.data,pos2);
+        rec.exp = ApiToken(last.data+pos2+1,last.size-pos2-1);
+        if (equals(rec.name.data,rec.name.data+rec.name.size,"embedded",8)) {
+            rec.kind = ApiRecord::StructEmbedded;
+            rec.name = ApiToken();
+        } else {
+            rec.kind = ApiRecord::StructField;
+        }
+    } else if (startsWith(exp,"interface {",11)) {
+        rec.kind = ApiRecord::InterfaceType;
+        rec.exp = exp;
+    } else if (startsWith(exp,"interface,",10)) {
+        ApiToken last = trimmed(exp.data+10,end);
+        int pos2 = indexOf(last,'(');
+        if (pos2 == -1) {
+            return false;
+        }
+        rec.kind = ApiRecord::InterfaceMethod;
+        rec.name = ApiToken(last.data,pos2);
+        rec.exp = ApiToken(last.data+pos2,last.size-pos2);
+    } else {
+        rec.kind = ApiRecord::Type;
+        rec.exp = exp;
+    }
+    return true;
+}
+
+//pkg syscall (windows-amd64), const ECOMM Errno
+bool GolangApiParser::parseLine(const char *begin, const char *end, ApiRecord &rec)
+{
+    const char *p = begin;
+    if (end-p < 4 || memcmp(p,"pkg",3) != 0 || !isSpaceChar(p[3])) {
+        return false;
+    }
+    p += 4;
+    const char *pkgBegin = p;
+    while (p < end && (isWordChar(*p) || *p == '-' || *p == '.' || *p == '/')) {
+        p++;
+    }
+    if (p == pkgBegin) {
+        return false;
+    }
+    rec.pkg = ApiToken(pkgBegin,int(p-pkgBegin));
+    // optional (os-arch)
+    if (end-p >= 2 && isSpaceChar(p[0]) && p[1] == '(') {
+        const char *q = skipWord(p+2,end,true);
+        if (q == p+2 || q >= end || *q != ')') {
+            return false;
+        }
+        p = q+1;
+    }
+    if (end-p < 2 || p[0] != ',' || !isSpaceChar(p[1])) {
+        return false;
+    }
+    p += 2;
+    const char *kindBegin = p;
+    p = skipWord(p,end,false);
+    const char *kindEnd = p;
+    ApiToken right = trimmed(p,end);
+    rec.typeName = ApiToken();
+    rec.name = ApiToken();
+    rec.exp = ApiToken();
+    if (equals(kindBegin,kindEnd,"var",3) || equals(kindBegin,kindEnd,"const",5)) {
+        //pkg archive/tar, var ErrFieldTooLong error
+        int pos = indexOf(right,' ');
+        if (pos == -1) {
+            return false;
+        }
+        rec.kind = (*kindBegin == 'v') ? ApiRecord::Var : ApiRecord::Const;
+        rec.name = ApiToken(right.data,pos);
+        rec.exp = ApiToken(right.data+pos+1,right.size-pos-1);
+        return true;
+    } else if (equals(kindBegin,kindEnd,"func",4)) {
+        //pkg bytes, func FieldsFunc([]byte, func(rune) bool) [][]byte
+        int pos = indexOf(right,'(');
+        if (pos == -1) {
+            return false;
+        }
+        rec.kind = ApiRecord::Func;
+        rec.name = ApiToken(right.data,pos);
+        rec.exp = ApiToken(right.data+pos,right.size-pos);
+        return true;
+    } else if (equals(kindBegin,kindEnd,"method",6)) {
+        //pkg archive/tar, method (*Reader) Next() (*Header, error)
+        rec.kind = ApiRecord::Method;
+        return parseReceiver(right,rec);
+    } else if (equals(kindBegin,kindEnd,"type",4)) {
+        //pkg archive/tar, type Header struct, AccessTime time.Time
+        return parseType(right,rec);
+    }
+    return false;
+}
+
+void GolangApiParser::parse(const char *data, int size, ApiRecordList &records)
+{
+    const char *p = data;
+    const char *end = data+size;
+    // utf-8 bom
+    if (size >= 3 && memcmp(p,"\xEF\xBB\xBF",3) == 0) {
+        p += 3;
+    }
+    records.reserve(records.size()+size/64);
+    ApiRecord rec;
+    while (p < end) {
+        const char *eol = (const char*)memchr(p,'\n',end-p);
+        if (!eol) {
+            eol = end;
+        }
+        if (parseLine(p,eol,rec)) {
+            records.append(rec);
+        }
+        p = eol+1;
+    }
+}
+
+class ApiParseTask : public QRunnable
+{
+public:
+    ApiParseTask(const char *data, int size, ApiRecordList *records) :
+        m_data(data), m_size(size), m_records(records)
+    {}
+    virtual void run() {
+        GolangApiParser::parse(m_data,m_size,*m_records);
+    }
+protected:
+    const char    *m_data;
+    int            m_size;
+    ApiRecordList *m_records;
+};
+
+void GolangApiParser::parseAll(const QList<QByteArray> &dataList, QList<ApiRecordList> &recordsList)
+{
+    // split every buffer at line ends, chunk order is the input order
+    QList<QPair<const char*,int> > chunks;
+    foreach (const QByteArray &data, dataList) {
+        const char *p = data.constData();
+        const char *end = p+data.size();
+        while (p < end) {
+            const char *next = end;
+            if (end-p > ParseChunkSize) {
+                next = (const char*)memchr(p+ParseChunkSize,'\n',end-p-ParseChunkSize);
+                next = next ? next+1 : end;
+            }
+            chunks.append(qMakePair(p,int(next-p)));
+            p = next;
+        }
+    }
+    recordsList.clear();
+    for (int i = 0; i < chunks.size(); i++) {
+        recordsList.append(ApiRecordList());
+    }
+    if (chunks.size() == 1 || QThread::idealThreadCount() <= 1) {
+        for (int i = 0; i < chunks.size(); i++) {
+            parse(chunks[i].first,chunks[i].second,recordsList[i]);
+        }
+        return;
+    }
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMin(chunks.size(),QThread::idealThreadCount()));
+    for (int i = 0; i < chunks.size(); i++) {
+        pool.start(new ApiParseTask(chunks[i].first,chunks[i].second,&recordsList[i]));
+    }
+    pool.waitForDone();
+}
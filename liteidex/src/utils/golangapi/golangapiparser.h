@@ -0,0 +1,78 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: golangapiparser.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef GOLANGAPIPARSER_H
+#define GOLANGAPIPARSER_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+
+// ApiToken is a slice of the source buffer, the buffer must outlive it.
+struct ApiToken
+{
+    ApiToken() : data(0), size(0) {}
+    ApiToken(const char *_data, int _size) : data(_data), size(_size) {}
+    bool isEmpty() const { return size == 0; }
+    bool operator==(const ApiToken &other) const;
+    bool operator!=(const ApiToken &other) const { return !(*this == other); }
+    const char *data;
+    int         size;
+};
+
+// ApiRecord is one "pkg ..." line of an api file split into tokens.
+struct ApiRecord
+{
+    enum Kind {
+        Var,
+        Const,
+        Func,
+        Method,             // typeName name exp
+        Type,               // typeName exp
+        StructType,         // typeName
+        StructField,        // typeName name exp
+        StructEmbedded,     // typeName exp
+        InterfaceType,      // typeName exp
+        InterfaceMethod     // typeName name exp
+    };
+    Kind     kind;
+    ApiToken pkg;
+    ApiToken typeName;
+    ApiToken name;
+    ApiToken exp;
+};
+
+typedef QVector<ApiRecord> ApiRecordList;
+
+// GolangApiParser tokenizes api files in place, large buffers are split
+// at line boundaries and parsed on a thread pool. the result keeps the
+// input order so building from it is the same as a sequential parse.
+class GolangApiParser
+{
+public:
+    static bool parseLine(const char *begin, const char *end, ApiRecord &rec);
+    static void parse(const char *data, int size, ApiRecordList &records);
+    static void parseAll(const QList<QByteArray> &dataList, QList<ApiRecordList> &recordsList);
+};
+
+#endif // GOLANGAPIPARSER_H
@@ -0,0 +1,289 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: textsnapshot.cpp
+// Creator: visualfc <visualfc@gmail.com>
+
+#include "textsnapshot.h"
+#include <QTextDocument>
+#include <QTextBlock>
+#include <string.h>
+//lite_memory_check_begin
+#if defined(WIN32) && defined(_MSC_VER) &&  defined(_DEBUG)
+     #define _CRTDBG_MAP_ALLOC
+     #include <stdlib.h>
+     #include <crtdbg.h>
+     #define DEBUG_NEW new( _NORMAL_BLOCK, __FILE__, __LINE__ )
+     #define new DEBUG_NEW
+#endif
+//lite_memory_check_end
+
+//every plugin links its own copy of this library, the interface cast
+//matches by interface id so it also finds a snapshot of another copy
+LiteApi::IUtf8Snapshot *Utf8Snapshot::attach(QTextDocument *doc)
+{
+    if (!doc) {
+        return 0;
+    }
+    foreach (QObject *obj, doc->children()) {
+        LiteApi::IUtf8Snapshot *snapshot = qobject_cast<LiteApi::IUtf8Snapshot*>(obj);
+        if (snapshot) {
+            return snapshot;
+        }
+    }
+    return new Utf8Snapshot(doc);
+}
+
+Utf8Snapshot::Utf8Snapshot(QTextDocument *doc) :
+    QObject(doc),
+    m_document(doc),
+    m_revision(0),
+    m_textRevision(doc->revision())
+{
+    connect(m_document,SIGNAL(contentsChange(int,int,int)),this,SLOT(contentsChange(int,int,int)));
+    rebuild();
+}
+
+QObject *Utf8Snapshot::object()
+{
+    return this;
+}
+
+QTextDocument *Utf8Snapshot::document() const
+{
+    return m_document;
+}
+
+QByteArray Utf8Snapshot::data() const
+{
+    return m_data;
+}
+
+int Utf8Snapshot::revision() const
+{
+    return m_revision;
+}
+
+QByteArray Utf8Snapshot::blockData(const QTextBlock &block)
+{
+    QString text = block.text();
+    //same conversions as QTextDocument::toPlainText
+    QChar *uc = text.data();
+    QChar *e = uc + text.size();
+    for (; uc != e; ++uc) {
+        switch (uc->unicode()) {
+        case 0xfdd0: // QTextBeginningOfFrame
+        case 0xfdd1: // QTextEndOfFrame
+        case QChar::ParagraphSeparator:
+        case QChar::LineSeparator:
+            *uc = QLatin1Char('\n');
+            break;
+        case QChar::Nbsp:
+            *uc = QLatin1Char(' ');
+            break;
+        default:
+            ;
+        }
+    }
+    QByteArray data = text.toUtf8();
+    if (block.next().isValid()) {
+        data.append('\n');
+    }
+    return data;
+}
+
+void Utf8Snapshot::rebuild()
+{
+    int oldCount = m_charLen.size();
+    m_data.clear();
+    m_charLen.clear();
+    m_byteLen.clear();
+    m_charLen.reserve(m_document->blockCount());
+    m_byteLen.reserve(m_document->blockCount());
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next()) {
+        QByteArray data = blockData(block);
+        m_data.append(data);
+        m_charLen.append(block.length());
+        m_byteLen.append(data.size());
+    }
+    buildTree();
+    m_revision++;
+    emit blocksChanged(0,oldCount,m_charLen.size());
+}
+
+void Utf8Snapshot::contentsChange(int position, int removed, int added)
+{
+    //highlighter passes change formats only and keep the text revision
+    int textRevision = m_document->revision();
+    if (removed == added && textRevision == m_textRevision &&
+            m_document->isUndoRedoEnabled()) {
+        return;
+    }
+    m_textRevision = textRevision;
+    QTextBlock first = m_document->findBlock(position);
+    QTextBlock last = m_document->findBlock(position+added);
+    if (!first.isValid()) {
+        first = m_document->firstBlock();
+    }
+    if (!last.isValid()) {
+        last = m_document->lastBlock();
+    }
+    //blocks outside first..last are unchanged, the block count delta
+    //gives the size of the replaced range
+    int delta = m_document->blockCount()-m_charLen.size();
+    int from = first.blockNumber();
+    int oldCount = last.blockNumber()-from+1-delta;
+    if (oldCount < 0 || from+oldCount > m_charLen.size()) {
+        rebuild();
+        return;
+    }
+    int start = bytePrefix(from);
+    int oldBytes = 0;
+    for (int i = from; i < from+oldCount; i++) {
+        oldBytes += m_byteLen.at(i);
+    }
+    QByteArray data;
+    QVector<int> charLen;
+    QVector<int> byteLen;
+    for (QTextBlock block = first; block.isValid(); block = block.next()) {
+        QByteArray bytes = blockData(block);
+        data.append(bytes);
+        charLen.append(block.length());
+        byteLen.append(bytes.size());
+        if (block == last) {
+            break;
+        }
+    }
+    //format only changes emit contentsChange as well
+    if (charLen.size() == oldCount && data.size() == oldBytes &&
+            memcmp(m_data.constData()+start,data.constData(),oldBytes) == 0) {
+        return;
+    }
+    m_data.replace(start,oldBytes,data);
+    if (charLen.size() == oldCount) {
+        for (int i = 0; i < oldCount; i++) {
+            updateTree(from+i,charLen.at(i)-m_charLen.at(from+i),byteLen.at(i)-m_byteLen.at(from+i));
+            m_charLen[from+i] = charLen.at(i);
+            m_byteLen[from+i] = byteLen.at(i);
+        }
+    } else {
+        m_charLen.remove(from,oldCount);
+        m_byteLen.remove(from,oldCount);
+        for (int i = 0; i < charLen.size(); i++) {
+            m_charLen.insert(from+i,charLen.at(i));
+            m_byteLen.insert(from+i,byteLen.at(i));
+        }
+        buildTree();
+    }
+    m_revision++;
+    emit blocksChanged(from,oldCount,charLen.size());
+}
+
+void Utf8Snapshot::buildTree()
+{
+    int n = m_charLen.size();
+    m_charTree.fill(0,n+1);
+    m_byteTree.fill(0,n+1);
+    for (int i = 1; i <= n; i++) {
+        m_charTree[i] += m_charLen.at(i-1);
+        m_byteTree[i] += m_byteLen.at(i-1);
+        int parent = i+(i & -i);
+        if (parent <= n) {
+            m_charTree[parent] += m_charTree.at(i);
+            m_byteTree[parent] += m_byteTree.at(i);
+        }
+    }
+}
+
+void Utf8Snapshot::updateTree(int block, int chars, int bytes)
+{
+    if (chars == 0 && bytes == 0) {
+        return;
+    }
+    int n = m_charLen.size();
+    for (int i = block+1; i <= n; i += (i & -i)) {
+        m_charTree[i] += chars;
+        m_byteTree[i] += bytes;
+    }
+}
+
+int Utf8Snapshot::bytePrefix(int block) const
+{
+    int bytes = 0;
+    for (int i = block; i > 0; i -= (i & -i)) {
+        bytes += m_byteTree.at(i);
+    }
+    return bytes;
+}
+
+// returns the block that holds pos and the char and byte start of it
+int Utf8Snapshot::findBlock(int pos, int &chars, int &bytes) const
+{
+    int n = m_charLen.size();
+    int step = 1;
+    while (step*2 <= n) {
+        step *= 2;
+    }
+    int index = 0;
+    chars = 0;
+    bytes = 0;
+    for (; step > 0; step /= 2) {
+        int next = index+step;
+        if (next <= n && chars+m_charTree.at(next) <= pos) {
+            index = next;
+            chars += m_charTree.at(next);
+            bytes += m_byteTree.at(next);
+        }
+    }
+    return index;
+}
+
+int Utf8Snapshot::byteOffset(int pos) const
+{
+    if (pos <= 0) {
+        return 0;
+    }
+    int chars = 0;
+    int bytes = 0;
+    int block = findBlock(pos,chars,bytes);
+    if (block >= m_byteLen.size()) {
+        return m_data.size();
+    }
+    //walk the UTF-8 of the block counting UTF-16 units
+    const uchar *data = (const uchar*)m_data.constData()+bytes;
+    int size = m_byteLen.at(block);
+    int units = pos-chars;
+    int i = 0;
+    while (units > 0 && i < size) {
+        uchar c = data[i];
+        if (c < 0x80) {
+            i += 1;
+        } else if (c < 0xe0) {
+            i += 2;
+        } else if (c < 0xf0) {
+            i += 3;
+        } else {
+            i += 4;
+            units--;
+        }
+        units--;
+    }
+    return bytes+qMin(i,size);
+}
@@ -0,0 +1,80 @@
+/**************************************************************************
+** This file is part of LiteIDE
+**
+** Copyright (c) 2011-2013 LiteIDE Team. All rights reserved.
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** In addition, as a special exception,  that plugins developed for LiteIDE,
+** are allowed to remain closed sourced and can be distributed under any license .
+** These rights are included in the file LGPL_EXCEPTION.txt in this package.
+**
+**************************************************************************/
+// Module: textsnapshot.h
+// Creator: visualfc <visualfc@gmail.com>
+
+#ifndef TEXTSNAPSHOT_H
+#define TEXTSNAPSHOT_H
+
+#include "liteeditorapi/liteeditorapi.h"
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+
+class QTextDocument;
+class QTextBlock;
+
+// Utf8Snapshot keeps the UTF-8 text of a document, as toPlainText().toUtf8()
+// would return it, up to date from contentsChange. only the edited blocks
+// are encoded again and char positions map to byte offsets in O(log n).
+// the snapshot is a child of the document, shared by every consumer.
+class Utf8Snapshot : public QObject, public LiteApi::IUtf8Snapshot
+{
+    Q_OBJECT
+    Q_INTERFACES(LiteApi::IUtf8Snapshot)
+public:
+    // the snapshot may come from another plugin's copy of this library,
+    // it is only used through the interface
+    static LiteApi::IUtf8Snapshot *attach(QTextDocument *doc);
+    virtual QObject *object();
+    virtual QTextDocument *document() const;
+    // the buffer is implicitly shared, copies are free until the next edit
+    virtual QByteArray data() const;
+    virtual int revision() const;
+    virtual int byteOffset(int pos) const;
+signals:
+    // the text of blocks from..from+removed-1 was replaced by the blocks
+    // from..from+added-1, not emitted for format only changes
+    void blocksChanged(int from, int removed, int added);
+protected slots:
+    void contentsChange(int position, int removed, int added);
+protected:
+    explicit Utf8Snapshot(QTextDocument *doc);
+    void rebuild();
+    void buildTree();
+    void updateTree(int block, int chars, int bytes);
+    int bytePrefix(int block) const;
+    int findBlock(int pos, int &chars, int &bytes) const;
+    static QByteArray blockData(const QTextBlock &block);
+protected:
+    QTextDocument  *m_document;
+    QByteArray      m_data;
+    int             m_revision;
+    int             m_textRevision;
+    // per block lengths, the separator is included
+    QVector<int>    m_charLen;
+    QVector<int>    m_byteLen;
+    // fenwick trees over the lengths
+    QVector<int>    m_charTree;
+    QVector<int>    m_byteTree;
+};
+
+#endif // TEXTSNAPSHOT_H
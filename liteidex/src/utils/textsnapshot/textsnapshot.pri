@@ -0,0 +1,4 @@
+LIBS *= -l$$qtLibraryName(textsnapshot)
+
+
+
@@ -0,0 +1,11 @@
+TARGET = textsnapshot
+TEMPLATE = lib
+
+CONFIG += staticlib
+
+include(../../liteideutils.pri)
+include(../../api/liteeditorapi/liteeditorapi.pri)
+
+HEADERS += textsnapshot.h
+
+SOURCES += textsnapshot.cpp